@@ -55,7 +55,7 @@ resource 'PiPL' (16000) {
 
 		},
 		AE_Effect_Global_OutFlags_2 {
-		0x00001408 // 5128
+		0x08001408 // 134222856
 		},
 		/* [11] */
 		AE_Effect_Match_Name {
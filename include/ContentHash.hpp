@@ -0,0 +1,54 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace Vulkanator
+{
+// A 128-bit fingerprint of a stream of bytes
+struct Hash128
+{
+	std::uint64_t Low  = 0;
+	std::uint64_t High = 0;
+
+	bool operator==(const Hash128& Other) const = default;
+};
+
+// Fast non-cryptographic hash, for telling whether pixel data has changed
+//
+// Bytes are consumed in 64-byte stripes. Each stripe is mixed into eight
+// independent 64-bit accumulators with 32x32->64-bit multiplies, which maps
+// directly onto SSE2 and NEON, so the hash runs at about the speed of a
+// memcpy. The accumulators are scrambled every 16 stripes so that reordering
+// the data changes the result.
+// Data may be fed in pieces, such as the rows of a sub-rectangle of an image,
+// and results in the same hash as feeding it all at once.
+class ContentHasher
+{
+public:
+	static constexpr std::size_t StripeSize = 64;
+
+	ContentHasher();
+
+	void Update(const void* Data, std::size_t Size);
+
+	// Does not modify the state, so more data may still be added afterwards
+	Hash128 Finalize() const;
+
+	// Hashes a single contiguous range of bytes
+	static Hash128 Hash(const void* Data, std::size_t Size);
+
+private:
+	std::array<std::uint64_t, 8> Accumulators = {};
+
+	// Bytes that did not fill an entire stripe yet
+	std::array<std::byte, StripeSize> Buffer     = {};
+	std::size_t                       BufferSize = 0;
+
+	// Stripes consumed since the accumulators were last scrambled
+	std::size_t   StripeIndex = 0;
+	std::uint64_t TotalSize   = 0;
+};
+
+} // namespace Vulkanator
@@ -0,0 +1,135 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <vector>
+
+#include "VulkanConfig.hpp"
+
+namespace Vulkanator
+{
+// Allocates descriptor sets out of a chain of descriptor pools that grows on
+// demand
+//
+// A single descriptor pool of a fixed size runs out once enough render
+// contexts exist. Instead, whenever a pool reports that it is out of memory
+// or too fragmented, a new pool of the same size is added to the chain and
+// the allocation is tried again. Pools whose descriptor sets have all been
+// freed are reset and kept around for re-use, rather than destroying and
+// creating them again.
+//
+// Allocating and freeing descriptor sets requires external synchronization of
+// the pool. To keep concurrent renders from contending over a single lock,
+// the chain is split into shards, and each thread allocates from the shard
+// that it hashes into. A descriptor set is always freed back into the shard
+// that it was allocated from.
+class DescriptorAllocator
+{
+	struct Pool;
+	struct Shard;
+
+public:
+	// A descriptor set that is freed back into its pool once destroyed
+	class DescriptorSet
+	{
+	public:
+		DescriptorSet() = default;
+		~DescriptorSet();
+
+		DescriptorSet(DescriptorSet&& Other) noexcept;
+		DescriptorSet& operator=(DescriptorSet&& Other) noexcept;
+
+		DescriptorSet(const DescriptorSet&)            = delete;
+		DescriptorSet& operator=(const DescriptorSet&) = delete;
+
+		const vk::DescriptorSet& Get() const
+		{
+			return Set;
+		}
+
+		explicit operator bool() const
+		{
+			return bool(Set);
+		}
+
+		// Frees the descriptor set back into its pool
+		void Reset();
+
+	private:
+		friend class DescriptorAllocator;
+
+		DescriptorAllocator* Allocator = nullptr;
+		Shard*               Owner     = nullptr;
+		Pool*                Source    = nullptr;
+		vk::DescriptorSet    Set       = {};
+	};
+
+	struct Statistics
+	{
+		// Pools that currently have descriptor sets allocated from them
+		std::uint64_t Pools = 0;
+		// Pools that were reset, and are waiting to be re-used
+		std::uint64_t FreePools = 0;
+		std::uint64_t LiveSets  = 0;
+		// Times that a pool ran out and a new one was added to the chain
+		std::uint64_t Grows = 0;
+	};
+
+	DescriptorAllocator() = default;
+	~DescriptorAllocator();
+
+	DescriptorAllocator(const DescriptorAllocator&)            = delete;
+	DescriptorAllocator& operator=(const DescriptorAllocator&) = delete;
+
+	// Every pool of the chain is created with `NewPoolSizes` and
+	// `NewSetsPerPool`. The allocator is split into `NewShardCount` shards
+	bool Initialize(
+		vk::Device                              NewDevice,
+		std::span<const vk::DescriptorPoolSize> NewPoolSizes,
+		std::uint32_t NewSetsPerPool, std::size_t NewShardCount
+	);
+
+	// Returns an empty descriptor set upon failure
+	DescriptorSet Allocate(vk::DescriptorSetLayout Layout);
+
+	Statistics GetStatistics() const;
+
+	// Destroys every pool. Every descriptor set must have been freed already
+	void Clear();
+
+private:
+	struct Pool
+	{
+		vk::UniqueDescriptorPool Handle   = {};
+		std::uint32_t            LiveSets = 0;
+	};
+
+	struct Shard
+	{
+		std::mutex ShardMutex = {};
+		// The last pool is the one that is currently being allocated from
+		std::vector<std::unique_ptr<Pool>> Pools = {};
+		// Pools that were reset once all of their descriptor sets were freed
+		std::vector<std::unique_ptr<Pool>> FreePools = {};
+		std::uint64_t                      Grows     = 0;
+	};
+
+	// Creates a new pool, or takes a previously reset one, and makes it the
+	// shard's current pool. The shard's lock must be held
+	Pool* Grow(Shard& CurShard);
+
+	void Free(DescriptorSet& Set);
+
+	Shard& GetThreadShard();
+
+	vk::Device                          Device      = {};
+	std::vector<vk::DescriptorPoolSize> PoolSizes   = {};
+	std::uint32_t                       SetsPerPool = 0;
+
+	std::unique_ptr<Shard[]> Shards     = {};
+	std::size_t              ShardCount = 0;
+};
+} // namespace Vulkanator
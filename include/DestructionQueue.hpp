@@ -0,0 +1,130 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+#include "SubmissionService.hpp"
+
+namespace Vulkanator
+{
+// Destroys Vulkan objects on a background thread, once the GPU is done with
+// them
+//
+// Freeing large allocations within the driver may take milliseconds. Rather
+// than a render thread paying for that in the middle of an interactive render,
+// objects that it has no more use for are retired into this queue, along with
+// a checkpoint of everything that was submitted up until then. Once the GPU
+// has reached the checkpoint, nothing that it is still executing may refer to
+// the objects anymore, and the destruction thread frees them.
+//
+// Anything that frees its Vulkan objects within its destructor may be
+// retired, such as vk::Unique* handles, memory allocations, or the shared
+// pointer of a texture.
+class DestructionQueue
+{
+public:
+	struct Statistics
+	{
+		std::uint64_t Retired   = 0;
+		std::uint64_t Destroyed = 0;
+		// Retired objects that were not destroyed yet
+		std::uint64_t Pending = 0;
+		// Time spent destroying retired objects, off of the render threads
+		std::chrono::nanoseconds DestroyTime = {};
+	};
+
+	DestructionQueue() = default;
+	~DestructionQueue();
+
+	DestructionQueue(const DestructionQueue&)            = delete;
+	DestructionQueue& operator=(const DestructionQueue&) = delete;
+
+	// Starts the destruction thread, which waits on the timelines of
+	// `NewSubmitter`
+	void Start(const SubmissionService& NewSubmitter);
+
+	// Destroys everything that is still pending and joins the destruction
+	// thread. Must be called before the submission service is stopped
+	// Safe to call multiple times
+	void Stop();
+
+	// Hands `Object` over to be destroyed once the GPU is done with it
+	// Without a destruction thread, it is destroyed right away
+	template<typename ObjectType>
+	void Retire(ObjectType&& Object)
+	{
+		using RetiredType = std::remove_cvref_t<ObjectType>;
+		if constexpr( std::is_constructible_v<bool, const RetiredType&> )
+		{
+			// Empty handles and pointers have nothing to destroy
+			if( !static_cast<bool>(Object) )
+			{
+				return;
+			}
+		}
+		Push(std::make_unique<RetiredObject<RetiredType>>(
+			std::forward<ObjectType>(Object)
+		));
+	}
+
+	// Destroys every retired object that the GPU is done with right away, on
+	// the calling thread. For when the memory that they hold is needed now
+	// Returns false if there was nothing to destroy
+	bool Flush();
+
+	Statistics GetStatistics() const;
+
+private:
+	struct RetiredBase
+	{
+		virtual ~RetiredBase() = default;
+	};
+
+	template<typename ObjectType>
+	struct RetiredObject final : RetiredBase
+	{
+		explicit RetiredObject(ObjectType&& NewObject)
+			: Object(std::move(NewObject))
+		{
+		}
+
+		ObjectType Object;
+	};
+
+	struct Entry
+	{
+		SubmissionService::Checkpoint Point  = {};
+		std::unique_ptr<RetiredBase>  Object = {};
+	};
+
+	void Push(std::unique_ptr<RetiredBase> Object);
+
+	// Destroys `Object`, counting the time that it took
+	void Destroy(std::unique_ptr<RetiredBase> Object);
+
+	void ThreadMain();
+
+	const SubmissionService* Submitter = nullptr;
+
+	mutable std::mutex      QueueMutex     = {};
+	std::condition_variable QueueCondition = {};
+	// In the order that they were retired, so checkpoints only ever increase
+	std::deque<Entry> Entries   = {};
+	bool              QueueStop = false;
+
+	std::thread DestroyThread = {};
+
+	// Counters
+	std::atomic<std::uint64_t> Retired     = 0;
+	std::atomic<std::uint64_t> Destroyed   = 0;
+	std::atomic<std::int64_t>  DestroyTime = 0;
+};
+} // namespace Vulkanator
@@ -0,0 +1,196 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+#include "VulkanConfig.hpp"
+
+namespace VulkanUtils
+{
+class MemoryAllocator;
+
+// A large device memory allocation that smaller allocations are carved out of
+struct MemoryBlock;
+
+// A range of device memory that a single buffer or image is bound to
+// Returns its range back to the allocator that it came from once destroyed
+class MemoryAllocation
+{
+public:
+	MemoryAllocation() = default;
+	~MemoryAllocation();
+
+	MemoryAllocation(MemoryAllocation&& Other) noexcept;
+	MemoryAllocation& operator=(MemoryAllocation&& Other) noexcept;
+
+	MemoryAllocation(const MemoryAllocation&)            = delete;
+	MemoryAllocation& operator=(const MemoryAllocation&) = delete;
+
+	vk::DeviceMemory GetMemory() const
+	{
+		return Memory;
+	}
+
+	vk::DeviceSize GetOffset() const
+	{
+		return Offset;
+	}
+
+	vk::DeviceSize GetSize() const
+	{
+		return Size;
+	}
+
+	// Where the allocation begins within the host's address space, or nullptr
+	// if its memory is not host-visible
+	// Stays mapped for as long as the allocation is alive
+	std::byte* GetMapping() const
+	{
+		return Mapping;
+	}
+
+	explicit operator bool() const
+	{
+		return Memory != vk::DeviceMemory();
+	}
+
+	// Returns the range back to its allocator
+	void Reset();
+
+private:
+	friend class MemoryAllocator;
+
+	MemoryAllocator* Allocator = nullptr;
+	// The block that the range was carved out of, or nullptr if the range is
+	// an entire device memory allocation of its own
+	MemoryBlock* Block = nullptr;
+
+	vk::DeviceMemory Memory  = {};
+	vk::DeviceSize   Offset  = 0;
+	vk::DeviceSize   Size    = 0;
+	std::byte*       Mapping = nullptr;
+
+	// Size of the range within its block, as a power of two
+	std::uint32_t Order = 0;
+
+	std::uint32_t MemoryTypeIndex = 0;
+};
+
+// Sub-allocates the memory of buffers and images out of large blocks
+//
+// Every vkAllocateMemory call is slow, counts against the device's
+// `maxMemoryAllocationCount`, and scatters small allocations all over the
+// device's memory. Instead, each memory type gets its own blocks of memory,
+// which are split up using a buddy allocator. Resources that the driver would
+// rather have their own allocation for, and resources that are too large for
+// a block, still get a device memory allocation of their own.
+//
+// Linear resources and optimal-tiled images never share a block, so that
+// `bufferImageGranularity` never has to be accounted for. Host-visible blocks
+// stay mapped for as long as they are alive.
+class MemoryAllocator
+{
+public:
+	struct Statistics
+	{
+		// Blocks, and the size of all of them together
+		std::size_t    Blocks    = 0;
+		vk::DeviceSize BlockSize = 0;
+		// Ranges that are currently carved out of the blocks
+		std::size_t    Allocations    = 0;
+		vk::DeviceSize AllocationSize = 0;
+		// Resources with a device memory allocation of their own
+		std::size_t    Dedicated     = 0;
+		vk::DeviceSize DedicatedSize = 0;
+	};
+
+	MemoryAllocator();
+	~MemoryAllocator();
+
+	MemoryAllocator(const MemoryAllocator&)            = delete;
+	MemoryAllocator& operator=(const MemoryAllocator&) = delete;
+
+	// Must be called before anything is allocated
+	void Initialize(vk::Device NewDevice, vk::PhysicalDevice NewPhysicalDevice);
+
+	vk::Device GetDevice() const
+	{
+		return Device;
+	}
+
+	// Allocates memory of the requested properties that `Buffer` may be bound
+	// to. The buffer is not bound to it
+	std::optional<MemoryAllocation> AllocateForBuffer(
+		vk::Buffer Buffer, vk::MemoryPropertyFlags Properties,
+		vk::MemoryPropertyFlags ExcludeProperties
+		= vk::MemoryPropertyFlagBits::eProtected
+	);
+
+	// Allocates memory of the requested properties that `Image` may be bound
+	// to. The image is not bound to it
+	std::optional<MemoryAllocation> AllocateForImage(
+		vk::Image Image, vk::ImageTiling Tiling,
+		vk::MemoryPropertyFlags Properties,
+		vk::MemoryPropertyFlags ExcludeProperties
+		= vk::MemoryPropertyFlagBits::eProtected
+	);
+
+	Statistics GetStatistics() const;
+
+	// Bytes of device memory that were allocated out of the memory heap,
+	// including the unused parts of its blocks
+	vk::DeviceSize GetHeapUsage(std::uint32_t HeapIndex) const;
+
+private:
+	friend class MemoryAllocation;
+
+	struct Pool
+	{
+		std::uint32_t                             MemoryTypeIndex = 0;
+		bool                                      Linear          = false;
+		std::vector<std::unique_ptr<MemoryBlock>> Blocks          = {};
+	};
+
+	std::optional<MemoryAllocation> Allocate(
+		const vk::MemoryRequirements& Requirements, bool PrefersDedicated,
+		bool Linear, vk::Buffer DedicatedBuffer, vk::Image DedicatedImage,
+		vk::MemoryPropertyFlags Properties,
+		vk::MemoryPropertyFlags ExcludeProperties
+	);
+
+	// Gives a device memory allocation to a single resource
+	std::optional<MemoryAllocation> AllocateDedicated(
+		vk::DeviceSize Size, std::uint32_t MemoryTypeIndex,
+		vk::Buffer DedicatedBuffer, vk::Image DedicatedImage
+	);
+
+	// Maps the entirety of `Memory` if it is host-visible
+	// Returns nullptr if it is not host-visible, or std::nullopt if it failed
+	// to map
+	std::optional<std::byte*> MapIfHostVisible(
+		vk::DeviceMemory Memory, std::uint32_t MemoryTypeIndex
+	) const;
+
+	void Free(MemoryAllocation& Allocation);
+
+	vk::Device                         Device           = {};
+	vk::PhysicalDevice                 PhysicalDevice   = {};
+	vk::PhysicalDeviceMemoryProperties MemoryProperties = {};
+
+	// Size of new blocks within each memory heap, as a power of two
+	std::vector<std::uint32_t> HeapBlockOrders = {};
+
+	mutable std::mutex AllocatorMutex = {};
+	std::vector<Pool>  Pools          = {};
+
+	std::vector<vk::DeviceSize> HeapUsage = {};
+
+	std::size_t    DedicatedCount = 0;
+	vk::DeviceSize DedicatedSize  = 0;
+};
+} // namespace VulkanUtils
@@ -0,0 +1,127 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "MemoryAllocator.hpp"
+#include "VulkanConfig.hpp"
+
+namespace Vulkanator
+{
+struct RenderContextPool;
+
+// Keeps the caches of every sequence within the device's memory budget
+//
+// Each sequence keeps the images of its previous renders around, so that its
+// next render does not have to allocate them again. With many sequences open,
+// these add up to more memory than the device has. The memory manager compares
+// the process' usage of the device-local heap against the budget that
+// VK_EXT_memory_budget reports, or against the size of the heap when the
+// extension is not available. Under pressure, and whenever an allocation
+// fails, the caches of the least recently rendered sequences are freed first.
+//
+// Sequences that are not being rendered at all, such as those of disabled or
+// offscreen layers, should not hold on to memory either. A reclaimer thread
+// frees the caches of every sequence that has not rendered for a while, even
+// when there is no pressure.
+class MemoryManager
+{
+public:
+	struct Usage
+	{
+		vk::DeviceSize Used   = 0;
+		vk::DeviceSize Budget = 0;
+	};
+
+	struct SequenceFootprint
+	{
+		// Larger values were rendered more recently
+		std::uint64_t  LastRender = 0;
+		vk::DeviceSize Size       = 0;
+	};
+
+	MemoryManager() = default;
+	~MemoryManager();
+
+	MemoryManager(const MemoryManager&)            = delete;
+	MemoryManager& operator=(const MemoryManager&) = delete;
+
+	// `MemoryBudget` is whether VK_EXT_memory_budget is enabled. Otherwise,
+	// the usage is what `Allocator` allocated
+	void Initialize(
+		vk::PhysicalDevice                  NewPhysicalDevice,
+		const VulkanUtils::MemoryAllocator& NewAllocator, bool NewMemoryBudget
+	);
+
+	// Starts tracking the caches of a sequence, for as long as it is alive
+	void Register(const std::shared_ptr<RenderContextPool>& Pool);
+
+	// Marks a sequence as the one that was rendered most recently
+	void Touch(RenderContextPool& Pool);
+
+	Usage GetUsage() const;
+
+	// Whether the usage is close enough to the budget that caches should be
+	// freed before allocating anything new
+	bool IsUnderPressure() const;
+
+	// Frees the caches of the least recently rendered sequence that has any
+	// Returns false if there was nothing left to free
+	bool EvictOne();
+
+	// Every sequence that is currently alive
+	std::vector<SequenceFootprint> GetFootprints() const;
+
+	std::uint64_t GetEvictions() const
+	{
+		return Evictions;
+	}
+
+	// Starts the reclaimer thread, which frees the caches of sequences that
+	// have not rendered for at least `IdleTimeout`
+	void StartReclaimer(std::chrono::seconds IdleTimeout);
+	// Joins the reclaimer thread, if it was started
+	void StopReclaimer();
+
+	// Frees the caches of every sequence that has not rendered since
+	// `IdleSince`
+	// Returns how much device memory was freed
+	vk::DeviceSize ReclaimIdle(std::chrono::steady_clock::time_point IdleSince);
+
+	// Device memory that the reclaimer has freed so far
+	vk::DeviceSize GetReclaimed() const
+	{
+		return Reclaimed;
+	}
+
+private:
+	vk::PhysicalDevice                  PhysicalDevice = {};
+	const VulkanUtils::MemoryAllocator* Allocator      = nullptr;
+	bool                                MemoryBudget   = false;
+
+	// The largest device-local heap, where all of the images live
+	std::uint32_t  HeapIndex = 0;
+	vk::DeviceSize HeapSize  = 0;
+
+	mutable std::mutex                            ManagerMutex = {};
+	std::vector<std::weak_ptr<RenderContextPool>> Pools        = {};
+
+	std::atomic<std::uint64_t> RenderTick = 0;
+	std::atomic<std::uint64_t> Evictions  = 0;
+
+	void ReclaimerThreadMain(std::chrono::seconds IdleTimeout);
+
+	std::thread             ReclaimerThread    = {};
+	std::mutex              ReclaimerMutex     = {};
+	std::condition_variable ReclaimerCondition = {};
+	bool                    ReclaimerStop      = false;
+
+	std::atomic<vk::DeviceSize> Reclaimed = 0;
+};
+} // namespace Vulkanator
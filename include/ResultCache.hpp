@@ -0,0 +1,95 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <vector>
+
+#include "ContentHash.hpp"
+
+namespace Vulkanator
+{
+// Optional on-disk cache of rendered frames
+//
+// Re-rendering the same frame with the same parameters, such as when a render
+// farm renders a shot again after an unrelated edit elsewhere in the comp,
+// produces the very same output pixels. Each rendered frame is stored as its
+// own file, named after a hash of everything that the render depends on. The
+// files hold the pixels uncompressed so that a hit only has to map the file
+// and copy its rows into the output layer.
+//
+// Files are first written under a temporary name, flushed to disk, and then
+// renamed into place. A crash at any point never leaves a partially written
+// file behind under a real name. The cache is kept below its capacity by
+// deleting the least recently used files. The file modification times keep
+// track of their use across sessions.
+class ResultCache
+{
+public:
+	struct Statistics
+	{
+		std::uint64_t Hits   = 0;
+		std::uint64_t Misses = 0;
+		std::size_t   Files  = 0;
+		std::uint64_t Size   = 0;
+	};
+
+	ResultCache() = default;
+
+	ResultCache(const ResultCache&)            = delete;
+	ResultCache& operator=(const ResultCache&) = delete;
+
+	// Uses `Directory` to hold at most `Capacity` bytes of cached frames,
+	// creating the directory if needed. Returns false if the directory is not
+	// usable, in which case the cache stays disabled
+	bool Open(const std::filesystem::path& Directory, std::uint64_t Capacity);
+
+	bool IsOpen() const;
+
+	// Copies the cached frame of `Key` into the rows of `Destination`.
+	// Returns false if there is no such frame, or if it does not match the
+	// given dimensions
+	bool Load(
+		const Hash128& Key, std::uint32_t Width, std::uint32_t Height,
+		std::size_t PixelSize, std::byte* Destination,
+		std::size_t DestinationRowBytes
+	);
+
+	// Stores the rows of `Source` as the frame of `Key`
+	// Failures are not fatal, the frame is just not cached
+	void Store(
+		const Hash128& Key, std::uint32_t Width, std::uint32_t Height,
+		std::size_t PixelSize, const std::byte* Source,
+		std::size_t SourceRowBytes
+	);
+
+	Statistics GetStatistics() const;
+
+private:
+	struct Entry
+	{
+		Hash128       Key     = {};
+		std::uint64_t Size    = 0;
+		std::uint64_t LastUse = 0;
+	};
+
+	std::filesystem::path EntryPath(const Hash128& Key) const;
+
+	// Deletes least recently used files until the cache is within capacity
+	// Requires `CacheMutex` to be held
+	void Trim();
+
+	mutable std::mutex CacheMutex = {};
+
+	std::filesystem::path Directory = {};
+	std::uint64_t         Capacity  = 0;
+	std::uint64_t         Size      = 0;
+
+	std::vector<Entry> Entries = {};
+	std::uint64_t      UseTick = 0;
+
+	std::uint64_t Hits   = 0;
+	std::uint64_t Misses = 0;
+};
+} // namespace Vulkanator
@@ -0,0 +1,160 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <span>
+
+#include "MemoryAllocator.hpp"
+#include "VulkanConfig.hpp"
+
+namespace Vulkanator
+{
+// A single persistently mapped staging buffer that every render streams its
+// pixels through
+//
+// Rather than each render context owning staging buffers as large as the
+// largest frame that it has rendered, renders sub-allocate regions out of a
+// ring buffer of a fixed size. Regions are handed out in order, and retire
+// once the render that allocated them has waited on the GPU work that uses
+// them. When the ring is full, renders block until enough of it has been
+// retired. No matter how many sequences are open, the host-visible memory that
+// staging takes up stays bounded by the size of the ring.
+class StagingRing
+{
+public:
+	// Offsets of regions within the ring are aligned to this, which satisfies
+	// the alignment of buffer-image copies of every render format
+	static constexpr vk::DeviceSize Alignment = 256;
+
+	// Rounds `Size` up to the alignment of regions, such that a range may be
+	// placed right after another within the same region
+	static constexpr vk::DeviceSize Align(vk::DeviceSize Size)
+	{
+		return ((Size + Alignment - 1) / Alignment) * Alignment;
+	}
+
+	// A range of the ring that a single render writes and reads through
+	// Retires its range once destroyed, which must only happen once the GPU
+	// is done with it
+	class Region
+	{
+	public:
+		Region() = default;
+		~Region();
+
+		Region(Region&& Other) noexcept;
+		Region& operator=(Region&& Other) noexcept;
+
+		Region(const Region&)            = delete;
+		Region& operator=(const Region&) = delete;
+
+		vk::Buffer GetBuffer() const;
+
+		vk::DeviceSize GetOffset() const
+		{
+			return Offset;
+		}
+
+		vk::DeviceSize GetSize() const
+		{
+			return Size;
+		}
+
+		// Where the region begins within the host's address space
+		std::byte* GetMapping() const;
+
+		explicit operator bool() const
+		{
+			return Ring != nullptr;
+		}
+
+		// Retires the range back into the ring
+		void Reset();
+
+	private:
+		friend class StagingRing;
+
+		StagingRing* Ring = nullptr;
+
+		// Where the region begins within the ring's stream of allocations
+		std::uint64_t  Position = 0;
+		vk::DeviceSize Offset   = 0;
+		vk::DeviceSize Size     = 0;
+	};
+
+	struct Statistics
+	{
+		vk::DeviceSize Capacity = 0;
+		// Bytes between the oldest region that has not retired yet, and the
+		// newest region
+		vk::DeviceSize Used = 0;
+
+		std::uint64_t Allocations = 0;
+		// Allocations that had to wait for other renders to retire their
+		// regions first
+		std::uint64_t Waits = 0;
+	};
+
+	StagingRing() = default;
+
+	StagingRing(const StagingRing&)            = delete;
+	StagingRing& operator=(const StagingRing&) = delete;
+
+	// Allocates and maps the ring's buffer. When `QueueFamilies` holds more
+	// than one queue family, the buffer is shared among them concurrently
+	bool Initialize(
+		VulkanUtils::MemoryAllocator& Allocator, vk::DeviceSize NewCapacity,
+		vk::MemoryPropertyFlags        Properties,
+		vk::MemoryPropertyFlags        ExcludeProperties,
+		std::span<const std::uint32_t> QueueFamilies
+	);
+
+	bool IsInitialized() const
+	{
+		return Mapping != nullptr;
+	}
+
+	vk::DeviceSize GetCapacity() const
+	{
+		return Capacity;
+	}
+
+	// Blocks until `Size` bytes of the ring are free
+	// Returns an empty region if `Size` is larger than the entire ring
+	Region Allocate(vk::DeviceSize Size);
+
+	Statistics GetStatistics() const;
+
+private:
+	void Retire(const Region& Retired);
+
+	vk::UniqueBuffer              Buffer   = {};
+	VulkanUtils::MemoryAllocation Memory   = {};
+	std::byte*                    Mapping  = nullptr;
+	vk::DeviceSize                Capacity = 0;
+
+	// Regions that have not retired yet, by their position
+	// Regions may retire out of order, but the ring only advances past a
+	// region once every region before it has retired as well
+	struct LiveRegion
+	{
+		vk::DeviceSize Size    = 0;
+		bool           Retired = false;
+	};
+
+	mutable std::mutex                  RingMutex       = {};
+	std::condition_variable             RetireCondition = {};
+	std::map<std::uint64_t, LiveRegion> LiveRegions     = {};
+
+	// Positions only ever increase while any region is alive, and wrap
+	// around the buffer. Everything from `Tail` up to `Head` may be in use
+	std::uint64_t Head = 0;
+	std::uint64_t Tail = 0;
+
+	std::uint64_t Allocations = 0;
+	std::uint64_t Waits       = 0;
+};
+} // namespace Vulkanator
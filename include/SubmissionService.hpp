@@ -0,0 +1,321 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <thread>
+#include <vector>
+
+#include "VulkanConfig.hpp"
+
+#include <glm/glm.hpp>
+
+namespace Vulkanator
+{
+// Owns the device's vk::Queues and is the only thread that ever submits work
+// into them
+//
+// vkQueueSubmit requires external synchronization and has a considerable
+// fixed cost per call. Render threads push their recorded command buffers into
+// a lock-free multiple-producer single-consumer queue, and the submission
+// thread merges everything that is pending at that moment into a single
+// vkQueueSubmit with one vk::SubmitInfo per request.
+// Requests for different queues are submitted in the same order that they
+// came in, so that a request waiting on a semaphore is never submitted before
+// the request that signals it.
+// Each queue has a timeline semaphore, and every request signals the next
+// value of its queue's timeline once the GPU has finished it. Render threads
+// wait on that value themselves, polling it for a short while when the
+// request is expected to finish soon, rather than going to sleep right away.
+// Devices without timeline semaphores signal a fence with every batch
+// instead. A retire thread waits on the fences in the order that they were
+// submitted, and advances each queue's value as its batches complete.
+class SubmissionService
+{
+public:
+	// A single unit of work to submit. Lives on the stack of the render thread
+	// that submitted it, which must call `Wait` before it goes out of scope
+	struct Request
+	{
+		// Filled in by the render thread
+		vk::SubmitInfo SubmitInfo = {};
+		// Index of the queue to submit into, in the order given to `Start`
+		std::uint32_t QueueIndex = 0;
+
+		// Blocks until the GPU has finished executing this request, and returns
+		// the result of the submission
+		// Returns early upon an error, such as a lost device, after which the
+		// GPU will not be touching anything of the request anymore. The
+		// request's resources may not be re-used or freed before this returns
+		// Returns eTimeout once the request has been in flight for longer
+		// than `HangTimeout`. The GPU may then still be using the request's
+		// resources, which have to be retired into a DestructionQueue rather
+		// than re-used or freed. The request itself may go out of scope
+		vk::Result Wait();
+
+	private:
+		friend class SubmissionService;
+
+		// Intrusive link within the pending-queue
+		Request* Next = nullptr;
+
+		SubmissionService* Service = nullptr;
+
+		// Signaled by the submission thread once the request was submitted
+		std::mutex              SubmitMutex     = {};
+		std::condition_variable SubmitCondition = {};
+		bool                    Submitted       = false;
+		vk::Result              Result          = vk::Result::eSuccess;
+
+		// The value that the queue's timeline semaphore reaches once the GPU
+		// has finished this request
+		std::uint64_t                         TimelineValue = 0;
+		std::chrono::steady_clock::time_point SubmitTime    = {};
+
+		void Signal(vk::Result NewResult);
+	};
+
+	// Waits that go on for longer than this are reported as stalls, and are
+	// then continued for another slice
+	static constexpr std::chrono::nanoseconds WaitSlice
+		= std::chrono::seconds(1);
+	// Render waits on requests that have been in flight for longer than this
+	// are reported as suspected hangs, and give up with eTimeout. A frame that
+	// is large enough may honestly take this long on a slow device, so the
+	// render fails, but its resources are only freed once the GPU is done
+	// Shutting down only waits this long on the GPU
+	static constexpr std::chrono::nanoseconds HangTimeout
+		= std::chrono::seconds(10);
+
+	// Requests that are predicted to finish within this long are polled
+	// rather than waited on with a blocking wait, since being woken up by the
+	// kernel takes a considerable share of that
+	static constexpr std::chrono::nanoseconds SpinThreshold
+		= std::chrono::microseconds(500);
+
+	// Upper bounds of each bucket of the histogram of wait times
+	// The last bucket holds every wait beyond the last bound
+	static constexpr std::array<std::chrono::nanoseconds, 5> WaitBucketBounds
+		= {
+			std::chrono::microseconds(50), std::chrono::microseconds(250),
+			std::chrono::milliseconds(1),  std::chrono::milliseconds(5),
+			std::chrono::milliseconds(25),
+	};
+
+	// A wait that went on for longer than `WaitSlice`
+	struct Stall
+	{
+		std::uint32_t QueueIndex = 0;
+		// The timeline value that was waited on, and the value that the
+		// timeline had reached at the time
+		std::uint64_t            WaitValue    = 0;
+		std::uint64_t            ReachedValue = 0;
+		std::chrono::nanoseconds Elapsed      = {};
+	};
+
+	// The value that each queue's timeline reaches once everything that was
+	// submitted up until some point has finished
+	struct Checkpoint
+	{
+		std::vector<std::uint64_t> Values = {};
+	};
+
+	struct Statistics
+	{
+		// Number of vkQueueSubmit calls made
+		std::uint64_t Submits = 0;
+		// Number of vk::SubmitInfos within all of those vkQueueSubmit calls
+		std::uint64_t SubmitInfos = 0;
+
+		glm::f64 SubmitsPerSecond = 0.0;
+		glm::f64 AverageBatchSize = 0.0;
+
+		// Waits that were already complete, that completed while polling, and
+		// that had to block
+		std::uint64_t ReadyWaits   = 0;
+		std::uint64_t SpunWaits    = 0;
+		std::uint64_t BlockedWaits = 0;
+		// Waits that went beyond `WaitSlice`, and that gave up after
+		// `HangTimeout`
+		std::uint64_t Stalls         = 0;
+		std::uint64_t SuspectedHangs = 0;
+		// The most recent stall, if any
+		Stall LastStall = {};
+
+		// Number of waits within each bucket of `WaitBucketBounds`
+		std::array<std::uint64_t, WaitBucketBounds.size() + 1> WaitHistogram
+			= {};
+		std::chrono::nanoseconds TotalWaitTime   = {};
+		std::chrono::nanoseconds LongestWaitTime = {};
+	};
+
+	SubmissionService() = default;
+	~SubmissionService();
+
+	SubmissionService(const SubmissionService&)            = delete;
+	SubmissionService& operator=(const SubmissionService&) = delete;
+
+	// Starts the submission thread, which will take ownership of submitting
+	// into `Queues`. With `TimelineSemaphores`, each queue gets a timeline
+	// semaphore, and the device must have the timeline semaphore feature
+	// enabled. Otherwise, the retire thread is started as well
+	bool Start(
+		vk::Device Device, std::span<const vk::Queue> Queues,
+		const vk::DispatchLoaderDynamic& Dispatcher, bool TimelineSemaphores
+	);
+
+	// Finishes all pending work and joins the submission and retire threads
+	// Safe to call multiple times
+	void Stop();
+
+	// Enqueues a request to be submitted, does not block
+	// If the service is not running, the request is signaled with
+	// eErrorInitializationFailed right away rather than enqueued
+	void Submit(Request& NewRequest);
+
+	// Returns a checkpoint of everything that was submitted so far
+	Checkpoint GetCheckpoint() const;
+
+	// Whether the GPU has finished everything up until `Point`
+	bool HasReached(const Checkpoint& Point) const;
+
+	// Blocks for up to `Timeout` until the GPU has finished everything up
+	// until `Point`
+	vk::Result WaitFor(
+		const Checkpoint& Point, std::chrono::nanoseconds Timeout
+	) const;
+
+	Statistics GetStatistics() const;
+
+private:
+	struct Timeline
+	{
+		vk::Queue Queue = {};
+		// Only with timeline semaphores
+		vk::UniqueSemaphore Semaphore = {};
+		// The value that the most recently submitted request will signal
+		// Only ever written by the submission thread
+		std::atomic<std::uint64_t> LastValue = 0;
+		// Only without timeline semaphores. The value of the most recent
+		// batch that the retire thread has seen complete
+		std::atomic<std::uint64_t> ReachedValue = 0;
+		// Moving average of how long requests take from their submission
+		// until the GPU has finished them
+		std::atomic<std::int64_t> AverageLatency = 0;
+	};
+
+	// A batch that signals a fence once the GPU has finished it, along with
+	// the value that its queue reaches at that point
+	struct FencedBatch
+	{
+		std::uint32_t   QueueIndex = 0;
+		std::uint64_t   Value      = 0;
+		vk::UniqueFence Fence      = {};
+	};
+
+	// Pushes a request onto the pending stack
+	void Push(Request& NewRequest);
+
+	void SubmitThreadMain();
+
+	// Submits requests that all target the same queue as a single batch
+	void SubmitBatch(
+		std::uint32_t QueueIndex, std::span<Request* const> BatchRequests
+	);
+
+	// Waits on the fence of each batch, in the order that they were submitted
+	void RetireThreadMain();
+
+	vk::UniqueFence AcquireFence();
+
+	// Returns the value that the timeline of `QueueIndex` has reached, or the
+	// error that querying it ran into, such as a lost device
+	vk::ResultValue<std::uint64_t> QueryTimelineValue(std::uint32_t QueueIndex
+	) const;
+
+	// Returns the value that the timeline of `QueueIndex` has reached
+	std::uint64_t GetTimelineValue(std::uint32_t QueueIndex) const;
+
+	// Polls and then blocks on the timeline of `CurRequest`
+	vk::Result WaitTimeline(const Request& CurRequest);
+
+	void RecordWait(
+		std::chrono::nanoseconds Elapsed, std::atomic<std::uint64_t>& Kind
+	);
+
+	vk::Device                       Device     = {};
+	const vk::DispatchLoaderDynamic* Dispatcher = nullptr;
+
+	std::unique_ptr<Timeline[]> Timelines     = {};
+	std::size_t                 TimelineCount = 0;
+	// Whether the timelines are semaphores, rather than fenced batches
+	bool TimelineSemaphores = false;
+
+	// Re-used between batches
+	std::vector<vk::SubmitInfo>                  SubmitInfosBatch      = {};
+	std::vector<vk::TimelineSemaphoreSubmitInfo> TimelineInfosBatch    = {};
+	std::vector<vk::Semaphore>                   SignalSemaphoresBatch = {};
+	std::vector<std::uint64_t>                   SignalValuesBatch     = {};
+
+	// Lock-free MPSC queue
+	// Producers push onto the head of an intrusive stack, and the submission
+	// thread takes the entire stack at once and reverses it into FIFO order
+	std::atomic<Request*> PendingHead = nullptr;
+
+	// Pushed by `Stop` to wake up and terminate the submission thread
+	Request StopRequest = {};
+
+	// Whether new requests are accepted. `Stop` clears this, then waits for
+	// every `Submit` that is still in the middle of pushing a request before
+	// pushing the stop-request, so that nothing may end up after it
+	std::atomic<bool>          Accepting     = false;
+	std::atomic<std::uint32_t> ActiveSubmits = 0;
+
+	std::thread SubmitThread = {};
+
+	// Only without timeline semaphores
+	// Batches that have been submitted, and are waiting to be retired
+	std::mutex              RetireMutex     = {};
+	std::condition_variable RetireCondition = {};
+	std::deque<FencedBatch> RetireQueue     = {};
+	bool                    RetireStop      = false;
+
+	// Fences of retired batches, ready for re-use
+	std::mutex                   FenceMutex = {};
+	std::vector<vk::UniqueFence> FreeFences = {};
+
+	// Notified whenever the retire thread advances the value of a queue
+	mutable std::mutex              ReachedMutex     = {};
+	mutable std::condition_variable ReachedCondition = {};
+	// The error that waiting on a fence ran into, after which no more
+	// batches are retired
+	std::atomic<vk::Result> RetireResult = vk::Result::eSuccess;
+
+	std::thread RetireThread = {};
+
+	// Counters
+	std::chrono::steady_clock::time_point StartTime   = {};
+	std::atomic<std::uint64_t>            Submits     = 0;
+	std::atomic<std::uint64_t>            SubmitInfos = 0;
+
+	std::atomic<std::uint64_t> ReadyWaits     = 0;
+	std::atomic<std::uint64_t> SpunWaits      = 0;
+	std::atomic<std::uint64_t> BlockedWaits   = 0;
+	std::atomic<std::uint64_t> Stalls         = 0;
+	std::atomic<std::uint64_t> SuspectedHangs = 0;
+
+	std::array<std::atomic<std::uint64_t>, WaitBucketBounds.size() + 1>
+							   WaitHistogram   = {};
+	std::atomic<std::int64_t> TotalWaitTime   = 0;
+	std::atomic<std::int64_t> LongestWaitTime = 0;
+
+	mutable std::mutex StallMutex = {};
+	Stall              LastStall  = {};
+};
+} // namespace Vulkanator
@@ -0,0 +1,145 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "ContentHash.hpp"
+#include "MemoryAllocator.hpp"
+#include "VulkanConfig.hpp"
+
+namespace Vulkanator
+{
+class DestructionQueue;
+
+// A GPU-side image along with what is known about its contents
+struct Texture
+{
+	vk::ImageCreateInfo           Info   = {};
+	vk::UniqueImage               Image  = {};
+	VulkanUtils::MemoryAllocation Memory = {};
+	vk::DeviceSize                Size   = 0;
+
+	// Created along with the image, since the texture may be shared among
+	// render threads right after. See GlobalParams::ImageViewSerial
+	vk::UniqueImageView View       = {};
+	std::uint64_t       ViewSerial = 0;
+
+	// The layout that the last write left the image in
+	vk::ImageLayout Layout = vk::ImageLayout::eUndefined;
+
+	// Fingerprints of each tile of the image's current contents, so that a
+	// new upload into the image only has to write the tiles that differ.
+	// Empty when the contents are not known
+	std::vector<Hash128> TileHashes = {};
+};
+
+// Process-wide cache of textures, addressed by their contents
+//
+// Effect instances on layers that reference the same footage or precomp get
+// the very same input pixels. The first render to upload them publishes its
+// texture here, and every other render with identical pixels samples that
+// texture rather than uploading its own copy.
+//
+// Textures are reference counted through their shared pointers. Once
+// published, a texture is never written to again while anything outside of
+// the cache still holds a reference to it. Only textures that are solely held
+// by the cache may be evicted, least recently used first, or reclaimed by a
+// render to be written over with new contents.
+class TextureCache
+{
+public:
+	struct Key
+	{
+		Hash128      Hash   = {};
+		vk::Format   Format = vk::Format::eUndefined;
+		vk::Extent3D Extent = {};
+
+		bool operator==(const Key& Other) const = default;
+	};
+
+	struct Statistics
+	{
+		std::uint64_t  Hits     = 0;
+		std::uint64_t  Misses   = 0;
+		std::size_t    Textures = 0;
+		vk::DeviceSize Size     = 0;
+	};
+
+	TextureCache() = default;
+
+	TextureCache(const TextureCache&)            = delete;
+	TextureCache& operator=(const TextureCache&) = delete;
+
+	// Textures beyond this many bytes are evicted, as long as nothing outside
+	// of the cache is holding on to them
+	void SetBudget(vk::DeviceSize NewBudget);
+
+	// Textures that are trimmed or replaced are retired into `NewDestruction`
+	// rather than destroyed while the cache is locked. Textures that are
+	// evicted to make room for an allocation are still destroyed right away
+	void SetDestructionQueue(DestructionQueue* NewDestruction);
+
+	// Returns the texture that holds the contents of `TextureKey`, or nullptr.
+	// The returned texture may only be read from
+	std::shared_ptr<Texture> Find(const Key& TextureKey);
+
+	// Publishes a texture that holds the contents of `TextureKey`, which must
+	// not be written to again by the caller
+	void Insert(const Key& TextureKey, std::shared_ptr<Texture> NewTexture);
+
+	// Returns a texture created with `Info` that the caller may write to, or
+	// nullptr if the caller has to create one.
+	// `Current` is the texture that the caller last used, which is preferred
+	// so that its contents may be partially re-used. Otherwise, the least
+	// recently used texture that nothing else holds on to is taken out of the
+	// cache
+	std::shared_ptr<Texture> Reclaim(
+		const vk::ImageCreateInfo& Info, const std::shared_ptr<Texture>& Current
+	);
+
+	// Evicts the least recently used texture that nothing outside of the
+	// cache is holding on to. Returns false if there was no such texture
+	bool EvictOne();
+
+	// Drops every texture
+	void Clear();
+
+	Statistics GetStatistics() const;
+
+private:
+	struct Entry
+	{
+		Key                      TextureKey = {};
+		std::shared_ptr<Texture> Value      = {};
+		std::uint64_t            LastUse    = 0;
+	};
+
+	// Evicts least recently used textures until the cache is within budget
+	// Requires `CacheMutex` to be held
+	void Trim();
+
+	// Takes the least recently used texture that nothing outside of the
+	// cache is holding on to out of the cache, or returns nullptr
+	// Requires `CacheMutex` to be held
+	std::shared_ptr<Texture> EvictOldest();
+
+	// Destroys `Evicted` once the GPU is done with it
+	void Retire(std::shared_ptr<Texture>&& Evicted);
+
+	mutable std::mutex CacheMutex = {};
+
+	// Only ever a handful of textures, which a linear search handles fine
+	std::vector<Entry> Entries = {};
+	std::uint64_t      UseTick = 0;
+
+	vk::DeviceSize Budget = 0;
+	vk::DeviceSize Size   = 0;
+
+	DestructionQueue* Destruction = nullptr;
+
+	std::uint64_t Hits   = 0;
+	std::uint64_t Misses = 0;
+};
+} // namespace Vulkanator
@@ -7,6 +7,7 @@
 #include <span>
 #include <tuple>
 
+#include "MemoryAllocator.hpp"
 #include "VulkanConfig.hpp"
 #include "vulkan/vulkan.hpp"
 
@@ -48,21 +49,34 @@ std::optional<vk::UniqueDeviceMemory> AllocateDeviceMemory(
 	vk::Image  DedicatedImage  = vk::Image()
 );
 
-std::optional<std::tuple<vk::UniqueBuffer, vk::UniqueDeviceMemory>>
-	AllocateBuffer(
-		vk::Device Device, vk::PhysicalDevice PhysicalDevice, std::size_t Size,
-		vk::BufferUsageFlags Usage, vk::MemoryPropertyFlags Properties,
-		vk::MemoryPropertyFlags ExcludeProperties
-		= vk::MemoryPropertyFlagBits::eProtected,
-		vk::SharingMode Sharing = vk::SharingMode::eExclusive
-	);
+// Creates a buffer or image, and binds it to memory from `Allocator`
+// Buffers that are shared concurrently must list their queue families
+std::optional<std::tuple<vk::UniqueBuffer, MemoryAllocation>> AllocateBuffer(
+	MemoryAllocator& Allocator, std::size_t Size, vk::BufferUsageFlags Usage,
+	vk::MemoryPropertyFlags Properties,
+	vk::MemoryPropertyFlags ExcludeProperties
+	= vk::MemoryPropertyFlagBits::eProtected,
+	vk::SharingMode                Sharing       = vk::SharingMode::eExclusive,
+	std::span<const std::uint32_t> QueueFamilies = {}
+);
 
-std::optional<std::tuple<vk::UniqueImage, vk::UniqueDeviceMemory>>
-	AllocateImage(
+std::optional<std::tuple<vk::UniqueImage, MemoryAllocation>> AllocateImage(
+	MemoryAllocator& Allocator, vk::ImageCreateInfo NewImageInfo,
+	vk::MemoryPropertyFlags Properties,
+	vk::MemoryPropertyFlags ExcludeProperties
+	= vk::MemoryPropertyFlagBits::eProtected
+);
+
+// Imports a region of host memory as a buffer, using
+// VK_EXT_external_memory_host
+// Both `HostPointer` and `Size` must be multiples of `Alignment`, which must be
+// the device's `minImportedHostPointerAlignment`. Returns an empty result if
+// they are not, so that the region may be staged instead
+std::optional<std::tuple<vk::UniqueBuffer, vk::UniqueDeviceMemory>>
+	ImportHostBuffer(
 		vk::Device Device, vk::PhysicalDevice PhysicalDevice,
-		vk::ImageCreateInfo NewImageInfo, vk::MemoryPropertyFlags Properties,
-		vk::MemoryPropertyFlags ExcludeProperties
-		= vk::MemoryPropertyFlagBits::eProtected
+		const vk::DispatchLoaderDynamic& Dispatcher, void* HostPointer,
+		std::size_t Size, vk::BufferUsageFlags Usage, vk::DeviceSize Alignment
 	);
 
 std::optional<vk::UniqueShaderModule>
@@ -73,6 +87,51 @@ vk::MemoryHeap GetLargestPhysicalDeviceHeap(
 	vk::MemoryHeapFlags       Flags = vk::MemoryHeapFlagBits::eDeviceLocal
 );
 
+// How a physical device's memory is laid out relative to the host's memory
+enum class MemoryTopology
+{
+	// Device-local memory is separate from host memory, and the host can only
+	// map a small window of it, if any
+	Discrete,
+	// Device-local memory is separate from host memory, but the host may map
+	// all of it(Resizable BAR/Smart Access Memory)
+	ResizableBar,
+	// The device and the host share the same physical memory, such as with
+	// integrated GPUs
+	Unified,
+};
+
+inline constexpr const char* MemoryTopologyName(MemoryTopology Topology)
+{
+	switch( Topology )
+	{
+	case MemoryTopology::Discrete:
+		return "Discrete";
+	case MemoryTopology::ResizableBar:
+		return "Resizable BAR";
+	case MemoryTopology::Unified:
+		return "Unified";
+	}
+	return "Unknown";
+}
+
+MemoryTopology ClassifyMemoryTopology(const vk::PhysicalDevice& PhysicalDevice);
+
+// Copies rows of pixels into and out of a linear-tiled image that is bound to
+// host-visible memory. The image's own row pitch is queried from its
+// subresource layout, so it does not have to match the host's row pitch
+bool WriteLinearImage(
+	vk::Device Device, vk::Image Image, const MemoryAllocation& Memory,
+	const void* Source, std::size_t SourceRowPitch, std::size_t RowSize,
+	std::uint32_t RowCount
+);
+
+bool ReadLinearImage(
+	vk::Device Device, vk::Image Image, const MemoryAllocation& Memory,
+	void* Destination, std::size_t DestinationRowPitch, std::size_t RowSize,
+	std::uint32_t RowCount
+);
+
 // Debug callback
 VKAPI_ATTR VkBool32 VKAPI_CALL DebugMessageCallback(
 	VkDebugUtilsMessageSeverityFlagBitsEXT      MessageSeverity,
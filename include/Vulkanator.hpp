@@ -1,21 +1,76 @@
 #pragma once
 
 #include <array>
+#include <atomic>
+#include <chrono>
 #include <cmath>
+#include <cstddef>
 #include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <vector>
 
 #define PF_DEEP_COLOR_AWARE 1
 #include <AEConfig.h>
 
 #include <AE_Effect.h>
+#include <AE_EffectSuites.h>
 #include <entry.h>
 
+#include "ContentHash.hpp"
+#include "DescriptorAllocator.hpp"
+#include "DestructionQueue.hpp"
+#include "MemoryManager.hpp"
+#include "ResultCache.hpp"
+#include "StagingRing.hpp"
+#include "SubmissionService.hpp"
+#include "TextureCache.hpp"
 #include "VulkanConfig.hpp"
+#include "VulkanUtils.hpp"
 
 #include <glm/glm.hpp>
 
 namespace Vulkanator
 {
+// How the pixels of a frame get from After Effects' layers into the GPU, and
+// back out again
+// Chosen for each frame based on the device's memory topology, what the device
+// supports, and the frame itself
+enum class TransferPlan
+{
+	// The input and output images are linear images within host-visible
+	// memory, which the CPU writes and reads directly. Only worth it when the
+	// device and the host share the same memory
+	DirectLinear,
+	// The CPU writes the input image and reads the output image directly,
+	// using VK_EXT_host_image_copy
+	HostImageCopy,
+	// The input layer is written into a staging buffer within device-local,
+	// host-visible(write-combined) memory, and the output layer is read back
+	// through a host-cached staging buffer
+	WriteCombinedUpload,
+	// Both layers go through host-cached staging buffers, which the GPU copies
+	// from and into
+	CachedReadback,
+};
+
+inline constexpr const char* TransferPlanName(TransferPlan Plan)
+{
+	switch( Plan )
+	{
+	case TransferPlan::DirectLinear:
+		return "Direct linear image";
+	case TransferPlan::HostImageCopy:
+		return "Host image copy";
+	case TransferPlan::WriteCombinedUpload:
+		return "Write-combined upload";
+	case TransferPlan::CachedReadback:
+		return "Cached readback";
+	}
+	return "Unknown";
+}
+
 // Global effect variables
 // See GlobalSetup and GlobalSetdown
 struct GlobalParams
@@ -25,16 +80,161 @@ struct GlobalParams
 	vk::UniqueDevice   Device         = {};
 	vk::PhysicalDevice PhysicalDevice = {};
 
+	// The memory of every buffer and image is sub-allocated from here
+	// Declared after the device so that it is destroyed before the device, but
+	// after everything that was allocated from it
+	VulkanUtils::MemoryAllocator Allocator = {};
+
+	// Keeps the caches of every sequence within the device's memory budget
+	MemoryManager Memory = {};
+
+	// Every render streams the pixels of its layers through these
+	// The write-combined ring is only for uploads, and only when the host is
+	// able to write into device-local memory. Everything else goes through
+	// the host-cached ring
+	// Both are created upon the first render, see EnsureStagingRings
+	StagingRing       Staging              = {};
+	StagingRing       WriteCombinedStaging = {};
+	std::mutex        StagingMutex         = {};
+	std::atomic<bool> StagingReady         = false;
+
+	// Optional device capabilities that were detected and enabled during
+	// GlobalSetup
+	struct DeviceFeatures
+	{
+		// VK_EXT_memory_budget
+		// The driver reports how much of each memory heap the process may use
+		bool MemoryBudget = false;
+
+		// VK_KHR_push_descriptor
+		// The input image is pushed along with each render pass, rather than
+		// written into a descriptor set of each render context
+		bool PushDescriptor = false;
+
+		// VK_KHR_timeline_semaphore
+		// The submission service tracks the completion of requests with a
+		// timeline semaphore of each queue, rather than a fence of each batch
+		bool TimelineSemaphore = false;
+
+		// VK_EXT_external_memory_host
+		// Host pointers must be imported at this address and size granularity
+		bool           ExternalMemoryHost              = false;
+		vk::DeviceSize MinImportedHostPointerAlignment = 0;
+
+		// VK_EXT_host_image_copy
+		// Layouts that the images are in when the host writes the input image
+		// and reads the output image
+		bool            HostImageCopy           = false;
+		vk::ImageLayout HostImageUploadLayout   = vk::ImageLayout::eGeneral;
+		vk::ImageLayout HostImageReadbackLayout = vk::ImageLayout::eGeneral;
+
+		// Largest linear-tiled image that may be both sampled from and
+		// rendered into, for each render format. Zero if not supported
+		std::array<vk::Extent3D, 3> LinearImageMaxExtent = {};
+	} Features;
+
+	// How the device's memory relates to the host's memory, which decides
+	// how pixels are best transferred between After Effects and the GPU
+	VulkanUtils::MemoryTopology Topology = VulkanUtils::MemoryTopology::Discrete;
+
+	// The transfer plan of the most recently rendered frame
+	std::atomic<TransferPlan> LastTransferPlan = TransferPlan::CachedReadback;
+
+	// Every frame uses this transfer plan instead, whenever the device and the
+	// frame allow for it. Set with VULKANATOR_TRANSFER_PLAN, to compare the
+	// plans against each other
+	std::optional<TransferPlan> ForcedTransferPlan = std::nullopt;
+
+	// Input layer uploads across all renders
+	struct UploadStatistics
+	{
+		std::atomic<std::uint64_t> Bytes        = 0;
+		std::atomic<std::uint64_t> Tiles        = 0;
+		std::atomic<std::uint64_t> SkippedTiles = 0;
+	} UploadStats;
+
+	// Lookups into the render contexts' caches of images across all renders
+	// Spares that get swapped back in count as hits
+	struct RenderCacheStatistics
+	{
+		std::atomic<std::uint64_t> ImageHits   = 0;
+		std::atomic<std::uint64_t> ImageMisses = 0;
+	} CacheStats;
+
+	// Vulkan calls of the render path that set up objects for a render, which
+	// are the calls that create objects or write descriptors, and the time
+	// spent within them. A render where every cache hits makes none of these
+	// at all. Submits, command recording, and waits are not counted
+	struct SetupCallStatistics
+	{
+		// Every render, whether it made any setup calls or not
+		std::atomic<std::uint64_t> Frames      = 0;
+		std::atomic<std::uint64_t> Calls       = 0;
+		std::atomic<std::uint64_t> Nanoseconds = 0;
+		// Vulkan objects that the calls created, such as images, views,
+		// framebuffers, and the command buffers and descriptor sets of new
+		// render contexts. Sub-allocations of staging rings are not objects
+		std::atomic<std::uint64_t> Creations = 0;
+	} SetupStats;
+
+	// Renders that submitted the re-usable commands of their render context
+	// again, rather than recording them, and the time that recording them
+	// took when they were last recorded
+	struct CommandReuseStatistics
+	{
+		std::atomic<std::uint64_t> Recordings       = 0;
+		std::atomic<std::uint64_t> Reuses           = 0;
+		std::atomic<std::uint64_t> SavedNanoseconds = 0;
+	} ReuseStats;
+
+	// Image views get a serial number that is never re-used, unlike the
+	// handles of destroyed views. A descriptor set that refers to a view that
+	// has since been destroyed is then never mistaken for being up to date
+	std::atomic<std::uint64_t> ImageViewSerial = 0;
+
+	// Frames with images beyond these limits are rendered in tiles
+	// The largest width or height of an image that may be both sampled from
+	// and rendered into
+	std::uint32_t MaxImageDimension = 0;
+	// How much device memory the images of a single render may take up
+	vk::DeviceSize ImageMemoryBudget = 0;
+
 	// Dispatcher for loading ~extension~ function pointers
 	// Use this dispatcher to load additional function pointers
 	// for extensions that Vulkan-HPP does not load automatically
 	vk::DispatchLoaderDynamic Dispatcher = {};
 
-	// A heap to allocate CommandBuffers from
-	vk::UniqueCommandPool CommandPool = {};
-
-	// Queue that will be receiving GPU workloads
-	vk::Queue Queue = {};
+	// Queue families that GPU workloads are dispatched into
+	// When the device has a transfer-only queue family, uploads and readbacks
+	// run on a queue of that family so that the device's copy engines may work
+	// alongside rendering. Otherwise, everything runs on the graphics queue
+	std::uint32_t GraphicsQueueFamily    = 0;
+	std::uint32_t TransferQueueFamily    = 0;
+	bool          DedicatedTransferQueue = false;
+
+	// Input textures that are shared among every effect instance, addressed by
+	// the contents of their input layers
+	TextureCache Textures = {};
+
+	// Rendered frames that are kept on disk across sessions
+	// Only enabled when the VULKANATOR_RENDER_CACHE environment variable names
+	// a directory to keep them in
+	ResultCache Results = {};
+
+	// Owns the queues that will be receiving GPU workloads
+	// Render threads never submit into the queues directly, but hand their
+	// recorded command buffers over to this service
+	SubmissionService Submitter = {};
+
+	// Images and textures that renders have no more use for are destroyed by
+	// this queue's thread once the GPU is done with them, rather than by the
+	// render that let go of them. Declared after the submission service,
+	// whose timelines it waits on
+	DestructionQueue Destruction = {};
+
+	// Indices of each queue within the submission service
+	static constexpr std::uint32_t GraphicsQueueIndex = 0;
+	static constexpr std::uint32_t TransferQueueIndex = 1;
 
 	// For each color depth, create a render pass
 	// 0: Render pass with a single  8-bit attachment
@@ -47,8 +247,17 @@ struct GlobalParams
 	// three times for each render format depth
 	std::array<vk::UniquePipeline, 3> RenderPipelines = {};
 
+	// The input image is sampled with one of these, depending on After
+	// Effects' quality setting. Both are created up-front
+	// 0: Nearest interpolation, for low quality
+	// 1: Linear interpolation, for high quality
+	std::array<vk::UniqueSampler, 2> InputImageSamplers = {};
+
 	// This is the heap that we will be allocating descriptors from
-	vk::UniqueDescriptorPool DescriptorPool = {};
+	// It grows by another descriptor pool whenever the existing ones run out,
+	// so there is no upper limit to how many render contexts may exist
+	// Unused with push descriptors
+	DescriptorAllocator Descriptors = {};
 
 	// Because we will be making descriptor sets at run-time. We will need
 	// the pipeline's layout and Descriptor set layout which basically will
@@ -58,85 +267,233 @@ struct GlobalParams
 	vk::UniquePipelineLayout      RenderPipelineLayout      = {};
 
 	// This buffer will store our very simple quad-triangle mesh
-	vk::UniqueBuffer       MeshBuffer       = {};
-	vk::UniqueDeviceMemory MeshBufferMemory = {};
+	vk::UniqueBuffer              MeshBuffer       = {};
+	VulkanUtils::MemoryAllocation MeshBufferMemory = {};
 
 	// Debug Callback
 	vk::UniqueHandle<vk::DebugUtilsMessengerEXT, vk::DispatchLoaderDynamic>
 		DebugMessenger = {};
 };
 
-// Sequence params, per composition
-// See SequenceSetup and SequenceSetdown
-struct SequenceParams
+// Identifies the pixels of a checked out input layer
+// After Effects' state of the layer covers its source and everything upstream
+// of this effect, and the region and downsampling decide which of those pixels
+// were checked out
+struct InputLayerIdentity
 {
-	// Each instance of the effect will get a command buffer it may use to
-	// generate GPU workloads
-	vk::UniqueCommandBuffer CommandBuffer = {};
-	// Each instance of the effect will get a synchronization fence it may use
-	// when submitting GPU workloads
-	vk::UniqueFence Fence = {};
+	PF_State         State       = {};
+	PF_LRect         Rect        = {};
+	PF_RationalScale DownsampleX = {};
+	PF_RationalScale DownsampleY = {};
+};
 
-	// Each instance of the effect will get a descriptor set to pass it's
-	// uniform data over to the shader
-	vk::UniqueDescriptorSet DescriptorSet = {};
+// Per-thread render state
+// Every in-flight SmartRender call checks out one of these from its sequence's
+// pool of render contexts. This way, concurrent frames of the same sequence
+// never share any mutable Vulkan state and may render in parallel
+struct RenderContext
+{
+	// Command pools require external synchronization, so each render context
+	// gets its own pool to allocate its command buffer from
+	vk::UniqueCommandPool CommandPool = {};
 
-	// The actual buffer that will hold the uniform buffer that the descriptor
-	// set will point to
-	vk::UniqueBuffer       UniformBuffer       = {};
-	vk::UniqueDeviceMemory UniformBufferMemory = {};
+	// Each render context will get a command buffer it may use to generate GPU
+	// workloads
+	vk::UniqueCommandBuffer CommandBuffer = {};
 
-	// This is a collection of cached memory attached to this effect-instance
-	// this is so that we arent making heavy gpu-side allocations every frame
-	struct SequenceCache
+	// The commands that come before and after the render pass stay the same
+	// from one frame to the next, for as long as the render context renders
+	// between the same images through the same ranges of the staging rings.
+	// These are recorded once and submitted again by every render that
+	// follows, and only the render pass itself, along with its push
+	// constants, is recorded into the command buffer above every frame. The
+	// upload and readback command buffers below are re-used the same way
+	vk::UniqueCommandBuffer PrologueCommandBuffer = {};
+	vk::UniqueCommandBuffer EpilogueCommandBuffer = {};
+
+	// Everything that the re-usable commands were recorded with. They are
+	// recorded again as soon as any of it differs from the current render
+	struct RecordedCommands
+	{
+		// Serials rather than handles, which may be re-used by new images
+		std::uint64_t   InputViewSerial  = 0;
+		std::uint64_t   OutputViewSerial = 0;
+		vk::ImageLayout InputPriorLayout = vk::ImageLayout::eUndefined;
+
+		TransferPlan Plan           = {};
+		bool         InputUnchanged = false;
+		bool         InputKept      = false;
+		bool         SplitTransfer  = false;
+
+		vk::Buffer     UploadBuffer    = {};
+		vk::DeviceSize UploadOffset    = 0;
+		vk::DeviceSize InputLayerSize  = 0;
+		vk::Buffer     ReadbackBuffer  = {};
+		vk::DeviceSize ReadbackOffset  = 0;
+		vk::DeviceSize OutputLayerSize = 0;
+		std::uint32_t  OutputRowLength = 0;
+
+		// The dirty tiles of the input layer
+		std::vector<vk::BufferImageCopy> UploadRegions = {};
+
+		bool operator==(const RecordedCommands&) const = default;
+	};
+	// Empty when the re-usable commands are not in a state to be submitted
+	std::optional<RecordedCommands> Recorded = {};
+	// How long recording the re-usable commands took
+	std::chrono::nanoseconds RecordTime = {};
+
+	// Only when there is a dedicated transfer queue
+	// The upload and readback are recorded into their own command buffers of
+	// the transfer queue's family, and these semaphores order the upload before
+	// the render, and the render before the readback
+	vk::UniqueCommandPool   TransferCommandPool   = {};
+	vk::UniqueCommandBuffer UploadCommandBuffer   = {};
+	vk::UniqueCommandBuffer ReadbackCommandBuffer = {};
+	vk::UniqueSemaphore     UploadSemaphore       = {};
+	vk::UniqueSemaphore     RenderSemaphore       = {};
+
+	// Large frames are split into bands that are submitted individually, so
+	// that the CPU may copy one band while the GPU works on another. Each band
+	// is recorded into its own command buffer. Allocated as needed
+	std::vector<vk::UniqueCommandBuffer> BandCommandBuffers = {};
+	// Each render context will get a descriptor set to pass its input image
+	// over to the shader. Only without push descriptors
+	DescriptorAllocator::DescriptorSet DescriptorSet = {};
+
+	// The input image that the next render pass samples from. With push
+	// descriptors, it is pushed along with the render pass. Otherwise, this
+	// is what the descriptor set currently points to, so that it is only
+	// written when the input image, its sampler, or its layout changes
+	struct BoundImage
 	{
-		// If we are only using a smaller subset of the entire buffer
-		// Then we should resize the entire buffer to be smaller if it is this
-		// percentage smaller than the cached size
+		vk::ImageView   View       = {};
+		std::uint64_t   ViewSerial = 0;
+		vk::Sampler     Sampler    = {};
+		vk::ImageLayout Layout     = vk::ImageLayout::eUndefined;
 
-		// If an allocation comes in that is %15 smaller than the cache, then
-		// the buffer to fit
-		static constexpr glm::f32 ShrinkThreshold = 0.15f;
+		bool operator==(const BoundImage&) const = default;
+	} BoundInputImage;
 
-		// Cache for the staging buffer
-		std::size_t            StagingBufferSize   = 0u;
-		vk::UniqueBuffer       StagingBuffer       = {};
-		vk::UniqueDeviceMemory StagingBufferMemory = {};
+	// This is a collection of cached memory attached to this render context
+	// this is so that we arent making heavy gpu-side allocations every frame
+	struct RenderCache
+	{
+		// An image, along with the memory that it is bound to
+		struct CachedImage
+		{
+			// We use these structs so that we can easily "==" compare the
+			// image in the cache with any new requests coming in
+			vk::ImageCreateInfo           Info   = {};
+			vk::UniqueImage               Image  = {};
+			VulkanUtils::MemoryAllocation Memory = {};
+			// The layout that the previous render left the image in
+			vk::ImageLayout Layout = vk::ImageLayout::eUndefined;
+
+			// Created the first time that the image is used, and kept for as
+			// long as the image is. Only output images get a framebuffer
+			vk::UniqueImageView   View        = {};
+			std::uint64_t         ViewSerial  = 0;
+			vk::UniqueFramebuffer Framebuffer = {};
+		};
+
+		// The input image of renders where the host writes the input image
+		// directly, and of tiled renders. These belong to this render context
+		// alone
+		CachedImage Input = {};
+
+		// The input texture of renders where the GPU copies the input layer
+		// into the input image. It may be shared with other render contexts
+		// through the global texture cache
+		std::shared_ptr<Texture> InputTexture = {};
+
+		// The input layer that the current input image or texture was
+		// uploaded from. When a render's input layer is identical, such as
+		// when only the effect's parameters changed, nothing is uploaded at
+		// all. Empty when the contents are not known
+		std::optional<InputLayerIdentity> InputIdentity = {};
+		// The hash of the contents of that same input layer, once known
+		std::optional<Hash128> InputHash = {};
+
+		CachedImage Output = {};
+
+		// Images of previous renders that did not match the current render,
+		// most recently used first. When After Effects switches between
+		// resolutions or bit depths, such as between full and downsampled
+		// previews, these get swapped back in rather than allocating new ones
+		static constexpr std::size_t SpareCapacity = 4;
+		std::vector<CachedImage>     SpareImages   = {};
+
+		// Device memory that all of the above are holding on to
+		vk::DeviceSize GetFootprint() const;
+	} Cache;
 
-		// We use these structs so that we can easily "==" compare the image in
-		// the cache with any new requests coming in
-		vk::ImageCreateInfo InputImageInfoCache  = {};
-		vk::ImageCreateInfo OutputImageInfoCache = {};
+	// Set once the GPU work of a render timed out. The GPU may still be
+	// executing commands that refer to this context, so it is retired into
+	// the destruction queue rather than returned to its pool
+	bool Abandoned = false;
+};
 
-		vk::UniqueImage        InputImage       = {};
-		vk::UniqueDeviceMemory InputImageMemory = {};
+// Render contexts that are not currently checked out by a render thread.
+// After Effects may render multiple frames of the same sequence at once,
+// so a render thread takes a context out of this pool for the duration of
+// its render and puts it back when it is done. New contexts are only
+// created when every existing context is currently in use, so a sequence that
+// never renders never creates any.
+//
+// The memory manager holds on to every pool weakly, and frees the caches of
+// its unused contexts when the device runs low on memory, or when the sequence
+// has not rendered for a while
+struct RenderContextPool
+{
+	std::mutex                                  ContextMutex = {};
+	std::vector<std::unique_ptr<RenderContext>> FreeContexts = {};
+
+	// See MemoryManager::Touch
+	std::atomic<std::uint64_t>                         LastRender     = 0;
+	std::atomic<std::chrono::steady_clock::time_point> LastRenderTime = {};
+	// Device memory that the caches of the unused contexts are holding on to
+	std::atomic<vk::DeviceSize> Footprint = 0;
+
+	// Returns an unused render context, or nullptr if all of them are in-use
+	std::unique_ptr<RenderContext> AcquireContext();
+	// Returns a render context back into the pool for re-use
+	void ReleaseContext(std::unique_ptr<RenderContext> Context);
+
+	// Frees the caches of every unused context
+	// Returns how much device memory they were holding on to
+	vk::DeviceSize EvictCaches();
+};
 
-		vk::UniqueImage        OutputImage       = {};
-		vk::UniqueDeviceMemory OutputImageMemory = {};
-	} Cache;
+// Sequence params, per composition
+// See SequenceSetup and SequenceSetdown
+struct SequenceParams
+{
+	// Shared with the render threads that currently have a context checked
+	// out, so that the pool outlives the sequence until they are done
+	std::shared_ptr<RenderContextPool> Contexts = {};
 };
 
 // For rendering the current frame
 struct RenderParams
 {
-	// The sampler is created upon rendering since we will
-	// potentially be using different wrapping/quality settings
-	// such as nearest/linear and wrapping
-	// If you want, you can cache all possible sampler objects
-	// ahead of time or you can create it on the fly(it's a very cheap object)
-	vk::UniqueSampler InputImageSampler = {};
-
-	// Values passed over to vulkan
-	// Aligned for the std140 layout
+	// The region of the input layer's full frame that was checked out
+	PF_LRect InputRect = {};
+
+	// Values passed over to vulkan, as push constants
+	// Aligned for the std430 layout that push constants use
 	// scalars:	4
 	// vec2:	8
 	// vect3/4: 16
 	// mat4:	16
-	struct
+	struct UniformParams
 	{
 		alignas(4) glm::u32 Depth            = {};
 		alignas(16) glm::f32mat4 Transform   = {};
 		alignas(16) glm::f32vec4 ColorFactor = {};
+		// Scales the quad's texture coordinates, for when the input occupies
+		// only the top-left corner of the input image
+		alignas(8) glm::f32vec2 CoordScale = {1.0f, 1.0f};
 	} Uniforms;
 };
 
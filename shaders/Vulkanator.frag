@@ -6,12 +6,12 @@ layout(location = 0) in f32vec2 InCoord;
 
 layout(location = 0) out f32vec4 FragColor;
 
-layout(binding = 0) uniform Uniforms
+layout(push_constant) uniform Uniforms
 {
 	VulkanatorRenderParams RenderParams;
 };
 
-layout(binding = 1) uniform sampler2D InputTexture;
+layout(binding = 0) uniform sampler2D InputTexture;
 
 void main()
 {
@@ -15,4 +15,5 @@ struct VulkanatorRenderParams
 	uint32_t Depth;
 	f32mat4  Transform;
 	f32vec4  ColorFactor;
+	f32vec2  CoordScale;
 };
\ No newline at end of file
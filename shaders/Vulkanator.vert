@@ -7,7 +7,7 @@ layout(location = 1) in f32vec2 InCoord;
 
 layout(location = 0) out f32vec2 OutCoord;
 
-layout(binding = 0) uniform Uniforms
+layout(push_constant) uniform Uniforms
 {
 	VulkanatorRenderParams RenderParams;
 };
@@ -17,5 +17,5 @@ void main()
 	gl_Position = f32vec4(
 		(RenderParams.Transform * f32vec4(InPosition, 0.0, 1.0)).xy, 0.0, 1.0
 	);
-	OutCoord = InCoord;
+	OutCoord = InCoord * RenderParams.CoordScale;
 }
\ No newline at end of file
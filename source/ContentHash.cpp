@@ -0,0 +1,290 @@
+#include "ContentHash.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+#define VULKANATOR_HASH_SSE2
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+#define VULKANATOR_HASH_NEON
+#include <arm_neon.h>
+#endif
+
+namespace Vulkanator
+{
+
+namespace
+{
+static constexpr std::uint32_t Prime32_1 = 0x9E3779B1U;
+static constexpr std::uint32_t Prime32_2 = 0x85EBCA77U;
+static constexpr std::uint32_t Prime32_3 = 0xC2B2AE3DU;
+static constexpr std::uint64_t Prime64_1 = 0x9E3779B185EBCA87ULL;
+static constexpr std::uint64_t Prime64_2 = 0xC2B2AE3D27D4EB4FULL;
+static constexpr std::uint64_t Prime64_3 = 0x165667B19E3779F9ULL;
+static constexpr std::uint64_t Prime64_4 = 0x85EBCA77C2B2AE63ULL;
+static constexpr std::uint64_t Prime64_5 = 0x27D4EB2F165667C5ULL;
+
+static constexpr std::size_t StripesPerBlock = 16;
+
+// Keys that each stripe is mixed with. Stripe `i` of a block uses the eight
+// keys starting at `Secret[i]`, and the scramble uses the last eight
+static constexpr std::array<std::uint64_t, 24> Secret = {
+	0x90EBB573C50960CF, 0x79EB6B2CC53B5F61, 0xC69465C70C89F993,
+	0xBB6BEC36EAC44C34, 0xBCD9D435C4D4683E, 0xDBA5AC20C7181977,
+	0x35B78E00ABC7C81D, 0x56EA6A287EEC10B9, 0xBB3CC612FD51694A,
+	0xFCD83D31F8BF57DC, 0x28FD8F143C505E36, 0x5F6324E631071F9D,
+	0xEAA05BDC7429EB8A, 0xFE7EC3DC2908A869, 0x49470B72043CF10D,
+	0xC605A8E0E9D653B1, 0x1DCE3E4BD68021D4, 0xADF491B84CF19E25,
+	0x72A7496E0A0AD23B, 0xDC6AA84B10A0147D, 0x55B035F396F63E7F,
+	0x7CB2AFE3A0FE1DD3, 0xB97F02860204C2E3, 0x1B0D733B42EDFBB2,
+};
+static constexpr std::size_t ScrambleKeyOffset = 16;
+
+// Mixes `StripeCount` stripes into the accumulators, scrambling them at the
+// end of each block
+void AccumulateStripes(
+	std::array<std::uint64_t, 8>& Accumulators, const std::byte* Data,
+	std::size_t StripeCount, std::size_t& StripeIndex
+)
+{
+#if defined(VULKANATOR_HASH_SSE2)
+	__m128i Acc[4];
+	for( std::size_t i = 0; i < 4; ++i )
+	{
+		Acc[i] = _mm_loadu_si128(
+			reinterpret_cast<const __m128i*>(&Accumulators[i * 2])
+		);
+	}
+	const __m128i Prime = _mm_set1_epi32(int(Prime32_1));
+#elif defined(VULKANATOR_HASH_NEON)
+	uint64x2_t Acc[4];
+	for( std::size_t i = 0; i < 4; ++i )
+	{
+		Acc[i] = vld1q_u64(&Accumulators[i * 2]);
+	}
+	const uint32x2_t Prime = vdup_n_u32(Prime32_1);
+#endif
+
+	for( std::size_t CurStripe = 0; CurStripe < StripeCount; ++CurStripe )
+	{
+		const std::byte* Stripe = Data + CurStripe * ContentHasher::StripeSize;
+		const std::uint64_t* Key = &Secret[StripeIndex];
+
+#if defined(VULKANATOR_HASH_SSE2)
+		for( std::size_t i = 0; i < 4; ++i )
+		{
+			const __m128i Lane
+				= _mm_loadu_si128(reinterpret_cast<const __m128i*>(Stripe) + i);
+			const __m128i LaneKey = _mm_xor_si128(
+				Lane,
+				_mm_loadu_si128(reinterpret_cast<const __m128i*>(Key + i * 2))
+			);
+			// Low 32 bits times the high 32 bits of each 64-bit lane
+			const __m128i Product = _mm_mul_epu32(
+				LaneKey, _mm_shuffle_epi32(LaneKey, _MM_SHUFFLE(0, 3, 0, 1))
+			);
+			// Each accumulator also takes the neighboring lane's data
+			const __m128i Swapped
+				= _mm_shuffle_epi32(Lane, _MM_SHUFFLE(1, 0, 3, 2));
+			Acc[i] = _mm_add_epi64(Acc[i], _mm_add_epi64(Product, Swapped));
+		}
+#elif defined(VULKANATOR_HASH_NEON)
+		for( std::size_t i = 0; i < 4; ++i )
+		{
+			const uint64x2_t Lane = vld1q_u64(
+				reinterpret_cast<const std::uint64_t*>(Stripe) + i * 2
+			);
+			const uint64x2_t LaneKey = veorq_u64(Lane, vld1q_u64(Key + i * 2));
+			// Each accumulator also takes the neighboring lane's data
+			Acc[i] = vaddq_u64(Acc[i], vextq_u64(Lane, Lane, 1));
+			// Low 32 bits times the high 32 bits of each 64-bit lane
+			Acc[i] = vmlal_u32(
+				Acc[i], vmovn_u64(LaneKey), vshrn_n_u64(LaneKey, 32)
+			);
+		}
+#else
+		for( std::size_t i = 0; i < 8; ++i )
+		{
+			std::uint64_t Lane;
+			std::memcpy(&Lane, Stripe + i * 8, sizeof(Lane));
+			const std::uint64_t LaneKey = Lane ^ Key[i];
+			// Each accumulator also takes the neighboring lane's data
+			Accumulators[i ^ 1] += Lane;
+			// Low 32 bits times the high 32 bits of each 64-bit lane
+			Accumulators[i] += (LaneKey & 0xFFFFFFFF) * (LaneKey >> 32);
+		}
+#endif
+
+		if( ++StripeIndex < StripesPerBlock )
+		{
+			continue;
+		}
+		StripeIndex = 0;
+
+		// Scramble the accumulators at the end of each block
+		const std::uint64_t* ScrambleKey = &Secret[ScrambleKeyOffset];
+#if defined(VULKANATOR_HASH_SSE2)
+		for( std::size_t i = 0; i < 4; ++i )
+		{
+			const __m128i LaneKey = _mm_loadu_si128(
+				reinterpret_cast<const __m128i*>(ScrambleKey + i * 2)
+			);
+			__m128i Mixed = _mm_xor_si128(Acc[i], _mm_srli_epi64(Acc[i], 47));
+			Mixed         = _mm_xor_si128(Mixed, LaneKey);
+			// 64-bit by 32-bit multiply, from two 32x32->64-bit multiplies
+			const __m128i ProductLow = _mm_mul_epu32(Mixed, Prime);
+			const __m128i ProductHigh
+				= _mm_mul_epu32(_mm_srli_epi64(Mixed, 32), Prime);
+			Acc[i] = _mm_add_epi64(ProductLow, _mm_slli_epi64(ProductHigh, 32));
+		}
+#elif defined(VULKANATOR_HASH_NEON)
+		for( std::size_t i = 0; i < 4; ++i )
+		{
+			uint64x2_t Mixed = veorq_u64(Acc[i], vshrq_n_u64(Acc[i], 47));
+			Mixed = veorq_u64(Mixed, vld1q_u64(ScrambleKey + i * 2));
+			// 64-bit by 32-bit multiply, from two 32x32->64-bit multiplies
+			const uint64x2_t ProductHigh
+				= vshlq_n_u64(vmull_u32(vshrn_n_u64(Mixed, 32), Prime), 32);
+			Acc[i] = vmlal_u32(ProductHigh, vmovn_u64(Mixed), Prime);
+		}
+#else
+		for( std::size_t i = 0; i < 8; ++i )
+		{
+			std::uint64_t Mixed = Accumulators[i];
+			Mixed ^= Mixed >> 47;
+			Mixed ^= ScrambleKey[i];
+			Accumulators[i] = Mixed * Prime32_1;
+		}
+#endif
+	}
+
+#if defined(VULKANATOR_HASH_SSE2)
+	for( std::size_t i = 0; i < 4; ++i )
+	{
+		_mm_storeu_si128(
+			reinterpret_cast<__m128i*>(&Accumulators[i * 2]), Acc[i]
+		);
+	}
+#elif defined(VULKANATOR_HASH_NEON)
+	for( std::size_t i = 0; i < 4; ++i )
+	{
+		vst1q_u64(&Accumulators[i * 2], Acc[i]);
+	}
+#endif
+}
+
+// Full 64x64->128-bit multiply, with the upper and lower halves folded
+// together
+std::uint64_t Multiply128Fold64(std::uint64_t A, std::uint64_t B)
+{
+	const std::uint64_t LowLow   = (A & 0xFFFFFFFF) * (B & 0xFFFFFFFF);
+	const std::uint64_t HighLow  = (A >> 32) * (B & 0xFFFFFFFF);
+	const std::uint64_t LowHigh  = (A & 0xFFFFFFFF) * (B >> 32);
+	const std::uint64_t HighHigh = (A >> 32) * (B >> 32);
+
+	const std::uint64_t Cross
+		= (LowLow >> 32) + (HighLow & 0xFFFFFFFF) + LowHigh;
+	const std::uint64_t Upper = (HighLow >> 32) + (Cross >> 32) + HighHigh;
+	const std::uint64_t Lower = (Cross << 32) | (LowLow & 0xFFFFFFFF);
+	return Lower ^ Upper;
+}
+
+std::uint64_t Avalanche(std::uint64_t Hash)
+{
+	Hash ^= Hash >> 37;
+	Hash *= Prime64_3;
+	Hash ^= Hash >> 32;
+	return Hash;
+}
+
+std::uint64_t MergeAccumulators(
+	const std::array<std::uint64_t, 8>& Accumulators,
+	std::size_t KeyOffset, std::uint64_t Start
+)
+{
+	std::uint64_t Result = Start;
+	for( std::size_t i = 0; i < 4; ++i )
+	{
+		Result += Multiply128Fold64(
+			Accumulators[i * 2] ^ Secret[KeyOffset + i * 2],
+			Accumulators[i * 2 + 1] ^ Secret[KeyOffset + i * 2 + 1]
+		);
+	}
+	return Avalanche(Result);
+}
+} // namespace
+
+ContentHasher::ContentHasher()
+	: Accumulators{
+		Prime32_3, Prime64_1, Prime64_2, Prime64_3,
+		Prime64_4, Prime32_2, Prime64_5, Prime32_1,
+	}
+{
+}
+
+void ContentHasher::Update(const void* Data, std::size_t Size)
+{
+	const std::byte* Bytes = static_cast<const std::byte*>(Data);
+	TotalSize += Size;
+
+	// Top off a partially filled stripe first
+	if( BufferSize )
+	{
+		const std::size_t FillSize = std::min(Size, StripeSize - BufferSize);
+		std::memcpy(Buffer.data() + BufferSize, Bytes, FillSize);
+		BufferSize += FillSize;
+		Bytes += FillSize;
+		Size -= FillSize;
+
+		if( BufferSize < StripeSize )
+		{
+			return;
+		}
+
+		AccumulateStripes(Accumulators, Buffer.data(), 1, StripeIndex);
+		BufferSize = 0;
+	}
+
+	// Whole stripes are consumed right out of the data
+	const std::size_t StripeCount = Size / StripeSize;
+	AccumulateStripes(Accumulators, Bytes, StripeCount, StripeIndex);
+	Bytes += StripeCount * StripeSize;
+	Size -= StripeCount * StripeSize;
+
+	// Keep the rest for later
+	std::memcpy(Buffer.data(), Bytes, Size);
+	BufferSize = Size;
+}
+
+Hash128 ContentHasher::Finalize() const
+{
+	std::array<std::uint64_t, 8> FinalAccumulators = Accumulators;
+	std::size_t                  FinalStripeIndex  = StripeIndex;
+
+	// The last partial stripe is padded with zeros. The total size is mixed in
+	// below, so the padding is never confused with actual zeros
+	if( BufferSize )
+	{
+		std::array<std::byte, StripeSize> LastStripe = {};
+		std::memcpy(LastStripe.data(), Buffer.data(), BufferSize);
+		AccumulateStripes(
+			FinalAccumulators, LastStripe.data(), 1, FinalStripeIndex
+		);
+	}
+
+	return Hash128{
+		.Low = MergeAccumulators(FinalAccumulators, 3, TotalSize * Prime64_1),
+		.High
+		= MergeAccumulators(FinalAccumulators, 13, ~(TotalSize * Prime64_2)),
+	};
+}
+
+Hash128 ContentHasher::Hash(const void* Data, std::size_t Size)
+{
+	ContentHasher Hasher;
+	Hasher.Update(Data, Size);
+	return Hasher.Finalize();
+}
+
+} // namespace Vulkanator
@@ -0,0 +1,248 @@
+#include "DescriptorAllocator.hpp"
+
+#include <algorithm>
+#include <functional>
+#include <thread>
+#include <utility>
+
+namespace Vulkanator
+{
+
+// Pools that were reset are kept around for re-use, up to this many per shard
+static constexpr std::size_t MaxFreePools = 2;
+
+DescriptorAllocator::DescriptorSet::~DescriptorSet()
+{
+	Reset();
+}
+
+DescriptorAllocator::DescriptorSet::DescriptorSet(DescriptorSet&& Other
+) noexcept
+	: Allocator(std::exchange(Other.Allocator, nullptr)),
+	  Owner(std::exchange(Other.Owner, nullptr)),
+	  Source(std::exchange(Other.Source, nullptr)),
+	  Set(std::exchange(Other.Set, {}))
+{
+}
+
+DescriptorAllocator::DescriptorSet&
+	DescriptorAllocator::DescriptorSet::operator=(DescriptorSet&& Other
+	) noexcept
+{
+	if( this != &Other )
+	{
+		Reset();
+		Allocator = std::exchange(Other.Allocator, nullptr);
+		Owner     = std::exchange(Other.Owner, nullptr);
+		Source    = std::exchange(Other.Source, nullptr);
+		Set       = std::exchange(Other.Set, {});
+	}
+	return *this;
+}
+
+void DescriptorAllocator::DescriptorSet::Reset()
+{
+	if( Allocator )
+	{
+		Allocator->Free(*this);
+		Allocator = nullptr;
+		Owner     = nullptr;
+		Source    = nullptr;
+		Set       = vk::DescriptorSet();
+	}
+}
+
+DescriptorAllocator::~DescriptorAllocator()
+{
+	Clear();
+}
+
+bool DescriptorAllocator::Initialize(
+	vk::Device                              NewDevice,
+	std::span<const vk::DescriptorPoolSize> NewPoolSizes,
+	std::uint32_t NewSetsPerPool, std::size_t NewShardCount
+)
+{
+	Clear();
+
+	Device      = NewDevice;
+	PoolSizes   = {NewPoolSizes.begin(), NewPoolSizes.end()};
+	SetsPerPool = NewSetsPerPool;
+	ShardCount  = std::max<std::size_t>(NewShardCount, 1);
+	Shards      = std::make_unique<Shard[]>(ShardCount);
+
+	// Create the first pool up-front, so that a device that is not able to
+	// create any pools at all is caught early
+	Shard&                 FirstShard = Shards[0];
+	const std::scoped_lock ShardLock(FirstShard.ShardMutex);
+	return Grow(FirstShard) != nullptr;
+}
+
+DescriptorAllocator::DescriptorSet
+	DescriptorAllocator::Allocate(vk::DescriptorSetLayout Layout)
+{
+	if( !Shards )
+	{
+		return DescriptorSet();
+	}
+
+	Shard&                 CurShard = GetThreadShard();
+	const std::scoped_lock ShardLock(CurShard.ShardMutex);
+
+	Pool* CurPool = CurShard.Pools.empty() ? Grow(CurShard)
+										   : CurShard.Pools.back().get();
+
+	// Tried at most twice. Once within the current pool, and once more within
+	// a new pool if the current one ran out
+	for( std::uint32_t Attempt = 0; CurPool && Attempt < 2; ++Attempt )
+	{
+		const vk::DescriptorSetAllocateInfo AllocInfo = {
+			.descriptorPool     = CurPool->Handle.get(),
+			.descriptorSetCount = 1u,
+			.pSetLayouts        = &Layout,
+		};
+
+		vk::DescriptorSet NewSet = {};
+		switch( Device.allocateDescriptorSets(&AllocInfo, &NewSet) )
+		{
+		case vk::Result::eSuccess:
+		{
+			++CurPool->LiveSets;
+
+			DescriptorSet Result;
+			Result.Allocator = this;
+			Result.Owner     = &CurShard;
+			Result.Source    = CurPool;
+			Result.Set       = NewSet;
+			return Result;
+		}
+		case vk::Result::eErrorOutOfPoolMemory:
+		case vk::Result::eErrorFragmentedPool:
+		{
+			// The current pool is full, move on to a new one
+			CurPool = Grow(CurShard);
+			break;
+		}
+		default:
+		{
+			// Error allocating descriptor set
+			return DescriptorSet();
+		}
+		}
+	}
+
+	// Error allocating descriptor set, even out of a new pool
+	return DescriptorSet();
+}
+
+DescriptorAllocator::Statistics DescriptorAllocator::GetStatistics() const
+{
+	Statistics Result = {};
+	for( std::size_t i = 0; i < ShardCount; ++i )
+	{
+		Shard&                 CurShard = Shards[i];
+		const std::scoped_lock ShardLock(CurShard.ShardMutex);
+
+		Result.Pools += CurShard.Pools.size();
+		Result.FreePools += CurShard.FreePools.size();
+		Result.Grows += CurShard.Grows;
+		for( const std::unique_ptr<Pool>& CurPool : CurShard.Pools )
+		{
+			Result.LiveSets += CurPool->LiveSets;
+		}
+	}
+	return Result;
+}
+
+void DescriptorAllocator::Clear()
+{
+	Shards.reset();
+	ShardCount = 0;
+}
+
+DescriptorAllocator::Pool* DescriptorAllocator::Grow(Shard& CurShard)
+{
+	if( !CurShard.FreePools.empty() )
+	{
+		CurShard.Pools.emplace_back(std::move(CurShard.FreePools.back()));
+		CurShard.FreePools.pop_back();
+		return CurShard.Pools.back().get();
+	}
+
+	const vk::DescriptorPoolCreateInfo DescriptorPoolInfo = {
+		// Render contexts free their descriptor sets individually when they
+		// are destroyed
+		.flags         = vk::DescriptorPoolCreateFlagBits::eFreeDescriptorSet,
+		.maxSets       = SetsPerPool,
+		.poolSizeCount = std::uint32_t(PoolSizes.size()),
+		.pPoolSizes    = PoolSizes.data(),
+	};
+
+	if( auto DescriptorPoolResult
+		= Device.createDescriptorPoolUnique(DescriptorPoolInfo);
+		DescriptorPoolResult.result == vk::Result::eSuccess )
+	{
+		auto NewPool    = std::make_unique<Pool>();
+		NewPool->Handle = std::move(DescriptorPoolResult.value);
+		CurShard.Pools.emplace_back(std::move(NewPool));
+		++CurShard.Grows;
+		return CurShard.Pools.back().get();
+	}
+	else
+	{
+		// Error creating descriptor pool
+		return nullptr;
+	}
+}
+
+void DescriptorAllocator::Free(DescriptorSet& Set)
+{
+	Shard&                 CurShard = *Set.Owner;
+	const std::scoped_lock ShardLock(CurShard.ShardMutex);
+
+	// Freeing descriptor sets and resetting pools always succeeds. Depending
+	// on the version of vulkan-hpp, these return either nothing or a result
+	Pool& CurPool = *Set.Source;
+	static_cast<void>(
+		Device.freeDescriptorSets(CurPool.Handle.get(), 1, &Set.Set)
+	);
+
+	// The current pool is kept, even when it is empty, since the next
+	// allocation will go right back into it
+	if( --CurPool.LiveSets || &CurPool == CurShard.Pools.back().get() )
+	{
+		return;
+	}
+
+	const auto Match = std::find_if(
+		CurShard.Pools.begin(), CurShard.Pools.end(),
+		[&](const std::unique_ptr<Pool>& CurEntry) -> bool {
+			return CurEntry.get() == &CurPool;
+		}
+	);
+	if( Match == CurShard.Pools.end() )
+	{
+		return;
+	}
+
+	std::unique_ptr<Pool> EmptyPool = std::move(*Match);
+	CurShard.Pools.erase(Match);
+
+	// Resetting the pool undoes any fragmentation that it had built up
+	if( CurShard.FreePools.size() < MaxFreePools )
+	{
+		static_cast<void>(
+			Device.resetDescriptorPool(EmptyPool->Handle.get())
+		);
+		CurShard.FreePools.emplace_back(std::move(EmptyPool));
+	}
+}
+
+DescriptorAllocator::Shard& DescriptorAllocator::GetThreadShard()
+{
+	const std::size_t ThreadHash
+		= std::hash<std::thread::id>()(std::this_thread::get_id());
+	return Shards[ThreadHash % ShardCount];
+}
+
+} // namespace Vulkanator
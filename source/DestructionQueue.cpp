@@ -0,0 +1,181 @@
+#include "DestructionQueue.hpp"
+
+#include <vector>
+
+namespace Vulkanator
+{
+
+DestructionQueue::~DestructionQueue()
+{
+	Stop();
+}
+
+void DestructionQueue::Start(const SubmissionService& NewSubmitter)
+{
+	Stop();
+
+	Submitter     = &NewSubmitter;
+	QueueStop     = false;
+	DestroyThread = std::thread(&DestructionQueue::ThreadMain, this);
+}
+
+void DestructionQueue::Stop()
+{
+	if( DestroyThread.joinable() )
+	{
+		{
+			const std::scoped_lock QueueLock(QueueMutex);
+			QueueStop = true;
+		}
+		QueueCondition.notify_one();
+		DestroyThread.join();
+	}
+
+	// Anything that is still pending is destroyed once the GPU is done with
+	// it. A hung device is not waited on forever though
+	std::deque<Entry> Remaining;
+	{
+		const std::scoped_lock QueueLock(QueueMutex);
+		Remaining.swap(Entries);
+	}
+	if( !Remaining.empty() && Submitter )
+	{
+		static_cast<void>(Submitter->WaitFor(
+			Remaining.back().Point, SubmissionService::HangTimeout
+		));
+	}
+	for( Entry& CurEntry : Remaining )
+	{
+		Destroy(std::move(CurEntry.Object));
+	}
+
+	Submitter = nullptr;
+}
+
+bool DestructionQueue::Flush()
+{
+	std::vector<std::unique_ptr<RetiredBase>> Ready;
+	{
+		const std::scoped_lock QueueLock(QueueMutex);
+		while( !Entries.empty() && Submitter
+			   && Submitter->HasReached(Entries.front().Point) )
+		{
+			Ready.emplace_back(std::move(Entries.front().Object));
+			Entries.pop_front();
+		}
+	}
+
+	for( std::unique_ptr<RetiredBase>& CurObject : Ready )
+	{
+		Destroy(std::move(CurObject));
+	}
+	return !Ready.empty();
+}
+
+DestructionQueue::Statistics DestructionQueue::GetStatistics() const
+{
+	const std::uint64_t CurDestroyed = Destroyed.load();
+	const std::uint64_t CurRetired   = Retired.load();
+	return Statistics{
+		.Retired   = CurRetired,
+		.Destroyed = CurDestroyed,
+		.Pending
+		= CurRetired > CurDestroyed ? CurRetired - CurDestroyed : 0,
+		.DestroyTime = std::chrono::nanoseconds(DestroyTime.load()),
+	};
+}
+
+void DestructionQueue::Push(std::unique_ptr<RetiredBase> Object)
+{
+	++Retired;
+
+	{
+		std::unique_lock QueueLock(QueueMutex);
+		if( DestroyThread.joinable() && !QueueStop )
+		{
+			// Everything that was submitted so far may still be using the
+			// object, since it was retired after it was submitted
+			Entries.emplace_back(Entry{
+				.Point  = Submitter->GetCheckpoint(),
+				.Object = std::move(Object),
+			});
+			QueueLock.unlock();
+			QueueCondition.notify_one();
+			return;
+		}
+	}
+
+	// Without a destruction thread, the object is destroyed right away
+	Destroy(std::move(Object));
+}
+
+void DestructionQueue::Destroy(std::unique_ptr<RetiredBase> Object)
+{
+	const auto DestroyStart = std::chrono::steady_clock::now();
+	Object.reset();
+	const auto Elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(
+		std::chrono::steady_clock::now() - DestroyStart
+	);
+
+	DestroyTime += Elapsed.count();
+	++Destroyed;
+}
+
+void DestructionQueue::ThreadMain()
+{
+	std::unique_lock QueueLock(QueueMutex);
+	while( true )
+	{
+		QueueCondition.wait(QueueLock, [this]() {
+			return QueueStop || !Entries.empty();
+		});
+		if( QueueStop )
+		{
+			// Stop destroys whatever is still pending
+			return;
+		}
+
+		// Entries are retired in order, so once the oldest entry's checkpoint
+		// is reached, the ones after it are likely to follow soon
+		const SubmissionService::Checkpoint Point = Entries.front().Point;
+		QueueLock.unlock();
+		const vk::Result WaitResult
+			= Submitter->WaitFor(Point, SubmissionService::WaitSlice);
+		QueueLock.lock();
+
+		if( WaitResult == vk::Result::eTimeout )
+		{
+			// Keep waiting, unless stopping
+			continue;
+		}
+		else if( WaitResult != vk::Result::eSuccess )
+		{
+			// Error waiting on the timelines, such as a lost device. Try
+			// again later rather than spinning on the error
+			static_cast<void>(QueueCondition.wait_for(
+				QueueLock, SubmissionService::WaitSlice,
+				[this]() { return QueueStop; }
+			));
+			continue;
+		}
+
+		// Destroy everything that the GPU is done with, without holding the
+		// lock so that render threads may keep retiring objects meanwhile
+		std::vector<std::unique_ptr<RetiredBase>> Ready;
+		while( !Entries.empty()
+			   && Submitter->HasReached(Entries.front().Point) )
+		{
+			Ready.emplace_back(std::move(Entries.front().Object));
+			Entries.pop_front();
+		}
+
+		QueueLock.unlock();
+		for( std::unique_ptr<RetiredBase>& CurObject : Ready )
+		{
+			Destroy(std::move(CurObject));
+		}
+		QueueLock.lock();
+	}
+}
+
+} // namespace Vulkanator
@@ -0,0 +1,484 @@
+#include "MemoryAllocator.hpp"
+#include "VulkanUtils.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <set>
+#include <utility>
+
+namespace VulkanUtils
+{
+
+// Smallest range that is carved out of a block, as a power of two
+static constexpr std::uint32_t MinRangeOrder = 8; // 256 bytes
+
+// Blocks take up an eighth of their heap, within these limits
+static constexpr std::uint32_t MinBlockOrder = 20; //  1 MiB
+static constexpr std::uint32_t MaxBlockOrder = 26; // 64 MiB
+
+struct MemoryBlock
+{
+	vk::UniqueDeviceMemory Memory  = {};
+	std::byte*             Mapping = nullptr;
+
+	// The pool that the block belongs to
+	std::size_t PoolIndex = 0;
+
+	// Size of the block, as a power of two
+	std::uint32_t Order = 0;
+
+	// Ranges that are currently carved out of the block, and their size
+	std::size_t    Ranges = 0;
+	vk::DeviceSize Used   = 0;
+
+	// Offsets of the free ranges of each order
+	// Every range is aligned to its own size, so the "buddy" that a range was
+	// split from is always at the offset with the range's size-bit flipped
+	std::array<std::set<vk::DeviceSize>, 64> FreeRanges = {};
+
+	std::optional<vk::DeviceSize> Allocate(std::uint32_t RangeOrder)
+	{
+		// Take the smallest free range that fits
+		std::uint32_t CurOrder = RangeOrder;
+		while( CurOrder <= Order && FreeRanges[CurOrder].empty() )
+		{
+			++CurOrder;
+		}
+
+		if( CurOrder > Order )
+		{
+			return std::nullopt;
+		}
+
+		const vk::DeviceSize Offset = *FreeRanges[CurOrder].begin();
+		FreeRanges[CurOrder].erase(FreeRanges[CurOrder].begin());
+
+		// Split it in halves until it is just large enough, keeping the upper
+		// halves free
+		while( CurOrder > RangeOrder )
+		{
+			--CurOrder;
+			FreeRanges[CurOrder].insert(
+				Offset + (vk::DeviceSize(1) << CurOrder)
+			);
+		}
+
+		++Ranges;
+		Used += vk::DeviceSize(1) << RangeOrder;
+		return Offset;
+	}
+
+	void Free(vk::DeviceSize Offset, std::uint32_t RangeOrder)
+	{
+		--Ranges;
+		Used -= vk::DeviceSize(1) << RangeOrder;
+
+		// Merge the range with its buddy for as long as the buddy is free too
+		while( RangeOrder < Order )
+		{
+			const vk::DeviceSize Buddy
+				= Offset ^ (vk::DeviceSize(1) << RangeOrder);
+			if( FreeRanges[RangeOrder].erase(Buddy) == 0 )
+			{
+				break;
+			}
+			Offset = std::min(Offset, Buddy);
+			++RangeOrder;
+		}
+
+		FreeRanges[RangeOrder].insert(Offset);
+	}
+};
+
+MemoryAllocation::~MemoryAllocation()
+{
+	Reset();
+}
+
+MemoryAllocation::MemoryAllocation(MemoryAllocation&& Other) noexcept
+	: Allocator(std::exchange(Other.Allocator, nullptr)),
+	  Block(std::exchange(Other.Block, nullptr)),
+	  Memory(std::exchange(Other.Memory, {})),
+	  Offset(std::exchange(Other.Offset, 0)),
+	  Size(std::exchange(Other.Size, 0)),
+	  Mapping(std::exchange(Other.Mapping, nullptr)),
+	  Order(std::exchange(Other.Order, 0)),
+	  MemoryTypeIndex(std::exchange(Other.MemoryTypeIndex, 0))
+{
+}
+
+MemoryAllocation& MemoryAllocation::operator=(MemoryAllocation&& Other) noexcept
+{
+	if( this != &Other )
+	{
+		Reset();
+		Allocator = std::exchange(Other.Allocator, nullptr);
+		Block     = std::exchange(Other.Block, nullptr);
+		Memory    = std::exchange(Other.Memory, {});
+		Offset    = std::exchange(Other.Offset, 0);
+		Size      = std::exchange(Other.Size, 0);
+		Mapping   = std::exchange(Other.Mapping, nullptr);
+		Order     = std::exchange(Other.Order, 0);
+
+		MemoryTypeIndex = std::exchange(Other.MemoryTypeIndex, 0);
+	}
+	return *this;
+}
+
+void MemoryAllocation::Reset()
+{
+	if( Allocator && Memory )
+	{
+		Allocator->Free(*this);
+	}
+
+	Allocator = nullptr;
+	Block     = nullptr;
+	Memory    = vk::DeviceMemory();
+	Offset    = 0;
+	Size      = 0;
+	Mapping   = nullptr;
+	Order     = 0;
+
+	MemoryTypeIndex = 0;
+}
+
+MemoryAllocator::MemoryAllocator() = default;
+
+MemoryAllocator::~MemoryAllocator() = default;
+
+void MemoryAllocator::Initialize(
+	vk::Device NewDevice, vk::PhysicalDevice NewPhysicalDevice
+)
+{
+	const std::scoped_lock AllocatorLock(AllocatorMutex);
+
+	Device           = NewDevice;
+	PhysicalDevice   = NewPhysicalDevice;
+	MemoryProperties = PhysicalDevice.getMemoryProperties();
+
+	HeapBlockOrders.resize(MemoryProperties.memoryHeapCount);
+	HeapUsage.assign(MemoryProperties.memoryHeapCount, 0);
+	for( std::uint32_t i = 0; i < MemoryProperties.memoryHeapCount; ++i )
+	{
+		const std::uint32_t HeapOrder = std::uint32_t(
+			std::bit_width(MemoryProperties.memoryHeaps[i].size)
+		);
+		HeapBlockOrders[i] = std::clamp<std::uint32_t>(
+			HeapOrder > 3 ? HeapOrder - 4 : 0, MinBlockOrder, MaxBlockOrder
+		);
+	}
+}
+
+std::optional<MemoryAllocation> MemoryAllocator::AllocateForBuffer(
+	vk::Buffer Buffer, vk::MemoryPropertyFlags Properties,
+	vk::MemoryPropertyFlags ExcludeProperties
+)
+{
+	const auto Requirements = Device.getBufferMemoryRequirements2<
+		vk::MemoryRequirements2, vk::MemoryDedicatedRequirements>(
+		vk::BufferMemoryRequirementsInfo2{.buffer = Buffer}
+	);
+	const vk::MemoryDedicatedRequirements& DedicatedRequirements
+		= Requirements.get<vk::MemoryDedicatedRequirements>();
+
+	return Allocate(
+		Requirements.get<vk::MemoryRequirements2>().memoryRequirements,
+		DedicatedRequirements.prefersDedicatedAllocation
+			|| DedicatedRequirements.requiresDedicatedAllocation,
+		true, Buffer, vk::Image(), Properties, ExcludeProperties
+	);
+}
+
+std::optional<MemoryAllocation> MemoryAllocator::AllocateForImage(
+	vk::Image Image, vk::ImageTiling Tiling, vk::MemoryPropertyFlags Properties,
+	vk::MemoryPropertyFlags ExcludeProperties
+)
+{
+	const auto Requirements = Device.getImageMemoryRequirements2<
+		vk::MemoryRequirements2, vk::MemoryDedicatedRequirements>(
+		vk::ImageMemoryRequirementsInfo2{.image = Image}
+	);
+	const vk::MemoryDedicatedRequirements& DedicatedRequirements
+		= Requirements.get<vk::MemoryDedicatedRequirements>();
+
+	return Allocate(
+		Requirements.get<vk::MemoryRequirements2>().memoryRequirements,
+		DedicatedRequirements.prefersDedicatedAllocation
+			|| DedicatedRequirements.requiresDedicatedAllocation,
+		Tiling != vk::ImageTiling::eOptimal, vk::Buffer(), Image, Properties,
+		ExcludeProperties
+	);
+}
+
+MemoryAllocator::Statistics MemoryAllocator::GetStatistics() const
+{
+	const std::scoped_lock AllocatorLock(AllocatorMutex);
+
+	Statistics Result = {
+		.Dedicated     = DedicatedCount,
+		.DedicatedSize = DedicatedSize,
+	};
+	for( const Pool& CurPool : Pools )
+	{
+		for( const std::unique_ptr<MemoryBlock>& CurBlock : CurPool.Blocks )
+		{
+			++Result.Blocks;
+			Result.BlockSize += vk::DeviceSize(1) << CurBlock->Order;
+			Result.Allocations += CurBlock->Ranges;
+			Result.AllocationSize += CurBlock->Used;
+		}
+	}
+	return Result;
+}
+
+vk::DeviceSize MemoryAllocator::GetHeapUsage(std::uint32_t HeapIndex) const
+{
+	const std::scoped_lock AllocatorLock(AllocatorMutex);
+	return HeapIndex < HeapUsage.size() ? HeapUsage[HeapIndex] : 0;
+}
+
+std::optional<MemoryAllocation> MemoryAllocator::Allocate(
+	const vk::MemoryRequirements& Requirements, bool PrefersDedicated,
+	bool Linear, vk::Buffer DedicatedBuffer, vk::Image DedicatedImage,
+	vk::MemoryPropertyFlags Properties,
+	vk::MemoryPropertyFlags ExcludeProperties
+)
+{
+	const std::int32_t MemoryTypeIndex = FindMemoryTypeIndex(
+		PhysicalDevice, Requirements.memoryTypeBits, Properties,
+		ExcludeProperties
+	);
+
+	if( MemoryTypeIndex < 0 )
+	{
+		// Unable to find suitable memory type
+		return std::nullopt;
+	}
+
+	if( PrefersDedicated )
+	{
+		return AllocateDedicated(
+			Requirements.size, std::uint32_t(MemoryTypeIndex), DedicatedBuffer,
+			DedicatedImage
+		);
+	}
+
+	const std::uint32_t HeapIndex
+		= MemoryProperties.memoryTypes[MemoryTypeIndex].heapIndex;
+	const std::uint32_t BlockOrder = HeapBlockOrders.at(HeapIndex);
+
+	// Every range is aligned to its own size, which covers the required
+	// alignment as well
+	const vk::DeviceSize RangeSize
+		= std::max(Requirements.size, Requirements.alignment);
+	const std::uint32_t RangeOrder = std::max(
+		MinRangeOrder, std::uint32_t(std::bit_width(RangeSize - 1))
+	);
+
+	// Resources that would take up more than half of a block are better off
+	// with an allocation of their own
+	if( RangeOrder >= BlockOrder )
+	{
+		return AllocateDedicated(
+			Requirements.size, std::uint32_t(MemoryTypeIndex), vk::Buffer(),
+			vk::Image()
+		);
+	}
+
+	const std::scoped_lock AllocatorLock(AllocatorMutex);
+
+	auto CurPool = std::find_if(
+		Pools.begin(), Pools.end(),
+		[&](const Pool& Candidate) -> bool {
+			return Candidate.MemoryTypeIndex == std::uint32_t(MemoryTypeIndex)
+				&& Candidate.Linear == Linear;
+		}
+	);
+	if( CurPool == Pools.end() )
+	{
+		CurPool = Pools.insert(
+			Pools.end(), Pool{
+							 .MemoryTypeIndex = std::uint32_t(MemoryTypeIndex),
+							 .Linear          = Linear,
+						 }
+		);
+	}
+
+	const auto MakeAllocation
+		= [&](MemoryBlock& Block, vk::DeviceSize Offset) -> MemoryAllocation {
+		MemoryAllocation Result;
+		Result.Allocator = this;
+		Result.Block     = &Block;
+		Result.Memory    = Block.Memory.get();
+		Result.Offset    = Offset;
+		Result.Size      = Requirements.size;
+		Result.Mapping   = Block.Mapping ? Block.Mapping + Offset : nullptr;
+		Result.Order     = RangeOrder;
+
+		Result.MemoryTypeIndex = std::uint32_t(MemoryTypeIndex);
+		return Result;
+	};
+
+	for( const std::unique_ptr<MemoryBlock>& CurBlock : CurPool->Blocks )
+	{
+		if( const std::optional<vk::DeviceSize> Offset
+			= CurBlock->Allocate(RangeOrder);
+			Offset )
+		{
+			return MakeAllocation(*CurBlock, *Offset);
+		}
+	}
+
+	// Every block is full, allocate another one
+	auto NewBlock       = std::make_unique<MemoryBlock>();
+	NewBlock->PoolIndex = std::size_t(CurPool - Pools.begin());
+	NewBlock->Order     = BlockOrder;
+
+	if( auto NewDeviceMemory = AllocateDeviceMemory(
+			Device, vk::DeviceSize(1) << BlockOrder,
+			std::uint32_t(MemoryTypeIndex)
+		);
+		NewDeviceMemory.has_value() )
+	{
+		NewBlock->Memory = std::move(NewDeviceMemory.value());
+	}
+	else
+	{
+		// Error allocating device memory
+		return std::nullopt;
+	}
+
+	if( const std::optional<std::byte*> Mapping = MapIfHostVisible(
+			NewBlock->Memory.get(), std::uint32_t(MemoryTypeIndex)
+		);
+		Mapping.has_value() )
+	{
+		NewBlock->Mapping = Mapping.value();
+	}
+	else
+	{
+		// Error mapping device memory
+		return std::nullopt;
+	}
+
+	HeapUsage[HeapIndex] += vk::DeviceSize(1) << BlockOrder;
+
+	NewBlock->FreeRanges[BlockOrder].insert(0);
+	const vk::DeviceSize Offset = NewBlock->Allocate(RangeOrder).value();
+
+	CurPool->Blocks.push_back(std::move(NewBlock));
+	return MakeAllocation(*CurPool->Blocks.back(), Offset);
+}
+
+std::optional<MemoryAllocation> MemoryAllocator::AllocateDedicated(
+	vk::DeviceSize Size, std::uint32_t MemoryTypeIndex,
+	vk::Buffer DedicatedBuffer, vk::Image DedicatedImage
+)
+{
+	vk::UniqueDeviceMemory NewDeviceMemory = {};
+	if( auto AllocResult = AllocateDeviceMemory(
+			Device, Size, MemoryTypeIndex, DedicatedBuffer, DedicatedImage
+		);
+		AllocResult.has_value() )
+	{
+		NewDeviceMemory = std::move(AllocResult.value());
+	}
+	else
+	{
+		// Error allocating device memory
+		return std::nullopt;
+	}
+
+	MemoryAllocation Result;
+	if( const std::optional<std::byte*> Mapping
+		= MapIfHostVisible(NewDeviceMemory.get(), MemoryTypeIndex);
+		Mapping.has_value() )
+	{
+		Result.Mapping = Mapping.value();
+	}
+	else
+	{
+		// Error mapping device memory
+		return std::nullopt;
+	}
+
+	Result.Allocator       = this;
+	Result.Memory          = NewDeviceMemory.release();
+	Result.Size            = Size;
+	Result.MemoryTypeIndex = MemoryTypeIndex;
+
+	const std::scoped_lock AllocatorLock(AllocatorMutex);
+	++DedicatedCount;
+	DedicatedSize += Size;
+	HeapUsage[MemoryProperties.memoryTypes[MemoryTypeIndex].heapIndex] += Size;
+
+	return Result;
+}
+
+std::optional<std::byte*> MemoryAllocator::MapIfHostVisible(
+	vk::DeviceMemory Memory, std::uint32_t MemoryTypeIndex
+) const
+{
+	if( !(MemoryProperties.memoryTypes[MemoryTypeIndex].propertyFlags
+		  & vk::MemoryPropertyFlagBits::eHostVisible) )
+	{
+		return nullptr;
+	}
+
+	if( auto MapResult = Device.mapMemory(Memory, 0, VK_WHOLE_SIZE);
+		MapResult.result == vk::Result::eSuccess )
+	{
+		return static_cast<std::byte*>(MapResult.value);
+	}
+
+	return std::nullopt;
+}
+
+void MemoryAllocator::Free(MemoryAllocation& Allocation)
+{
+	const std::scoped_lock AllocatorLock(AllocatorMutex);
+
+	const std::uint32_t HeapIndex
+		= MemoryProperties.memoryTypes[Allocation.MemoryTypeIndex].heapIndex;
+
+	if( !Allocation.Block )
+	{
+		// Freeing the memory unmaps it implicitly
+		Device.freeMemory(Allocation.Memory);
+		--DedicatedCount;
+		DedicatedSize -= Allocation.Size;
+		HeapUsage[HeapIndex] -= Allocation.Size;
+		return;
+	}
+
+	MemoryBlock& Block = *Allocation.Block;
+	Block.Free(Allocation.Offset, Allocation.Order);
+	if( Block.Ranges )
+	{
+		return;
+	}
+
+	// One empty block of each pool is kept around for the next allocation,
+	// rather than going back and forth with the driver
+	std::vector<std::unique_ptr<MemoryBlock>>& Blocks
+		= Pools[Block.PoolIndex].Blocks;
+	const bool OtherEmptyBlock = std::any_of(
+		Blocks.begin(), Blocks.end(),
+		[&](const std::unique_ptr<MemoryBlock>& CurBlock) -> bool {
+			return CurBlock.get() != &Block && CurBlock->Ranges == 0;
+		}
+	);
+	if( OtherEmptyBlock )
+	{
+		HeapUsage[HeapIndex] -= vk::DeviceSize(1) << Block.Order;
+		std::erase_if(
+			Blocks, [&](const std::unique_ptr<MemoryBlock>& CurBlock) -> bool {
+				return CurBlock.get() == &Block;
+			}
+		);
+	}
+}
+
+} // namespace VulkanUtils
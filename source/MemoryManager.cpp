@@ -0,0 +1,209 @@
+#include "MemoryManager.hpp"
+#include "Vulkanator.hpp"
+
+#include <algorithm>
+
+namespace Vulkanator
+{
+
+// Caches are freed once the usage goes beyond this portion of the budget,
+// leaving some room for After Effects and the driver themselves
+static constexpr double PressureThreshold = 0.9;
+
+// The reclaimer checks for idle sequences this many times within each timeout,
+// but never more often than once a second
+static constexpr std::uint32_t ReclaimerChecksPerTimeout = 4;
+
+MemoryManager::~MemoryManager()
+{
+	StopReclaimer();
+}
+
+void MemoryManager::Initialize(
+	vk::PhysicalDevice                  NewPhysicalDevice,
+	const VulkanUtils::MemoryAllocator& NewAllocator, bool NewMemoryBudget
+)
+{
+	PhysicalDevice = NewPhysicalDevice;
+	Allocator      = &NewAllocator;
+	MemoryBudget   = NewMemoryBudget;
+
+	const vk::PhysicalDeviceMemoryProperties MemoryProperties
+		= PhysicalDevice.getMemoryProperties();
+	for( std::uint32_t i = 0; i < MemoryProperties.memoryHeapCount; ++i )
+	{
+		const vk::MemoryHeap& CurHeap = MemoryProperties.memoryHeaps[i];
+		if( (CurHeap.flags & vk::MemoryHeapFlagBits::eDeviceLocal)
+			&& CurHeap.size > HeapSize )
+		{
+			HeapIndex = i;
+			HeapSize  = CurHeap.size;
+		}
+	}
+}
+
+void MemoryManager::Register(const std::shared_ptr<RenderContextPool>& Pool)
+{
+	const std::scoped_lock ManagerLock(ManagerMutex);
+	std::erase_if(Pools, [](const std::weak_ptr<RenderContextPool>& CurPool) {
+		return CurPool.expired();
+	});
+	Pools.emplace_back(Pool);
+}
+
+void MemoryManager::Touch(RenderContextPool& Pool)
+{
+	Pool.LastRender     = ++RenderTick;
+	Pool.LastRenderTime = std::chrono::steady_clock::now();
+}
+
+MemoryManager::Usage MemoryManager::GetUsage() const
+{
+	if( MemoryBudget )
+	{
+		const auto MemoryProperties = PhysicalDevice.getMemoryProperties2<
+			vk::PhysicalDeviceMemoryProperties2,
+			vk::PhysicalDeviceMemoryBudgetPropertiesEXT>();
+		const vk::PhysicalDeviceMemoryBudgetPropertiesEXT& HeapBudgets
+			= MemoryProperties
+				  .get<vk::PhysicalDeviceMemoryBudgetPropertiesEXT>();
+
+		return Usage{
+			.Used   = HeapBudgets.heapUsage[HeapIndex],
+			.Budget = HeapBudgets.heapBudget[HeapIndex],
+		};
+	}
+
+	return Usage{
+		.Used   = Allocator ? Allocator->GetHeapUsage(HeapIndex) : 0,
+		.Budget = HeapSize,
+	};
+}
+
+bool MemoryManager::IsUnderPressure() const
+{
+	const Usage CurUsage = GetUsage();
+	return double(CurUsage.Used) > double(CurUsage.Budget) * PressureThreshold;
+}
+
+bool MemoryManager::EvictOne()
+{
+	std::shared_ptr<RenderContextPool> Oldest = {};
+	{
+		const std::scoped_lock ManagerLock(ManagerMutex);
+		std::erase_if(
+			Pools, [](const std::weak_ptr<RenderContextPool>& CurPool) {
+				return CurPool.expired();
+			}
+		);
+
+		for( const std::weak_ptr<RenderContextPool>& CurPool : Pools )
+		{
+			std::shared_ptr<RenderContextPool> Pool = CurPool.lock();
+			if( Pool && Pool->Footprint
+				&& (!Oldest || Pool->LastRender < Oldest->LastRender) )
+			{
+				Oldest = std::move(Pool);
+			}
+		}
+	}
+
+	if( !Oldest )
+	{
+		return false;
+	}
+
+	// The pool is evicted without holding the lock, since render threads may
+	// be waiting on the pool's own lock at the same time
+	Oldest->EvictCaches();
+	++Evictions;
+	return true;
+}
+
+std::vector<MemoryManager::SequenceFootprint>
+	MemoryManager::GetFootprints() const
+{
+	const std::scoped_lock ManagerLock(ManagerMutex);
+
+	std::vector<SequenceFootprint> Result;
+	for( const std::weak_ptr<RenderContextPool>& CurPool : Pools )
+	{
+		if( const std::shared_ptr<RenderContextPool> Pool = CurPool.lock();
+			Pool )
+		{
+			Result.push_back(SequenceFootprint{
+				.LastRender = Pool->LastRender,
+				.Size       = Pool->Footprint,
+			});
+		}
+	}
+	return Result;
+}
+
+void MemoryManager::StartReclaimer(std::chrono::seconds IdleTimeout)
+{
+	StopReclaimer();
+
+	ReclaimerStop   = false;
+	ReclaimerThread = std::thread(
+		&MemoryManager::ReclaimerThreadMain, this, IdleTimeout
+	);
+}
+
+void MemoryManager::StopReclaimer()
+{
+	if( ReclaimerThread.joinable() )
+	{
+		{
+			const std::scoped_lock ReclaimerLock(ReclaimerMutex);
+			ReclaimerStop = true;
+		}
+		ReclaimerCondition.notify_one();
+		ReclaimerThread.join();
+	}
+}
+
+vk::DeviceSize
+	MemoryManager::ReclaimIdle(std::chrono::steady_clock::time_point IdleSince)
+{
+	std::vector<std::shared_ptr<RenderContextPool>> IdlePools;
+	{
+		const std::scoped_lock ManagerLock(ManagerMutex);
+		for( const std::weak_ptr<RenderContextPool>& CurPool : Pools )
+		{
+			std::shared_ptr<RenderContextPool> Pool = CurPool.lock();
+			if( Pool && Pool->Footprint && Pool->LastRenderTime < IdleSince )
+			{
+				IdlePools.emplace_back(std::move(Pool));
+			}
+		}
+	}
+
+	// Same as EvictOne, the pools are evicted without holding the lock
+	vk::DeviceSize Freed = 0;
+	for( const std::shared_ptr<RenderContextPool>& CurPool : IdlePools )
+	{
+		Freed += CurPool->EvictCaches();
+	}
+	Reclaimed += Freed;
+	return Freed;
+}
+
+void MemoryManager::ReclaimerThreadMain(std::chrono::seconds IdleTimeout)
+{
+	const std::chrono::seconds CheckInterval = std::max<std::chrono::seconds>(
+		IdleTimeout / ReclaimerChecksPerTimeout, std::chrono::seconds(1)
+	);
+
+	std::unique_lock ReclaimerLock(ReclaimerMutex);
+	while( !ReclaimerCondition.wait_for(
+		ReclaimerLock, CheckInterval, [this]() { return ReclaimerStop; }
+	) )
+	{
+		ReclaimerLock.unlock();
+		ReclaimIdle(std::chrono::steady_clock::now() - IdleTimeout);
+		ReclaimerLock.lock();
+	}
+}
+
+} // namespace Vulkanator
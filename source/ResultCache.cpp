@@ -0,0 +1,535 @@
+#include "ResultCache.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <optional>
+#include <random>
+#include <span>
+#include <string>
+#include <system_error>
+#include <type_traits>
+
+#if defined(_WIN32)
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+#include <io.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+// Every file begins with this header, followed by the rows of the frame
+// packed tightly together
+struct FileHeader
+{
+	std::array<char, 8> Magic     = {};
+	std::uint32_t       Version   = 0;
+	std::uint32_t       Width     = 0;
+	std::uint32_t       Height    = 0;
+	std::uint32_t       PixelSize = 0;
+	Vulkanator::Hash128 Key       = {};
+	std::uint64_t       DataSize  = 0;
+	std::uint64_t       Reserved  = 0;
+};
+static_assert(std::is_trivially_copyable_v<FileHeader>);
+static_assert(sizeof(FileHeader) == 56);
+
+static constexpr std::array<char, 8> FileMagic
+	= {'V', 'K', 'R', 'E', 'S', 'U', 'L', 'T'};
+static constexpr std::uint32_t FileVersion = 1;
+
+// The pixels begin at a nicely aligned offset within the mapping
+static constexpr std::size_t FileDataOffset = 64;
+
+static constexpr const char* FileExtension = ".vkresult";
+static constexpr const char* TempExtension = ".tmp";
+
+// Temporary files that are older than this were left behind by a crash
+static constexpr std::chrono::hours StaleTempAge = std::chrono::hours(1);
+
+// A read-only mapping of an entire file
+class MappedFile
+{
+public:
+	MappedFile() = default;
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	~MappedFile()
+	{
+#if defined(_WIN32)
+		if( View )
+		{
+			UnmapViewOfFile(View);
+		}
+#else
+		if( View )
+		{
+			munmap(View, Size);
+		}
+#endif
+	}
+
+	bool Open(const std::filesystem::path& Path)
+	{
+#if defined(_WIN32)
+		const HANDLE File = CreateFileW(
+			Path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE,
+			nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr
+		);
+		if( File == INVALID_HANDLE_VALUE )
+		{
+			return false;
+		}
+
+		LARGE_INTEGER FileSize = {};
+		HANDLE        Mapping  = nullptr;
+		if( GetFileSizeEx(File, &FileSize) && FileSize.QuadPart > 0 )
+		{
+			Mapping = CreateFileMappingW(
+				File, nullptr, PAGE_READONLY, 0, 0, nullptr
+			);
+		}
+		CloseHandle(File);
+		if( !Mapping )
+		{
+			return false;
+		}
+
+		// The view keeps the mapping alive on its own
+		View = MapViewOfFile(Mapping, FILE_MAP_READ, 0, 0, 0);
+		CloseHandle(Mapping);
+		Size = std::size_t(FileSize.QuadPart);
+#else
+		const int File = open(Path.c_str(), O_RDONLY);
+		if( File < 0 )
+		{
+			return false;
+		}
+
+		struct stat FileStat = {};
+		if( fstat(File, &FileStat) == 0 && FileStat.st_size > 0 )
+		{
+			Size = std::size_t(FileStat.st_size);
+			View = mmap(nullptr, Size, PROT_READ, MAP_PRIVATE, File, 0);
+			if( View == MAP_FAILED )
+			{
+				View = nullptr;
+			}
+		}
+		// The mapping keeps the file alive on its own
+		close(File);
+#endif
+		return View != nullptr;
+	}
+
+	std::span<const std::byte> Data() const
+	{
+		return {static_cast<const std::byte*>(View), Size};
+	}
+
+private:
+	void*       View = nullptr;
+	std::size_t Size = 0;
+};
+
+std::string KeyToString(const Vulkanator::Hash128& Key)
+{
+	static constexpr char Digits[] = "0123456789abcdef";
+	std::string           Result(32, '0');
+	for( std::size_t i = 0; i < 16; ++i )
+	{
+		Result[15 - i] = Digits[(Key.High >> (i * 4)) & 0xF];
+		Result[31 - i] = Digits[(Key.Low >> (i * 4)) & 0xF];
+	}
+	return Result;
+}
+
+std::optional<Vulkanator::Hash128> StringToKey(const std::string& String)
+{
+	if( String.size() != 32 )
+	{
+		return std::nullopt;
+	}
+
+	Vulkanator::Hash128 Result = {};
+	for( std::size_t i = 0; i < 32; ++i )
+	{
+		const char    CurChar = String[i];
+		std::uint64_t Digit   = 0;
+		if( CurChar >= '0' && CurChar <= '9' )
+		{
+			Digit = std::uint64_t(CurChar - '0');
+		}
+		else if( CurChar >= 'a' && CurChar <= 'f' )
+		{
+			Digit = std::uint64_t(CurChar - 'a' + 10);
+		}
+		else
+		{
+			return std::nullopt;
+		}
+
+		std::uint64_t& Half = i < 16 ? Result.High : Result.Low;
+		Half                = (Half << 4) | Digit;
+	}
+	return Result;
+}
+
+// Makes sure that everything written into `File` has reached the disk
+bool FlushFile(std::FILE* File)
+{
+	if( std::fflush(File) != 0 )
+	{
+		return false;
+	}
+#if defined(_WIN32)
+	return _commit(_fileno(File)) == 0;
+#else
+	return fsync(fileno(File)) == 0;
+#endif
+}
+
+std::FILE* OpenFileForWriting(const std::filesystem::path& Path)
+{
+#if defined(_WIN32)
+	return _wfopen(Path.c_str(), L"wb");
+#else
+	return std::fopen(Path.c_str(), "wb");
+#endif
+}
+
+// Temporary files get a name that no other thread, or process sharing the
+// same directory, will be using at the same time
+std::string UniqueTempSuffix()
+{
+	static const std::uint64_t ProcessToken = []() -> std::uint64_t {
+		std::random_device Device;
+		return (std::uint64_t(Device()) << 32) | Device();
+	}();
+	static std::atomic<std::uint64_t> Counter = 0;
+
+	return "." + std::to_string(ProcessToken) + "."
+		 + std::to_string(Counter.fetch_add(1, std::memory_order_relaxed));
+}
+
+} // namespace
+
+namespace Vulkanator
+{
+
+bool ResultCache::Open(
+	const std::filesystem::path& NewDirectory, std::uint64_t NewCapacity
+)
+{
+	std::error_code Error;
+	std::filesystem::create_directories(NewDirectory, Error);
+	if( !std::filesystem::is_directory(NewDirectory, Error) )
+	{
+		return false;
+	}
+
+	// Pick up the files of earlier sessions, oldest first
+	struct FoundFile
+	{
+		Hash128                         Key      = {};
+		std::uint64_t                   Size     = 0;
+		std::filesystem::file_time_type LastUsed = {};
+	};
+	std::vector<FoundFile> FoundFiles;
+
+	const std::filesystem::file_time_type Now
+		= std::filesystem::file_time_type::clock::now();
+
+	for( const std::filesystem::directory_entry& CurFile :
+		 std::filesystem::directory_iterator(NewDirectory, Error) )
+	{
+		if( !CurFile.is_regular_file(Error) )
+		{
+			continue;
+		}
+
+		const std::filesystem::path&          CurPath = CurFile.path();
+		const std::filesystem::file_time_type LastWrite
+			= CurFile.last_write_time(Error);
+
+		if( CurPath.extension() == TempExtension )
+		{
+			if( !Error && Now - LastWrite > StaleTempAge )
+			{
+				std::filesystem::remove(CurPath, Error);
+			}
+			continue;
+		}
+
+		if( CurPath.extension() != FileExtension )
+		{
+			continue;
+		}
+
+		if( const std::optional<Hash128> Key
+			= StringToKey(CurPath.stem().string());
+			Key )
+		{
+			FoundFiles.push_back(FoundFile{
+				.Key      = *Key,
+				.Size     = CurFile.file_size(Error),
+				.LastUsed = LastWrite,
+			});
+		}
+	}
+
+	std::sort(
+		FoundFiles.begin(), FoundFiles.end(),
+		[](const FoundFile& A, const FoundFile& B) -> bool {
+			return A.LastUsed < B.LastUsed;
+		}
+	);
+
+	const std::scoped_lock CacheLock(CacheMutex);
+	Directory = NewDirectory;
+	Capacity  = NewCapacity;
+	Size      = 0;
+	Entries.clear();
+	for( const FoundFile& CurFile : FoundFiles )
+	{
+		Entries.push_back(Entry{
+			.Key     = CurFile.Key,
+			.Size    = CurFile.Size,
+			.LastUse = ++UseTick,
+		});
+		Size += CurFile.Size;
+	}
+	Trim();
+
+	return true;
+}
+
+bool ResultCache::IsOpen() const
+{
+	const std::scoped_lock CacheLock(CacheMutex);
+	return !Directory.empty();
+}
+
+bool ResultCache::Load(
+	const Hash128& Key, std::uint32_t Width, std::uint32_t Height,
+	std::size_t PixelSize, std::byte* Destination,
+	std::size_t DestinationRowBytes
+)
+{
+	std::filesystem::path Path;
+	{
+		const std::scoped_lock CacheLock(CacheMutex);
+		const bool Found = std::any_of(
+			Entries.begin(), Entries.end(),
+			[&](const Entry& CurEntry) -> bool { return CurEntry.Key == Key; }
+		);
+		if( Directory.empty() || !Found )
+		{
+			++Misses;
+			return false;
+		}
+		Path = EntryPath(Key);
+	}
+
+	// The file is read without holding the lock. Should it get evicted in the
+	// meantime, the mapping keeps its contents around
+	MappedFile Mapping;
+	bool       Valid = Mapping.Open(Path);
+
+	const std::size_t RowSize = std::size_t(Width) * PixelSize;
+	const std::span<const std::byte> FileData = Mapping.Data();
+
+	FileHeader Header = {};
+	if( Valid && FileData.size() >= FileDataOffset )
+	{
+		std::memcpy(&Header, FileData.data(), sizeof(FileHeader));
+	}
+
+	Valid = Valid && Header.Magic == FileMagic && Header.Version == FileVersion
+		 && Header.Key == Key && Header.Width == Width
+		 && Header.Height == Height && Header.PixelSize == PixelSize
+		 && Header.DataSize == RowSize * Height
+		 && FileData.size() >= FileDataOffset + Header.DataSize;
+
+	if( Valid )
+	{
+		const std::byte* SourceData = FileData.data() + FileDataOffset;
+		for( std::uint32_t CurRow = 0; CurRow < Height; ++CurRow )
+		{
+			std::memcpy(
+				Destination + DestinationRowBytes * CurRow,
+				SourceData + RowSize * CurRow, RowSize
+			);
+		}
+
+		// Mark the file as recently used for future sessions too
+		std::error_code Error;
+		std::filesystem::last_write_time(
+			Path, std::filesystem::file_time_type::clock::now(), Error
+		);
+	}
+
+	const std::scoped_lock CacheLock(CacheMutex);
+	const auto Match = std::find_if(
+		Entries.begin(), Entries.end(),
+		[&](const Entry& CurEntry) -> bool { return CurEntry.Key == Key; }
+	);
+	if( Valid )
+	{
+		++Hits;
+		if( Match != Entries.end() )
+		{
+			Match->LastUse = ++UseTick;
+		}
+		return true;
+	}
+
+	// Files that can not be read, or that belong to an older version of the
+	// cache are not of any use anymore
+	++Misses;
+	if( Match != Entries.end() )
+	{
+		std::error_code Error;
+		std::filesystem::remove(Path, Error);
+		Size -= Match->Size;
+		Entries.erase(Match);
+	}
+	return false;
+}
+
+void ResultCache::Store(
+	const Hash128& Key, std::uint32_t Width, std::uint32_t Height,
+	std::size_t PixelSize, const std::byte* Source, std::size_t SourceRowBytes
+)
+{
+	std::filesystem::path Path;
+	{
+		const std::scoped_lock CacheLock(CacheMutex);
+		if( Directory.empty() )
+		{
+			return;
+		}
+		Path = EntryPath(Key);
+	}
+
+	const std::size_t   RowSize  = std::size_t(Width) * PixelSize;
+	const std::uint64_t DataSize = std::uint64_t(RowSize) * Height;
+	const std::uint64_t FileSize = FileDataOffset + DataSize;
+
+	const FileHeader Header = {
+		.Magic     = FileMagic,
+		.Version   = FileVersion,
+		.Width     = Width,
+		.Height    = Height,
+		.PixelSize = std::uint32_t(PixelSize),
+		.Key       = Key,
+		.DataSize  = DataSize,
+		.Reserved  = 0,
+	};
+
+	// Written under a temporary name first, and only renamed into place once
+	// all of it has reached the disk
+	std::filesystem::path TempPath = Path;
+	TempPath += UniqueTempSuffix();
+	TempPath += TempExtension;
+
+	std::FILE* File = OpenFileForWriting(TempPath);
+	if( !File )
+	{
+		return;
+	}
+
+	static constexpr std::array<std::byte, FileDataOffset - sizeof(FileHeader)>
+		HeaderPadding = {};
+
+	bool Written
+		= std::fwrite(&Header, sizeof(FileHeader), 1, File) == 1
+	   && std::fwrite(HeaderPadding.data(), HeaderPadding.size(), 1, File) == 1;
+	for( std::uint32_t CurRow = 0; Written && CurRow < Height; ++CurRow )
+	{
+		Written = std::fwrite(
+					  Source + SourceRowBytes * CurRow, RowSize, 1, File
+				  )
+			   == 1;
+	}
+	Written = Written && FlushFile(File);
+	Written = (std::fclose(File) == 0) && Written;
+
+	std::error_code Error;
+	if( Written )
+	{
+		std::filesystem::rename(TempPath, Path, Error);
+	}
+	if( !Written || Error )
+	{
+		std::filesystem::remove(TempPath, Error);
+		return;
+	}
+
+	const std::scoped_lock CacheLock(CacheMutex);
+	const auto Match = std::find_if(
+		Entries.begin(), Entries.end(),
+		[&](const Entry& CurEntry) -> bool { return CurEntry.Key == Key; }
+	);
+	if( Match != Entries.end() )
+	{
+		Size -= Match->Size;
+		Entries.erase(Match);
+	}
+	Entries.push_back(Entry{
+		.Key     = Key,
+		.Size    = FileSize,
+		.LastUse = ++UseTick,
+	});
+	Size += FileSize;
+	Trim();
+}
+
+ResultCache::Statistics ResultCache::GetStatistics() const
+{
+	const std::scoped_lock CacheLock(CacheMutex);
+	return Statistics{
+		.Hits   = Hits,
+		.Misses = Misses,
+		.Files  = Entries.size(),
+		.Size   = Size,
+	};
+}
+
+std::filesystem::path ResultCache::EntryPath(const Hash128& Key) const
+{
+	return Directory / (KeyToString(Key) + FileExtension);
+}
+
+void ResultCache::Trim()
+{
+	while( Size > Capacity && !Entries.empty() )
+	{
+		const auto Oldest = std::min_element(
+			Entries.begin(), Entries.end(),
+			[](const Entry& A, const Entry& B) -> bool {
+				return A.LastUse < B.LastUse;
+			}
+		);
+
+		// Files that are still mapped by a reader may fail to be deleted on
+		// some platforms. They are forgotten about all the same, and picked up
+		// again by the next session
+		std::error_code Error;
+		std::filesystem::remove(EntryPath(Oldest->Key), Error);
+		Size -= Oldest->Size;
+		Entries.erase(Oldest);
+	}
+}
+
+} // namespace Vulkanator
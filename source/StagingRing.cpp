@@ -0,0 +1,197 @@
+#include "StagingRing.hpp"
+
+#include <tuple>
+#include <utility>
+
+#include "VulkanUtils.hpp"
+
+namespace Vulkanator
+{
+
+StagingRing::Region::~Region()
+{
+	Reset();
+}
+
+StagingRing::Region::Region(Region&& Other) noexcept
+	: Ring(std::exchange(Other.Ring, nullptr)), Position(Other.Position),
+	  Offset(Other.Offset), Size(Other.Size)
+{
+}
+
+StagingRing::Region& StagingRing::Region::operator=(Region&& Other) noexcept
+{
+	if( this != &Other )
+	{
+		Reset();
+		Ring     = std::exchange(Other.Ring, nullptr);
+		Position = Other.Position;
+		Offset   = Other.Offset;
+		Size     = Other.Size;
+	}
+	return *this;
+}
+
+vk::Buffer StagingRing::Region::GetBuffer() const
+{
+	return Ring ? Ring->Buffer.get() : vk::Buffer();
+}
+
+std::byte* StagingRing::Region::GetMapping() const
+{
+	return Ring ? Ring->Mapping + Offset : nullptr;
+}
+
+void StagingRing::Region::Reset()
+{
+	if( Ring )
+	{
+		Ring->Retire(*this);
+		Ring = nullptr;
+	}
+}
+
+bool StagingRing::Initialize(
+	VulkanUtils::MemoryAllocator& Allocator, vk::DeviceSize NewCapacity,
+	vk::MemoryPropertyFlags        Properties,
+	vk::MemoryPropertyFlags        ExcludeProperties,
+	std::span<const std::uint32_t> QueueFamilies
+)
+{
+	NewCapacity = (NewCapacity / Alignment) * Alignment;
+	if( !NewCapacity )
+	{
+		return false;
+	}
+
+	const bool Concurrent = QueueFamilies.size() > 1;
+	if( auto BufferResult = VulkanUtils::AllocateBuffer(
+			Allocator, NewCapacity,
+			vk::BufferUsageFlagBits::eTransferSrc
+				| vk::BufferUsageFlagBits::eTransferDst,
+			Properties, ExcludeProperties,
+			Concurrent ? vk::SharingMode::eConcurrent
+					   : vk::SharingMode::eExclusive,
+			Concurrent ? QueueFamilies : std::span<const std::uint32_t>()
+		);
+		BufferResult.has_value() )
+	{
+		std::tie(Buffer, Memory) = std::move(BufferResult.value());
+	}
+	else
+	{
+		// Error allocating staging buffer
+		return false;
+	}
+
+	// The allocator keeps it mapped for as long as it is alive
+	if( std::byte* const NewMapping = Memory.GetMapping(); NewMapping )
+	{
+		Mapping = NewMapping;
+	}
+	else
+	{
+		// Error mapping staging buffer
+		Buffer.reset();
+		Memory.Reset();
+		return false;
+	}
+
+	Capacity = NewCapacity;
+	return true;
+}
+
+StagingRing::Region StagingRing::Allocate(vk::DeviceSize Size)
+{
+	Size = Align(Size);
+	if( !Mapping || !Size || Size > Capacity )
+	{
+		return Region();
+	}
+
+	std::unique_lock RingLock(RingMutex);
+
+	bool          Waited   = false;
+	std::uint64_t Position = 0;
+	while( true )
+	{
+		// Regions never wrap around the end of the buffer. If the region does
+		// not fit before the end, the rest of the buffer is skipped over
+		Position                    = Head;
+		const vk::DeviceSize Offset = Position % Capacity;
+		if( Offset + Size > Capacity )
+		{
+			Position += Capacity - Offset;
+		}
+
+		if( Position + Size - Tail <= Capacity )
+		{
+			break;
+		}
+
+		Waited = true;
+		RetireCondition.wait(RingLock);
+	}
+
+	Head = Position + Size;
+	LiveRegions.emplace(Position, LiveRegion{.Size = Size});
+
+	++Allocations;
+	if( Waited )
+	{
+		++Waits;
+	}
+
+	Region NewRegion;
+	NewRegion.Ring     = this;
+	NewRegion.Position = Position;
+	NewRegion.Offset   = Position % Capacity;
+	NewRegion.Size     = Size;
+	return NewRegion;
+}
+
+StagingRing::Statistics StagingRing::GetStatistics() const
+{
+	const std::scoped_lock RingLock(RingMutex);
+	return Statistics{
+		.Capacity    = Capacity,
+		.Used        = Head - Tail,
+		.Allocations = Allocations,
+		.Waits       = Waits,
+	};
+}
+
+void StagingRing::Retire(const Region& Retired)
+{
+	{
+		const std::scoped_lock RingLock(RingMutex);
+
+		if( const auto Match = LiveRegions.find(Retired.Position);
+			Match != LiveRegions.end() )
+		{
+			Match->second.Retired = true;
+		}
+
+		// Advance past every region at the tail that has retired
+		while( !LiveRegions.empty() && LiveRegions.begin()->second.Retired )
+		{
+			LiveRegions.erase(LiveRegions.begin());
+		}
+
+		if( LiveRegions.empty() )
+		{
+			// Nothing is in use, so the next region may start anywhere.
+			// Starting over at the beginning of the buffer keeps large regions
+			// from having to skip over its end
+			Head = 0;
+			Tail = 0;
+		}
+		else
+		{
+			Tail = LiveRegions.begin()->first;
+		}
+	}
+	RetireCondition.notify_all();
+}
+
+} // namespace Vulkanator
@@ -0,0 +1,751 @@
+#include "SubmissionService.hpp"
+
+#include <algorithm>
+
+namespace Vulkanator
+{
+
+// Weight of each new latency within the moving average of a queue's latency
+static constexpr std::int64_t LatencyAverageWeight = 8;
+
+vk::Result SubmissionService::Request::Wait()
+{
+	{
+		std::unique_lock SubmitLock(SubmitMutex);
+		SubmitCondition.wait(SubmitLock, [this]() -> bool {
+			return Submitted;
+		});
+		if( Result != vk::Result::eSuccess )
+		{
+			// Error submitting, the GPU will never signal this request
+			return Result;
+		}
+	}
+	return Service->WaitTimeline(*this);
+}
+
+void SubmissionService::Request::Signal(vk::Result NewResult)
+{
+	// The condition variable is notified while the lock is still held so that
+	// the waiting render thread can not return and destroy this request until
+	// we are done touching it
+	const std::scoped_lock SubmitLock(SubmitMutex);
+	Result    = NewResult;
+	Submitted = true;
+	SubmitCondition.notify_one();
+}
+
+SubmissionService::~SubmissionService()
+{
+	Stop();
+}
+
+bool SubmissionService::Start(
+	vk::Device NewDevice, std::span<const vk::Queue> NewQueues,
+	const vk::DispatchLoaderDynamic& NewDispatcher, bool NewTimelineSemaphores
+)
+{
+	Device             = NewDevice;
+	Dispatcher         = &NewDispatcher;
+	TimelineCount      = NewQueues.size();
+	Timelines          = std::make_unique<Timeline[]>(TimelineCount);
+	TimelineSemaphores = NewTimelineSemaphores;
+	StartTime          = std::chrono::steady_clock::now();
+
+	const vk::SemaphoreTypeCreateInfo TimelineTypeInfo = {
+		.semaphoreType = vk::SemaphoreType::eTimeline,
+		.initialValue  = 0,
+	};
+	const vk::SemaphoreCreateInfo TimelineInfo = {
+		.pNext = &TimelineTypeInfo,
+	};
+
+	for( std::size_t i = 0; i < TimelineCount; ++i )
+	{
+		Timelines[i].Queue = NewQueues[i];
+		if( !TimelineSemaphores )
+		{
+			continue;
+		}
+
+		if( auto SemaphoreResult = Device.createSemaphoreUnique(TimelineInfo);
+			SemaphoreResult.result == vk::Result::eSuccess )
+		{
+			Timelines[i].Semaphore = std::move(SemaphoreResult.value);
+		}
+		else
+		{
+			// Error creating timeline semaphore
+			Timelines.reset();
+			TimelineCount = 0;
+			return false;
+		}
+	}
+
+	if( !TimelineSemaphores )
+	{
+		RetireStop   = false;
+		RetireResult = vk::Result::eSuccess;
+		RetireThread = std::thread(&SubmissionService::RetireThreadMain, this);
+	}
+
+	SubmitThread = std::thread(&SubmissionService::SubmitThreadMain, this);
+	Accepting.store(true);
+	return true;
+}
+
+void SubmissionService::Stop()
+{
+	if( SubmitThread.joinable() )
+	{
+		// Any request that got past the check within `Submit` is pushed
+		// before the stop-request. Anything after that is turned away
+		Accepting.store(false);
+		while( ActiveSubmits.load() )
+		{
+			std::this_thread::yield();
+		}
+
+		// The submission thread will submit everything that was pushed before
+		// the stop-request, and then exit
+		Push(StopRequest);
+		SubmitThread.join();
+	}
+
+	// The semaphores may only be destroyed once the GPU is done signaling
+	// them. A hung device is not waited on forever though
+	if( TimelineCount )
+	{
+		static_cast<void>(WaitFor(GetCheckpoint(), HangTimeout));
+	}
+
+	// Whatever the retire thread has not retired by now is given up on
+	if( RetireThread.joinable() )
+	{
+		{
+			const std::scoped_lock RetireLock(RetireMutex);
+			RetireStop = true;
+		}
+		RetireCondition.notify_one();
+		RetireThread.join();
+	}
+	RetireQueue.clear();
+	FreeFences.clear();
+
+	Timelines.reset();
+	TimelineCount = 0;
+}
+
+void SubmissionService::Submit(Request& NewRequest)
+{
+	NewRequest.Service = this;
+
+	// Sequentially consistent, so that `Stop` either sees this submit as
+	// active, or this submit sees that the service has stopped
+	++ActiveSubmits;
+	if( !Accepting.load() )
+	{
+		--ActiveSubmits;
+
+		// Nothing would ever submit or signal the request
+		NewRequest.Signal(vk::Result::eErrorInitializationFailed);
+		return;
+	}
+
+	Push(NewRequest);
+	--ActiveSubmits;
+}
+
+void SubmissionService::Push(Request& NewRequest)
+{
+	// Push onto the head of the intrusive stack
+	Request* CurHead = PendingHead.load(std::memory_order_relaxed);
+	do
+	{
+		NewRequest.Next = CurHead;
+	}
+	while( !PendingHead.compare_exchange_weak(
+		CurHead, &NewRequest, std::memory_order_release,
+		std::memory_order_relaxed
+	) );
+
+	// Only the transition from empty to non-empty has to wake up the
+	// submission thread
+	if( CurHead == nullptr )
+	{
+		PendingHead.notify_one();
+	}
+}
+
+SubmissionService::Checkpoint SubmissionService::GetCheckpoint() const
+{
+	Checkpoint Result = {};
+	Result.Values.resize(TimelineCount);
+	for( std::size_t i = 0; i < TimelineCount; ++i )
+	{
+		Result.Values[i]
+			= Timelines[i].LastValue.load(std::memory_order_acquire);
+	}
+	return Result;
+}
+
+bool SubmissionService::HasReached(const Checkpoint& Point) const
+{
+	for( std::size_t i = 0; i < Point.Values.size() && i < TimelineCount; ++i )
+	{
+		if( Point.Values[i]
+			&& GetTimelineValue(std::uint32_t(i)) < Point.Values[i] )
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+vk::Result SubmissionService::WaitFor(
+	const Checkpoint& Point, std::chrono::nanoseconds Timeout
+) const
+{
+	if( !TimelineSemaphores )
+	{
+		// Woken up every time that the retire thread retires a batch
+		std::unique_lock ReachedLock(ReachedMutex);
+
+		const bool Reached = ReachedCondition.wait_for(
+			ReachedLock, Timeout, [&]() -> bool {
+				return RetireResult.load() != vk::Result::eSuccess
+					|| HasReached(Point);
+			}
+		);
+		if( const vk::Result CurResult = RetireResult.load();
+			CurResult != vk::Result::eSuccess )
+		{
+			// Error waiting on a fence, such as a lost device
+			return CurResult;
+		}
+		return Reached ? vk::Result::eSuccess : vk::Result::eTimeout;
+	}
+
+	std::vector<vk::Semaphore> Semaphores = {};
+	std::vector<std::uint64_t> Values     = {};
+	for( std::size_t i = 0; i < Point.Values.size() && i < TimelineCount; ++i )
+	{
+		if( Point.Values[i] )
+		{
+			Semaphores.emplace_back(Timelines[i].Semaphore.get());
+			Values.emplace_back(Point.Values[i]);
+		}
+	}
+
+	if( Semaphores.empty() )
+	{
+		return vk::Result::eSuccess;
+	}
+
+	// Waits on every one of the semaphores
+	const vk::SemaphoreWaitInfo WaitInfo = {
+		.semaphoreCount = std::uint32_t(Semaphores.size()),
+		.pSemaphores    = Semaphores.data(),
+		.pValues        = Values.data(),
+	};
+	return Device.waitSemaphoresKHR(
+		WaitInfo, std::uint64_t(Timeout.count()), *Dispatcher
+	);
+}
+
+SubmissionService::Statistics SubmissionService::GetStatistics() const
+{
+	Statistics Result  = {};
+	Result.Submits     = Submits.load(std::memory_order_relaxed);
+	Result.SubmitInfos = SubmitInfos.load(std::memory_order_relaxed);
+
+	const glm::f64 Seconds = std::chrono::duration<glm::f64>(
+								 std::chrono::steady_clock::now() - StartTime
+	)
+								 .count();
+	if( Seconds > 0.0 )
+	{
+		Result.SubmitsPerSecond = glm::f64(Result.Submits) / Seconds;
+	}
+	if( Result.Submits )
+	{
+		Result.AverageBatchSize
+			= glm::f64(Result.SubmitInfos) / glm::f64(Result.Submits);
+	}
+
+	Result.ReadyWaits     = ReadyWaits.load(std::memory_order_relaxed);
+	Result.SpunWaits      = SpunWaits.load(std::memory_order_relaxed);
+	Result.BlockedWaits   = BlockedWaits.load(std::memory_order_relaxed);
+	Result.Stalls         = Stalls.load(std::memory_order_relaxed);
+	Result.SuspectedHangs = SuspectedHangs.load(std::memory_order_relaxed);
+	for( std::size_t i = 0; i < WaitHistogram.size(); ++i )
+	{
+		Result.WaitHistogram[i]
+			= WaitHistogram[i].load(std::memory_order_relaxed);
+	}
+	Result.TotalWaitTime = std::chrono::nanoseconds(
+		TotalWaitTime.load(std::memory_order_relaxed)
+	);
+	Result.LongestWaitTime = std::chrono::nanoseconds(
+		LongestWaitTime.load(std::memory_order_relaxed)
+	);
+
+	{
+		const std::scoped_lock StallLock(StallMutex);
+		Result.LastStall = LastStall;
+	}
+	return Result;
+}
+
+void SubmissionService::SubmitThreadMain()
+{
+	std::vector<Request*> Requests;
+
+	bool Running = true;
+	while( Running )
+	{
+		// Sleep until there is something in the queue
+		PendingHead.wait(nullptr, std::memory_order_acquire);
+
+		// Take everything that is currently pending
+		Request* PendingList
+			= PendingHead.exchange(nullptr, std::memory_order_acquire);
+
+		Requests.clear();
+		for( ; PendingList != nullptr; PendingList = PendingList->Next )
+		{
+			if( PendingList == &StopRequest )
+			{
+				Running = false;
+				continue;
+			}
+			Requests.push_back(PendingList);
+		}
+
+		if( Requests.empty() )
+		{
+			continue;
+		}
+
+		// The stack is in LIFO order, so reverse it to submit in the order that
+		// the requests came in
+		std::reverse(Requests.begin(), Requests.end());
+
+		// Each run of consecutive requests into the same queue becomes one
+		// batch. Re-ordering requests across queues could submit a semaphore
+		// wait before its signal
+		auto RunBegin = Requests.begin();
+		while( RunBegin != Requests.end() )
+		{
+			const std::uint32_t QueueIndex = (*RunBegin)->QueueIndex;
+
+			const auto RunEnd = std::find_if(
+				RunBegin, Requests.end(),
+				[QueueIndex](const Request* CurRequest) -> bool {
+					return CurRequest->QueueIndex != QueueIndex;
+				}
+			);
+			SubmitBatch(QueueIndex, std::span<Request* const>(RunBegin, RunEnd));
+			RunBegin = RunEnd;
+		}
+	}
+}
+
+void SubmissionService::SubmitBatch(
+	std::uint32_t QueueIndex, std::span<Request* const> BatchRequests
+)
+{
+	if( QueueIndex >= TimelineCount )
+	{
+		for( Request* FailedRequest : BatchRequests )
+		{
+			FailedRequest->Signal(vk::Result::eErrorInitializationFailed);
+		}
+		return;
+	}
+
+	Timeline& CurTimeline = Timelines[QueueIndex];
+
+	std::uint64_t NextValue
+		= CurTimeline.LastValue.load(std::memory_order_relaxed);
+
+	SubmitInfosBatch.clear();
+	vk::UniqueFence BatchFence = {};
+	if( TimelineSemaphores )
+	{
+		// Each request signals the next value of the queue's timeline, on top
+		// of its own semaphores. These are sized up-front, so that the submit
+		// infos may point into them
+		std::size_t SignalCount = 0;
+		for( const Request* PendingRequest : BatchRequests )
+		{
+			SignalCount
+				+= PendingRequest->SubmitInfo.signalSemaphoreCount + 1;
+		}
+
+		TimelineInfosBatch.resize(BatchRequests.size());
+		SignalSemaphoresBatch.resize(SignalCount);
+		SignalValuesBatch.resize(SignalCount);
+
+		std::size_t SignalOffset = 0;
+		for( std::size_t i = 0; i < BatchRequests.size(); ++i )
+		{
+			Request&              PendingRequest = *BatchRequests[i];
+			const vk::SubmitInfo& RequestInfo    = PendingRequest.SubmitInfo;
+			const std::uint32_t   BinaryCount
+				= RequestInfo.signalSemaphoreCount;
+
+			PendingRequest.TimelineValue = ++NextValue;
+
+			// The values of binary semaphores are ignored
+			std::copy_n(
+				RequestInfo.pSignalSemaphores, BinaryCount,
+				SignalSemaphoresBatch.begin() + SignalOffset
+			);
+			std::fill_n(
+				SignalValuesBatch.begin() + SignalOffset, BinaryCount, 0
+			);
+			SignalSemaphoresBatch[SignalOffset + BinaryCount]
+				= CurTimeline.Semaphore.get();
+			SignalValuesBatch[SignalOffset + BinaryCount]
+				= PendingRequest.TimelineValue;
+
+			TimelineInfosBatch[i] = vk::TimelineSemaphoreSubmitInfo{
+				.pNext                     = RequestInfo.pNext,
+				.signalSemaphoreValueCount = BinaryCount + 1,
+				.pSignalSemaphoreValues    = &SignalValuesBatch[SignalOffset],
+			};
+
+			vk::SubmitInfo& BatchInfo
+				= SubmitInfosBatch.emplace_back(RequestInfo);
+			BatchInfo.pNext                = &TimelineInfosBatch[i];
+			BatchInfo.signalSemaphoreCount = BinaryCount + 1;
+			BatchInfo.pSignalSemaphores
+				= &SignalSemaphoresBatch[SignalOffset];
+
+			SignalOffset += BinaryCount + 1;
+		}
+	}
+	else
+	{
+		// The batch signals a fence instead, which the retire thread waits on
+		for( Request* PendingRequest : BatchRequests )
+		{
+			PendingRequest->TimelineValue = ++NextValue;
+			SubmitInfosBatch.emplace_back(PendingRequest->SubmitInfo);
+		}
+
+		BatchFence = AcquireFence();
+		if( !BatchFence )
+		{
+			// Error creating fence
+			for( Request* FailedRequest : BatchRequests )
+			{
+				FailedRequest->Signal(vk::Result::eErrorOutOfDeviceMemory);
+			}
+			return;
+		}
+	}
+
+	const vk::Result SubmitResult
+		= CurTimeline.Queue.submit(SubmitInfosBatch, BatchFence.get());
+
+	if( SubmitResult != vk::Result::eSuccess )
+	{
+		// Error submitting, none of these requests will ever complete
+		for( Request* FailedRequest : BatchRequests )
+		{
+			FailedRequest->Signal(SubmitResult);
+		}
+		return;
+	}
+
+	CurTimeline.LastValue.store(NextValue, std::memory_order_release);
+
+	if( BatchFence )
+	{
+		{
+			const std::scoped_lock RetireLock(RetireMutex);
+			RetireQueue.emplace_back(FencedBatch{
+				.QueueIndex = QueueIndex,
+				.Value      = NextValue,
+				.Fence      = std::move(BatchFence),
+			});
+		}
+		RetireCondition.notify_one();
+	}
+
+	Submits.fetch_add(1, std::memory_order_relaxed);
+	SubmitInfos.fetch_add(BatchRequests.size(), std::memory_order_relaxed);
+
+	const std::chrono::steady_clock::time_point SubmitTime
+		= std::chrono::steady_clock::now();
+	for( Request* SubmittedRequest : BatchRequests )
+	{
+		SubmittedRequest->SubmitTime = SubmitTime;
+		SubmittedRequest->Signal(vk::Result::eSuccess);
+	}
+}
+
+vk::UniqueFence SubmissionService::AcquireFence()
+{
+	{
+		const std::scoped_lock FenceLock(FenceMutex);
+		if( !FreeFences.empty() )
+		{
+			vk::UniqueFence Fence = std::move(FreeFences.back());
+			FreeFences.pop_back();
+			return Fence;
+		}
+	}
+
+	if( auto FenceResult = Device.createFenceUnique({});
+		FenceResult.result == vk::Result::eSuccess )
+	{
+		return std::move(FenceResult.value);
+	}
+
+	// Error creating fence
+	return {};
+}
+
+void SubmissionService::RetireThreadMain()
+{
+	while( true )
+	{
+		FencedBatch CurBatch = {};
+		{
+			std::unique_lock RetireLock(RetireMutex);
+			RetireCondition.wait(RetireLock, [this]() -> bool {
+				return RetireStop || !RetireQueue.empty();
+			});
+
+			if( RetireStop )
+			{
+				// `Stop` already waited on everything that it was going to
+				return;
+			}
+
+			CurBatch = std::move(RetireQueue.front());
+			RetireQueue.pop_front();
+		}
+
+		// Batches are retired in the order that they were submitted. Batches
+		// of another queue may finish sooner, but are only ever retired late.
+		// A fence also signals once everything that was submitted into its
+		// queue before it has finished, so the queue's value only ever
+		// increases. Waits one slice at a time, so that a hung device does not
+		// keep `Stop` from joining this thread
+		vk::Result WaitResult = vk::Result::eTimeout;
+		while( WaitResult == vk::Result::eTimeout )
+		{
+			WaitResult = Device.waitForFences(
+				{CurBatch.Fence.get()}, VK_TRUE,
+				std::uint64_t(WaitSlice.count())
+			);
+
+			const std::scoped_lock RetireLock(RetireMutex);
+			if( WaitResult == vk::Result::eTimeout && RetireStop )
+			{
+				return;
+			}
+		}
+
+		if( WaitResult == vk::Result::eSuccess )
+		{
+			Timelines[CurBatch.QueueIndex].ReachedValue.store(
+				CurBatch.Value, std::memory_order_release
+			);
+
+			// Reset(unsignal) fence for later re-use
+			if( Device.resetFences({CurBatch.Fence.get()})
+				== vk::Result::eSuccess )
+			{
+				const std::scoped_lock FenceLock(FenceMutex);
+				FreeFences.emplace_back(std::move(CurBatch.Fence));
+			}
+		}
+		else
+		{
+			// Error waiting on fence, such as a lost device. The batches after
+			// it will not complete either
+			RetireResult.store(WaitResult);
+		}
+
+		// Wake up every thread that waits on a value. The lock is taken so that
+		// a waiter can not miss this in between checking and going to sleep
+		{
+			const std::scoped_lock ReachedLock(ReachedMutex);
+		}
+		ReachedCondition.notify_all();
+	}
+}
+
+vk::ResultValue<std::uint64_t>
+	SubmissionService::QueryTimelineValue(std::uint32_t QueueIndex) const
+{
+	if( !TimelineSemaphores )
+	{
+		return vk::ResultValue<std::uint64_t>(
+			RetireResult.load(),
+			Timelines[QueueIndex].ReachedValue.load(std::memory_order_acquire)
+		);
+	}
+	return Device.getSemaphoreCounterValueKHR(
+		Timelines[QueueIndex].Semaphore.get(), *Dispatcher
+	);
+}
+
+std::uint64_t SubmissionService::GetTimelineValue(std::uint32_t QueueIndex
+) const
+{
+	if( auto CounterResult = QueryTimelineValue(QueueIndex);
+		CounterResult.result == vk::Result::eSuccess )
+	{
+		return CounterResult.value;
+	}
+	return 0;
+}
+
+vk::Result SubmissionService::WaitTimeline(const Request& CurRequest)
+{
+	const std::chrono::steady_clock::time_point WaitBegin
+		= std::chrono::steady_clock::now();
+
+	Timeline& CurTimeline = Timelines[CurRequest.QueueIndex];
+
+	if( GetTimelineValue(CurRequest.QueueIndex) >= CurRequest.TimelineValue )
+	{
+		// Already finished. How long it actually took is not known, so it is
+		// left out of the queue's latency
+		RecordWait(std::chrono::nanoseconds(0), ReadyWaits);
+		return vk::Result::eSuccess;
+	}
+
+	// Requests are predicted to take about as long as the recent requests of
+	// the same queue took. The time since its submission is already behind it
+	const std::chrono::nanoseconds AverageLatency(
+		CurTimeline.AverageLatency.load(std::memory_order_relaxed)
+	);
+	const std::chrono::nanoseconds Remaining
+		= AverageLatency - (WaitBegin - CurRequest.SubmitTime);
+
+	const auto Complete = [&](std::atomic<std::uint64_t>& Kind) -> void {
+		const std::chrono::steady_clock::time_point WaitEnd
+			= std::chrono::steady_clock::now();
+		RecordWait(WaitEnd - WaitBegin, Kind);
+
+		// Not synchronized with other render threads, which only ever makes
+		// the average a little less precise
+		const std::int64_t Latency
+			= std::chrono::nanoseconds(WaitEnd - CurRequest.SubmitTime).count();
+		const std::int64_t PrevLatency
+			= CurTimeline.AverageLatency.load(std::memory_order_relaxed);
+		CurTimeline.AverageLatency.store(
+			PrevLatency
+				? PrevLatency + (Latency - PrevLatency) / LatencyAverageWeight
+				: Latency,
+			std::memory_order_relaxed
+		);
+	};
+
+	// Poll for up to twice the remaining time, in case the prediction was a
+	// little off. Anything predicted to take longer goes right to blocking
+	if( Remaining <= SpinThreshold )
+	{
+		const std::chrono::steady_clock::time_point SpinEnd
+			= WaitBegin
+			+ std::clamp<std::chrono::nanoseconds>(
+				  Remaining * 2, SpinThreshold / 4, SpinThreshold
+			);
+		while( std::chrono::steady_clock::now() < SpinEnd )
+		{
+			if( auto CounterResult
+				= QueryTimelineValue(CurRequest.QueueIndex);
+				CounterResult.result != vk::Result::eSuccess )
+			{
+				// Error polling timeline, such as a lost device
+				return CounterResult.result;
+			}
+			else if( CounterResult.value >= CurRequest.TimelineValue )
+			{
+				Complete(SpunWaits);
+				return vk::Result::eSuccess;
+			}
+			std::this_thread::yield();
+		}
+	}
+
+	// Only the request's own queue is waited on
+	Checkpoint WaitPoint = {};
+	WaitPoint.Values.resize(TimelineCount);
+	WaitPoint.Values[CurRequest.QueueIndex] = CurRequest.TimelineValue;
+
+	// Blocks one slice at a time, so that a request that takes unusually long
+	// gets reported, and is given up on once it has been in flight for longer
+	// than `HangTimeout`. Requests that were submitted together time out
+	// together, rather than one timeout after another
+	while( true )
+	{
+		const vk::Result WaitResult = WaitFor(WaitPoint, WaitSlice);
+		if( WaitResult == vk::Result::eSuccess )
+		{
+			Complete(BlockedWaits);
+			return vk::Result::eSuccess;
+		}
+		else if( WaitResult != vk::Result::eTimeout )
+		{
+			// Error waiting on timeline, such as a lost device
+			return WaitResult;
+		}
+
+		const std::chrono::nanoseconds Elapsed
+			= std::chrono::steady_clock::now() - WaitBegin;
+
+		Stalls.fetch_add(1, std::memory_order_relaxed);
+		{
+			const std::scoped_lock StallLock(StallMutex);
+			LastStall = Stall{
+				.QueueIndex   = CurRequest.QueueIndex,
+				.WaitValue    = CurRequest.TimelineValue,
+				.ReachedValue = GetTimelineValue(CurRequest.QueueIndex),
+				.Elapsed      = Elapsed,
+			};
+		}
+
+		if( std::chrono::steady_clock::now() - CurRequest.SubmitTime
+			>= HangTimeout )
+		{
+			// The device may be hung. The GPU may still be using the
+			// request's resources, see `Request::Wait`
+			SuspectedHangs.fetch_add(1, std::memory_order_relaxed);
+			return vk::Result::eTimeout;
+		}
+	}
+}
+
+void SubmissionService::RecordWait(
+	std::chrono::nanoseconds Elapsed, std::atomic<std::uint64_t>& Kind
+)
+{
+	Kind.fetch_add(1, std::memory_order_relaxed);
+
+	// Each bound is inclusive
+	const std::size_t Bucket
+		= std::lower_bound(
+			  WaitBucketBounds.begin(), WaitBucketBounds.end(), Elapsed
+		  )
+		- WaitBucketBounds.begin();
+	WaitHistogram[Bucket].fetch_add(1, std::memory_order_relaxed);
+
+	TotalWaitTime.fetch_add(Elapsed.count(), std::memory_order_relaxed);
+
+	std::int64_t Longest = LongestWaitTime.load(std::memory_order_relaxed);
+	while( Elapsed.count() > Longest
+		   && !LongestWaitTime.compare_exchange_weak(
+			   Longest, Elapsed.count(), std::memory_order_relaxed
+		   ) )
+	{
+	}
+}
+} // namespace Vulkanator
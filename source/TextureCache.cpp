@@ -0,0 +1,220 @@
+#include "TextureCache.hpp"
+
+#include <algorithm>
+
+#include "DestructionQueue.hpp"
+
+namespace Vulkanator
+{
+
+void TextureCache::SetBudget(vk::DeviceSize NewBudget)
+{
+	const std::scoped_lock CacheLock(CacheMutex);
+	Budget = NewBudget;
+	Trim();
+}
+
+void TextureCache::SetDestructionQueue(DestructionQueue* NewDestruction)
+{
+	const std::scoped_lock CacheLock(CacheMutex);
+	Destruction = NewDestruction;
+}
+
+std::shared_ptr<Texture> TextureCache::Find(const Key& TextureKey)
+{
+	const std::scoped_lock CacheLock(CacheMutex);
+
+	const auto Match = std::find_if(
+		Entries.begin(), Entries.end(),
+		[&](const Entry& CurEntry) -> bool {
+			return CurEntry.TextureKey == TextureKey;
+		}
+	);
+
+	if( Match == Entries.end() )
+	{
+		++Misses;
+		return nullptr;
+	}
+
+	++Hits;
+	Match->LastUse = ++UseTick;
+	return Match->Value;
+}
+
+void TextureCache::Insert(
+	const Key& TextureKey, std::shared_ptr<Texture> NewTexture
+)
+{
+	const std::scoped_lock CacheLock(CacheMutex);
+
+	// Another render may have published the same contents in the meantime, in
+	// which case the older texture is replaced. Whoever holds on to it may
+	// keep on reading it
+	std::erase_if(Entries, [&](Entry& CurEntry) -> bool {
+		if( CurEntry.TextureKey == TextureKey || CurEntry.Value == NewTexture )
+		{
+			Size -= CurEntry.Value->Size;
+			if( CurEntry.Value != NewTexture )
+			{
+				Retire(std::move(CurEntry.Value));
+			}
+			return true;
+		}
+		return false;
+	});
+
+	Size += NewTexture->Size;
+	Entries.push_back(Entry{
+		.TextureKey = TextureKey,
+		.Value      = std::move(NewTexture),
+		.LastUse    = ++UseTick,
+	});
+
+	Trim();
+}
+
+std::shared_ptr<Texture> TextureCache::Reclaim(
+	const vk::ImageCreateInfo& Info, const std::shared_ptr<Texture>& Current
+)
+{
+	const std::scoped_lock CacheLock(CacheMutex);
+
+	// New references are only ever handed out while the lock is held, so a
+	// texture that is only referenced by the cache, and maybe the caller, will
+	// stay that way
+	const auto TakeEntry
+		= [&](std::vector<Entry>::iterator Match) -> std::shared_ptr<Texture> {
+		std::shared_ptr<Texture> Result = std::move(Match->Value);
+		Size -= Result->Size;
+		Entries.erase(Match);
+		return Result;
+	};
+
+	if( Current && Current->Info == Info )
+	{
+		const auto Match = std::find_if(
+			Entries.begin(), Entries.end(),
+			[&](const Entry& CurEntry) -> bool {
+				return CurEntry.Value == Current;
+			}
+		);
+
+		if( Match == Entries.end() )
+		{
+			// Never published, or already evicted
+			if( Current.use_count() == 1 )
+			{
+				return Current;
+			}
+		}
+		else if( Current.use_count() == 2 )
+		{
+			return TakeEntry(Match);
+		}
+	}
+
+	auto Oldest = Entries.end();
+	for( auto CurEntry = Entries.begin(); CurEntry != Entries.end();
+		 ++CurEntry )
+	{
+		if( CurEntry->Value->Info == Info && CurEntry->Value.use_count() == 1
+			&& (Oldest == Entries.end() || CurEntry->LastUse < Oldest->LastUse) )
+		{
+			Oldest = CurEntry;
+		}
+	}
+
+	if( Oldest == Entries.end() )
+	{
+		return nullptr;
+	}
+
+	return TakeEntry(Oldest);
+}
+
+bool TextureCache::EvictOne()
+{
+	std::shared_ptr<Texture> Evicted = {};
+	{
+		const std::scoped_lock CacheLock(CacheMutex);
+		Evicted = EvictOldest();
+	}
+
+	// The memory is needed right away, so the texture is destroyed here
+	// rather than retired. Nothing that is still executing on the GPU may
+	// refer to it, since the cache held the only reference
+	return Evicted != nullptr;
+}
+
+void TextureCache::Clear()
+{
+	const std::scoped_lock CacheLock(CacheMutex);
+	Entries.clear();
+	Size = 0;
+}
+
+TextureCache::Statistics TextureCache::GetStatistics() const
+{
+	const std::scoped_lock CacheLock(CacheMutex);
+	return Statistics{
+		.Hits     = Hits,
+		.Misses   = Misses,
+		.Textures = Entries.size(),
+		.Size     = Size,
+	};
+}
+
+void TextureCache::Trim()
+{
+	while( Size > Budget )
+	{
+		if( std::shared_ptr<Texture> Evicted = EvictOldest(); Evicted )
+		{
+			Retire(std::move(Evicted));
+		}
+		else
+		{
+			// Everything that is left is still in use
+			return;
+		}
+	}
+}
+
+std::shared_ptr<Texture> TextureCache::EvictOldest()
+{
+	auto Oldest = Entries.end();
+	for( auto CurEntry = Entries.begin(); CurEntry != Entries.end();
+		 ++CurEntry )
+	{
+		if( CurEntry->Value.use_count() == 1
+			&& (Oldest == Entries.end() || CurEntry->LastUse < Oldest->LastUse) )
+		{
+			Oldest = CurEntry;
+		}
+	}
+
+	if( Oldest == Entries.end() )
+	{
+		return nullptr;
+	}
+
+	std::shared_ptr<Texture> Result = std::move(Oldest->Value);
+	Size -= Result->Size;
+	Entries.erase(Oldest);
+	return Result;
+}
+
+void TextureCache::Retire(std::shared_ptr<Texture>&& Evicted)
+{
+	if( Destruction )
+	{
+		Destruction->Retire(std::move(Evicted));
+	}
+	else
+	{
+		Evicted.reset();
+	}
+}
+
+} // namespace Vulkanator
@@ -2,6 +2,8 @@
 #include "vulkan/vulkan.hpp"
 
 #include <algorithm>
+#include <array>
+#include <cstring>
 #include <fstream>
 #include <iterator>
 
@@ -71,18 +73,22 @@ std::optional<vk::UniqueDeviceMemory> AllocateDeviceMemory(
 	return NewDeviceMemory;
 }
 
-std::optional<std::tuple<vk::UniqueBuffer, vk::UniqueDeviceMemory>>
-	AllocateBuffer(
-		vk::Device Device, vk::PhysicalDevice PhysicalDevice, std::size_t Size,
-		vk::BufferUsageFlags Usage, vk::MemoryPropertyFlags Properties,
-		vk::MemoryPropertyFlags ExcludeProperties, vk::SharingMode Sharing
-	)
+std::optional<std::tuple<vk::UniqueBuffer, MemoryAllocation>> AllocateBuffer(
+	MemoryAllocator& Allocator, std::size_t Size, vk::BufferUsageFlags Usage,
+	vk::MemoryPropertyFlags Properties,
+	vk::MemoryPropertyFlags ExcludeProperties, vk::SharingMode Sharing,
+	std::span<const std::uint32_t> QueueFamilies
+)
 {
+	const vk::Device Device = Allocator.GetDevice();
+
 	// Create the buffer object
 	const vk::BufferCreateInfo NewBufferInfo = {
-		.size        = Size,
-		.usage       = Usage,
-		.sharingMode = Sharing,
+		.size                  = Size,
+		.usage                 = Usage,
+		.sharingMode           = Sharing,
+		.queueFamilyIndexCount = std::uint32_t(QueueFamilies.size()),
+		.pQueueFamilyIndices   = QueueFamilies.data(),
 	};
 
 	vk::UniqueBuffer NewBuffer = {};
@@ -98,26 +104,13 @@ std::optional<std::tuple<vk::UniqueBuffer, vk::UniqueDeviceMemory>>
 		return std::nullopt;
 	}
 
-	// Get buffer memory requirements
-	const vk::MemoryRequirements NewBufferRequirements
-		= Device.getBufferMemoryRequirements(NewBuffer.get());
-
-	const auto BufferMemoryIndex = FindMemoryTypeIndex(
-		PhysicalDevice, NewBufferRequirements.memoryTypeBits, Properties,
-		ExcludeProperties
-	);
-
-	if( BufferMemoryIndex < 0 )
-		return std::nullopt;
-
-	vk::UniqueDeviceMemory NewBufferDeviceMemory{};
-	if( auto NewDeviceMemory = AllocateDeviceMemory(
-			Device, NewBufferRequirements.size, BufferMemoryIndex,
-			NewBuffer.get(), vk::Image()
+	MemoryAllocation NewBufferMemory = {};
+	if( auto NewAllocation = Allocator.AllocateForBuffer(
+			NewBuffer.get(), Properties, ExcludeProperties
 		);
-		NewDeviceMemory.has_value() )
+		NewAllocation.has_value() )
 	{
-		NewBufferDeviceMemory = std::move(NewDeviceMemory.value());
+		NewBufferMemory = std::move(NewAllocation.value());
 	}
 	else
 	{
@@ -125,7 +118,8 @@ std::optional<std::tuple<vk::UniqueBuffer, vk::UniqueDeviceMemory>>
 	}
 
 	if( auto BindResult = Device.bindBufferMemory(
-			NewBuffer.get(), NewBufferDeviceMemory.get(), 0
+			NewBuffer.get(), NewBufferMemory.GetMemory(),
+			NewBufferMemory.GetOffset()
 		);
 		BindResult != vk::Result::eSuccess )
 	{
@@ -133,18 +127,17 @@ std::optional<std::tuple<vk::UniqueBuffer, vk::UniqueDeviceMemory>>
 		return std::nullopt;
 	}
 
-	return std::make_tuple(
-		std::move(NewBuffer), std::move(NewBufferDeviceMemory)
-	);
+	return std::make_tuple(std::move(NewBuffer), std::move(NewBufferMemory));
 }
 
-std::optional<std::tuple<vk::UniqueImage, vk::UniqueDeviceMemory>>
-	AllocateImage(
-		vk::Device Device, vk::PhysicalDevice PhysicalDevice,
-		vk::ImageCreateInfo NewImageInfo, vk::MemoryPropertyFlags Properties,
-		vk::MemoryPropertyFlags ExcludeProperties
-	)
+std::optional<std::tuple<vk::UniqueImage, MemoryAllocation>> AllocateImage(
+	MemoryAllocator& Allocator, vk::ImageCreateInfo NewImageInfo,
+	vk::MemoryPropertyFlags Properties,
+	vk::MemoryPropertyFlags ExcludeProperties
+)
 {
+	const vk::Device Device = Allocator.GetDevice();
+
 	vk::UniqueImage NewImage = {};
 
 	if( auto ImageResult = Device.createImageUnique(NewImageInfo);
@@ -159,42 +152,158 @@ std::optional<std::tuple<vk::UniqueImage, vk::UniqueDeviceMemory>>
 		return std::nullopt;
 	}
 
-	// Get image memory requirements
-	const vk::MemoryRequirements NewImageRequirements
-		= Device.getImageMemoryRequirements(NewImage.get());
+	MemoryAllocation NewImageMemory = {};
+	if( auto NewAllocation = Allocator.AllocateForImage(
+			NewImage.get(), NewImageInfo.tiling, Properties, ExcludeProperties
+		);
+		NewAllocation.has_value() )
+	{
+		NewImageMemory = std::move(NewAllocation.value());
+	}
+	else
+	{
+		return std::nullopt; // Error allocating device memory
+	}
 
-	const auto ImageMemoryIndex = FindMemoryTypeIndex(
-		PhysicalDevice, NewImageRequirements.memoryTypeBits, Properties,
-		ExcludeProperties
-	);
+	if( auto BindResult = Device.bindImageMemory(
+			NewImage.get(), NewImageMemory.GetMemory(),
+			NewImageMemory.GetOffset()
+		);
+		BindResult != vk::Result::eSuccess )
+	{
+		// Error binding image object to device memory
+		return std::nullopt;
+	}
+	return std::make_tuple(std::move(NewImage), std::move(NewImageMemory));
+}
 
-	if( ImageMemoryIndex < 0 )
+std::optional<std::tuple<vk::UniqueBuffer, vk::UniqueDeviceMemory>>
+	ImportHostBuffer(
+		vk::Device Device, vk::PhysicalDevice PhysicalDevice,
+		const vk::DispatchLoaderDynamic& Dispatcher, void* HostPointer,
+		std::size_t Size, vk::BufferUsageFlags Usage, vk::DeviceSize Alignment
+	)
+{
+	if( !HostPointer || !Size || !Alignment )
 	{
-		return std::nullopt; // Unable to find suitable memory index for buffer
+		return std::nullopt;
 	}
 
-	vk::UniqueDeviceMemory NewImageDeviceMemory{};
-	if( auto NewDeviceMemory = AllocateDeviceMemory(
-			Device, NewImageRequirements.size, ImageMemoryIndex, vk::Buffer(),
-			NewImage.get() // ShouldDedicate ? NewImage.get() : vk::Image()
-		) )
+	// Host pointers must be imported at `minImportedHostPointerAlignment`
+	// granularity, both in address and size. The range is never widened to
+	// fit, as the memory around it was never handed to us, and the GPU may
+	// write into what is imported
+	const std::uintptr_t Address
+		= reinterpret_cast<std::uintptr_t>(HostPointer);
+	if( (Address % Alignment) != 0 || (Size % Alignment) != 0 )
+	{
+		return std::nullopt;
+	}
+
+	// Get the memory types that this host pointer may be imported as
+	vk::MemoryHostPointerPropertiesEXT HostPointerProperties = {};
+	if( auto PropertiesResult = Device.getMemoryHostPointerPropertiesEXT(
+			vk::ExternalMemoryHandleTypeFlagBits::eHostAllocationEXT,
+			HostPointer, Dispatcher
+		);
+		PropertiesResult.result == vk::Result::eSuccess )
 	{
-		NewImageDeviceMemory = std::move(NewDeviceMemory.value());
+		HostPointerProperties = PropertiesResult.value;
 	}
 	else
 	{
-		return std::nullopt; // Error allocating device memory
+		// Host pointer can not be imported
+		return std::nullopt;
+	}
+
+	// Create the buffer object
+	vk::StructureChain<vk::BufferCreateInfo, vk::ExternalMemoryBufferCreateInfo>
+		NewBufferInfo;
+
+	NewBufferInfo.get<vk::BufferCreateInfo>() = {
+		.size        = Size,
+		.usage       = Usage,
+		.sharingMode = vk::SharingMode::eExclusive,
+	};
+
+	NewBufferInfo.get<vk::ExternalMemoryBufferCreateInfo>() = {
+		.handleTypes = vk::ExternalMemoryHandleTypeFlagBits::eHostAllocationEXT,
+	};
+
+	vk::UniqueBuffer NewBuffer = {};
+
+	if( auto BufferResult
+		= Device.createBufferUnique(NewBufferInfo.get<vk::BufferCreateInfo>());
+		BufferResult.result == vk::Result::eSuccess )
+	{
+		NewBuffer = std::move(BufferResult.value);
+	}
+	else
+	{
+		// Error creating buffer
+		return std::nullopt;
+	}
+
+	// Get buffer memory requirements
+	const vk::MemoryRequirements NewBufferRequirements
+		= Device.getBufferMemoryRequirements(NewBuffer.get());
+
+	// The buffer can not require more memory than what we are importing
+	if( NewBufferRequirements.size > Size )
+	{
+		return std::nullopt;
+	}
+
+	// Imported memory must be host-coherent, since it is never mapped and so
+	// can never be flushed or invalidated
+	const auto BufferMemoryIndex = FindMemoryTypeIndex(
+		PhysicalDevice,
+		NewBufferRequirements.memoryTypeBits
+			& HostPointerProperties.memoryTypeBits,
+		vk::MemoryPropertyFlagBits::eHostCoherent
+	);
+
+	if( BufferMemoryIndex < 0 )
+		return std::nullopt;
+
+	vk::StructureChain<
+		vk::MemoryAllocateInfo, vk::ImportMemoryHostPointerInfoEXT>
+		AllocSettings;
+
+	AllocSettings.get<vk::MemoryAllocateInfo>() = {
+		.allocationSize  = Size,
+		.memoryTypeIndex = std::uint32_t(BufferMemoryIndex),
+	};
+
+	AllocSettings.get<vk::ImportMemoryHostPointerInfoEXT>() = {
+		.handleType
+		= vk::ExternalMemoryHandleTypeFlagBits::eHostAllocationEXT,
+		.pHostPointer = HostPointer,
+	};
+
+	vk::UniqueDeviceMemory NewBufferDeviceMemory{};
+	if( auto AllocResult = Device.allocateMemoryUnique(AllocSettings.get());
+		AllocResult.result == vk::Result::eSuccess )
+	{
+		NewBufferDeviceMemory = std::move(AllocResult.value);
+	}
+	else
+	{
+		// Error importing host memory
+		return std::nullopt;
 	}
 
-	if( auto BindResult
-		= Device.bindImageMemory(NewImage.get(), NewImageDeviceMemory.get(), 0);
+	if( auto BindResult = Device.bindBufferMemory(
+			NewBuffer.get(), NewBufferDeviceMemory.get(), 0
+		);
 		BindResult != vk::Result::eSuccess )
 	{
-		// Error binding image object to device memory
+		// Error binding buffer object to device memory
 		return std::nullopt;
 	}
+
 	return std::make_tuple(
-		std::move(NewImage), std::move(NewImageDeviceMemory)
+		std::move(NewBuffer), std::move(NewBufferDeviceMemory)
 	);
 }
 
@@ -251,6 +360,146 @@ vk::MemoryHeap GetLargestPhysicalDeviceHeap(
 	return PhysicalDeviceMemoryProperties.memoryHeaps[HeapIndex];
 }
 
+MemoryTopology ClassifyMemoryTopology(const vk::PhysicalDevice& PhysicalDevice)
+{
+	const vk::PhysicalDeviceProperties PhysicalDeviceProperties
+		= PhysicalDevice.getProperties();
+	const vk::PhysicalDeviceMemoryProperties PhysicalDeviceMemoryProperties
+		= PhysicalDevice.getMemoryProperties();
+
+	static constexpr vk::MemoryPropertyFlags HostVisibleDeviceLocal
+		= vk::MemoryPropertyFlagBits::eDeviceLocal
+		| vk::MemoryPropertyFlagBits::eHostVisible;
+
+	// Traditionally, the BAR window that the host can map device-local memory
+	// through is 256MiB. Anything larger than that has been resized
+	static constexpr vk::DeviceSize BarWindowSize = 256ull * 1024 * 1024;
+
+	// Find out which heaps have host-visible, device-local memory types and
+	// how large the largest of those heaps is
+	std::array<bool, VK_MAX_MEMORY_HEAPS> HeapHostVisible = {};
+	vk::DeviceSize                        HostVisibleSize = 0;
+	for( std::size_t i = 0; i < PhysicalDeviceMemoryProperties.memoryTypeCount;
+		 ++i )
+	{
+		const vk::MemoryType& CurType
+			= PhysicalDeviceMemoryProperties.memoryTypes[i];
+		if( (CurType.propertyFlags & HostVisibleDeviceLocal)
+			== HostVisibleDeviceLocal )
+		{
+			const vk::MemoryHeap& CurHeap
+				= PhysicalDeviceMemoryProperties.memoryHeaps[CurType.heapIndex];
+			HeapHostVisible[CurType.heapIndex] = true;
+			HostVisibleSize = std::max(HostVisibleSize, CurHeap.size);
+		}
+	}
+
+	// Every device-local heap must be reachable by the host
+	bool AllHostVisible = true;
+	for( std::size_t i = 0; i < PhysicalDeviceMemoryProperties.memoryHeapCount;
+		 ++i )
+	{
+		if( (PhysicalDeviceMemoryProperties.memoryHeaps[i].flags
+			 & vk::MemoryHeapFlagBits::eDeviceLocal)
+			&& !HeapHostVisible[i] )
+		{
+			AllHostVisible = false;
+		}
+	}
+
+	// Discrete GPUs with resizable BAR will also have all of their device-local
+	// memory be host-visible, but it is still on the other side of the bus
+	if( PhysicalDeviceProperties.deviceType
+			== vk::PhysicalDeviceType::eIntegratedGpu
+		|| PhysicalDeviceProperties.deviceType == vk::PhysicalDeviceType::eCpu
+		|| (AllHostVisible
+			&& PhysicalDeviceProperties.deviceType
+				   != vk::PhysicalDeviceType::eDiscreteGpu) )
+	{
+		return MemoryTopology::Unified;
+	}
+
+	if( HostVisibleSize > BarWindowSize )
+	{
+		return MemoryTopology::ResizableBar;
+	}
+
+	return MemoryTopology::Discrete;
+}
+
+// Copies rows between host memory and a mapped linear image
+// When `Write` is set, the rows are copied into the image, otherwise out of it
+static bool CopyLinearImageRows(
+	vk::Device Device, vk::Image Image, const MemoryAllocation& Memory,
+	std::byte* HostData, std::size_t HostRowPitch, std::size_t RowSize,
+	std::uint32_t RowCount, bool Write
+)
+{
+	const vk::SubresourceLayout ImageLayout = Device.getImageSubresourceLayout(
+		Image, vk::ImageSubresource{
+				   .aspectMask = vk::ImageAspectFlagBits::eColor,
+				   .mipLevel   = 0,
+				   .arrayLayer = 0,
+			   }
+	);
+
+	// The image's memory stays mapped for as long as it is alive
+	if( !Memory.GetMapping() )
+	{
+		// Image memory is not host-visible
+		return false;
+	}
+	std::byte* const ImageData = Memory.GetMapping() + ImageLayout.offset;
+
+	// When both sides are tightly packed in the same way, it's just one copy
+	if( HostRowPitch == ImageLayout.rowPitch )
+	{
+		if( Write )
+			std::memcpy(ImageData, HostData, HostRowPitch * RowCount);
+		else
+			std::memcpy(HostData, ImageData, HostRowPitch * RowCount);
+	}
+	else
+	{
+		for( std::uint32_t CurRow = 0; CurRow < RowCount; ++CurRow )
+		{
+			std::byte* const HostRow  = HostData + HostRowPitch * CurRow;
+			std::byte* const ImageRow = ImageData + ImageLayout.rowPitch * CurRow;
+			if( Write )
+				std::memcpy(ImageRow, HostRow, RowSize);
+			else
+				std::memcpy(HostRow, ImageRow, RowSize);
+		}
+	}
+
+	return true;
+}
+
+bool WriteLinearImage(
+	vk::Device Device, vk::Image Image, const MemoryAllocation& Memory,
+	const void* Source, std::size_t SourceRowPitch, std::size_t RowSize,
+	std::uint32_t RowCount
+)
+{
+	return CopyLinearImageRows(
+		Device, Image, Memory,
+		static_cast<std::byte*>(const_cast<void*>(Source)), SourceRowPitch,
+		RowSize, RowCount, true
+	);
+}
+
+bool ReadLinearImage(
+	vk::Device Device, vk::Image Image, const MemoryAllocation& Memory,
+	void* Destination, std::size_t DestinationRowPitch, std::size_t RowSize,
+	std::uint32_t RowCount
+)
+{
+	return CopyLinearImageRows(
+		Device, Image, Memory, static_cast<std::byte*>(Destination),
+		DestinationRowPitch, RowSize, RowCount, false
+	);
+}
+
 // This function will be called whenever the Vulkan backend has something to say
 // about what you are doing How ever you want to handle this, implement it here.
 // For now, I put an "ASSERT" whenever there is a warning or error
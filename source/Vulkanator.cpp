@@ -5,8 +5,17 @@
 #include <cstdint>
 
 #include <array>
+#include <cstdlib>
+#include <deque>
+#include <limits>
+#include <memory>
+#include <mutex>
 #include <span>
+#include <string_view>
+#include <thread>
+#include <utility>
 
+#include <AEFX_SuiteHelper.h>
 #include <AEGP_SuiteHandler.h>
 #include <AE_EffectCB.h>
 #include <AE_EffectCBSuites.h>
@@ -21,6 +30,30 @@ auto DataFS = cmrc::Vulkanator::get_filesystem();
 #include <VulkanUtils.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 
+// Memory properties of staging buffers that the host reads from or writes into
+// in any order, and of those that the host only ever writes sequentially
+static constexpr vk::MemoryPropertyFlags CachedStagingProperties
+	= vk::MemoryPropertyFlagBits::eHostCached
+	| vk::MemoryPropertyFlagBits::eHostCoherent;
+static constexpr vk::MemoryPropertyFlags WriteCombinedStagingProperties
+	= vk::MemoryPropertyFlagBits::eDeviceLocal
+	| vk::MemoryPropertyFlagBits::eHostVisible
+	| vk::MemoryPropertyFlagBits::eHostCoherent;
+
+// The staging rings are created upon the first render, sized to hold this many
+// frames of that render's size at full resolution, so that multi-frame
+// rendering does not block on the ring
+static constexpr vk::DeviceSize StagingRingFrames = 4;
+// A ring never takes up more than this fraction of what is left of the memory
+// heap that it is allocated from
+static constexpr vk::DeviceSize StagingRingHeapFraction = 8;
+// If a ring can not be allocated, it is halved until it can, down to this size
+static constexpr vk::DeviceSize MinStagingRingSize = 32ull * 1024 * 1024;
+
+// Seconds that a sequence may go without rendering before its caches are freed
+// See VULKANATOR_IDLE_TIMEOUT
+static constexpr std::uint64_t DefaultIdleTimeout = 120;
+
 PF_Err About(
 	PF_InData* in_data, PF_OutData* out_data, PF_ParamDef* params[],
 	PF_LayerDef* output
@@ -38,12 +71,60 @@ PF_Err About(
 		// Print some info about the currently used physical device
 		const vk::PhysicalDeviceProperties DeviceProperties
 			= GlobalParam->PhysicalDevice.getProperties();
+		const Vulkanator::SubmissionService::Statistics SubmitStats
+			= GlobalParam->Submitter.GetStatistics();
+		const std::uint64_t UploadTiles = GlobalParam->UploadStats.Tiles;
+		const std::uint64_t SkippedTiles
+			= GlobalParam->UploadStats.SkippedTiles;
+		const double        SkippedTilePercent
+			= UploadTiles ? 100.0 * double(SkippedTiles) / double(UploadTiles)
+						  : 0.0;
+		const Vulkanator::MemoryManager::Usage MemoryUsage
+			= GlobalParam->Memory.GetUsage();
+		// Object creations and descriptor writes of the render path per frame
+		const std::uint64_t RenderFrames = GlobalParam->SetupStats.Frames;
+		const double        SetupCallsPerFrame
+			= RenderFrames ? double(GlobalParam->SetupStats.Calls)
+							   / double(RenderFrames)
+						   : 0.0;
+		// Vulkan objects that the render path created per frame, which stays
+		// at zero once every cache has been warmed up
+		const double CreationsPerFrame
+			= RenderFrames ? double(GlobalParam->SetupStats.Creations)
+							   / double(RenderFrames)
+						   : 0.0;
+		// Recording time that re-used command buffers saved per frame
+		const double SavedRecordMicroseconds
+			= RenderFrames ? double(GlobalParam->ReuseStats.SavedNanoseconds)
+							   / double(RenderFrames) / 1000.0
+						   : 0.0;
+		// Time that the destruction thread spent freeing retired objects per
+		// frame, which renders would have spent otherwise
+		const Vulkanator::DestructionQueue::Statistics DestroyStats
+			= GlobalParam->Destruction.GetStatistics();
+		const double DestroyMicroseconds
+			= RenderFrames ? double(DestroyStats.DestroyTime.count())
+							   / double(RenderFrames) / 1000.0
+						   : 0.0;
 		suites.ANSICallbacksSuite1()->sprintf(
 			out_data->return_msg,
-			"Vulkanator\n(Build date: " __TIMESTAMP__
-			")\n"
-			"GPU: %.64s",
-			DeviceProperties.deviceName.data()
+			"Vulkanator (" __DATE__ ")\n"
+			"GPU: %.32s\n"
+			"Memory: %s\n"
+			"Transfer: %s\n"
+			"Submits/s: %.1f Batch: %.1f Rec: -%.0fus\n"
+			"Upload: %.0f MiB Skip: %.0f%% Stalls: %.0f\n"
+			"VRAM: %.0f/%.0f MiB Setup/f: %.1f New/f: %.2f Free: %.0fus",
+			DeviceProperties.deviceName.data(),
+			VulkanUtils::MemoryTopologyName(GlobalParam->Topology),
+			Vulkanator::TransferPlanName(GlobalParam->LastTransferPlan.load()),
+			SubmitStats.SubmitsPerSecond, SubmitStats.AverageBatchSize,
+			SavedRecordMicroseconds,
+			double(GlobalParam->UploadStats.Bytes) / (1024.0 * 1024.0),
+			SkippedTilePercent, double(SubmitStats.Stalls),
+			double(MemoryUsage.Used) / (1024.0 * 1024.0),
+			double(MemoryUsage.Budget) / (1024.0 * 1024.0), SetupCallsPerFrame,
+			CreationsPerFrame, DestroyMicroseconds
 		);
 
 		suites.HandleSuite1()->host_unlock_handle(in_data->global_data);
@@ -65,9 +146,12 @@ PF_Err GlobalSetup(
 	out_data->my_version = PF_VERSION(1, 0, 0, PF_Stage_DEVELOP, 1);
 
 	out_data->out_flags  = PF_OutFlag_DEEP_COLOR_AWARE;
+	// Frames of the same sequence may render concurrently, each within a render
+	// context of its own. See RenderContextPool
 	out_data->out_flags2 = PF_OutFlag2_PARAM_GROUP_START_COLLAPSED_FLAG
 						 | PF_OutFlag2_SUPPORTS_SMART_RENDER
-						 | PF_OutFlag2_FLOAT_COLOR_AWARE;
+						 | PF_OutFlag2_FLOAT_COLOR_AWARE
+						 | PF_OutFlag2_SUPPORTS_THREADED_RENDERING;
 
 	// Allocate global handle
 	const PF_Handle GlobalDataHandle = suites.HandleSuite1()->host_new_handle(
@@ -233,15 +317,61 @@ PF_Err GlobalSetup(
 	// Found our most-ideal GPU!
 	GlobalParam->PhysicalDevice = PhysicalDevices.at(0);
 
-	// Allocate a graphics queue
+	// Find the queue families that we will be dispatching work into
+	const std::vector<vk::QueueFamilyProperties> QueueFamilies
+		= GlobalParam->PhysicalDevice.getQueueFamilyProperties();
+
+	// Index 0 tends to be the generic Graphics | Compute | Copy queue
+	GlobalParam->GraphicsQueueFamily = 0;
+	for( std::uint32_t i = 0; i < QueueFamilies.size(); ++i )
+	{
+		if( QueueFamilies[i].queueFlags & vk::QueueFlagBits::eGraphics )
+		{
+			GlobalParam->GraphicsQueueFamily = i;
+			break;
+		}
+	}
+
+	// A transfer-only queue family tends to map to the device's copy engines,
+	// which can stream frames in and out while the graphics queue renders
+	// Uploads and readbacks copy sub-regions of images, so the family must be
+	// able to address individual texels
+	for( std::uint32_t i = 0; i < QueueFamilies.size(); ++i )
+	{
+		const vk::QueueFamilyProperties& CurFamily = QueueFamilies[i];
+		if( (CurFamily.queueFlags & vk::QueueFlagBits::eTransfer)
+			&& !(CurFamily.queueFlags & vk::QueueFlagBits::eGraphics)
+			&& !(CurFamily.queueFlags & vk::QueueFlagBits::eCompute)
+			&& CurFamily.minImageTransferGranularity
+				   == vk::Extent3D{.width = 1, .height = 1, .depth = 1} )
+		{
+			GlobalParam->TransferQueueFamily    = i;
+			GlobalParam->DedicatedTransferQueue = true;
+			break;
+		}
+	}
+
+	// Allocate a graphics queue, and a transfer queue if there is one
 	std::vector<vk::DeviceQueueCreateInfo> QueueInfos{};
 
 	{
 		static glm::f32 QueuePriority = 0.0f;
 
 		const vk::DeviceQueueCreateInfo CurQueueInfo = {
-			// Index 0 tends to be the generic Graphics | Compute | Copy queue
-			.queueFamilyIndex = 0,
+			.queueFamilyIndex = GlobalParam->GraphicsQueueFamily,
+			.queueCount       = 1,
+			.pQueuePriorities = &QueuePriority,
+		};
+
+		QueueInfos.emplace_back(CurQueueInfo);
+	}
+
+	if( GlobalParam->DedicatedTransferQueue )
+	{
+		static glm::f32 QueuePriority = 0.0f;
+
+		const vk::DeviceQueueCreateInfo CurQueueInfo = {
+			.queueFamilyIndex = GlobalParam->TransferQueueFamily,
 			.queueCount       = 1,
 			.pQueuePriorities = &QueuePriority,
 		};
@@ -249,14 +379,314 @@ PF_Err GlobalSetup(
 		QueueInfos.emplace_back(CurQueueInfo);
 	}
 
+	// Probe for optional device extensions
+	std::vector<vk::ExtensionProperties> DeviceExtensionProperties;
+
+	if( auto EnumerateResult
+		= GlobalParam->PhysicalDevice.enumerateDeviceExtensionProperties();
+		EnumerateResult.result == vk::Result::eSuccess )
+	{
+		DeviceExtensionProperties = EnumerateResult.value;
+	}
+	else
+	{
+		// Error iterating device extensions
+		return PF_Err_INTERNAL_STRUCT_DAMAGED;
+	}
+
+	const auto HasDeviceExtension
+		= [&](std::string_view ExtensionName) -> bool {
+		return std::any_of(
+			DeviceExtensionProperties.begin(), DeviceExtensionProperties.end(),
+			[&](const vk::ExtensionProperties& CurExtension) -> bool {
+				return ExtensionName == CurExtension.extensionName.data();
+			}
+		);
+	};
+
+	std::vector<const char*> DeviceExtensions = {};
+
+	// Allows After Effects' own pixel buffers to be imported as vk::Buffers
+	// so that the GPU can copy directly from and into them
+	if( HasDeviceExtension(VK_EXT_EXTERNAL_MEMORY_HOST_EXTENSION_NAME) )
+	{
+		DeviceExtensions.emplace_back(VK_EXT_EXTERNAL_MEMORY_HOST_EXTENSION_NAME
+		);
+
+		const auto DeviceProperties
+			= GlobalParam->PhysicalDevice.getProperties2<
+				vk::PhysicalDeviceProperties2,
+				vk::PhysicalDeviceExternalMemoryHostPropertiesEXT>();
+
+		GlobalParam->Features.ExternalMemoryHost = true;
+		GlobalParam->Features.MinImportedHostPointerAlignment
+			= DeviceProperties
+				  .get<vk::PhysicalDeviceExternalMemoryHostPropertiesEXT>()
+				  .minImportedHostPointerAlignment;
+	}
+
+	// Reports how much memory the process may use before the driver starts
+	// paging it out, which the memory manager keeps the caches within
+	if( HasDeviceExtension(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME) )
+	{
+		DeviceExtensions.emplace_back(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+		GlobalParam->Features.MemoryBudget = true;
+	}
+
+	// Allows the input image to be pushed right into the command buffer,
+	// rather than having to allocate and write a descriptor set
+	if( HasDeviceExtension(VK_KHR_PUSH_DESCRIPTOR_EXTENSION_NAME) )
+	{
+		DeviceExtensions.emplace_back(VK_KHR_PUSH_DESCRIPTOR_EXTENSION_NAME);
+		GlobalParam->Features.PushDescriptor = true;
+	}
+
+	// Allows the submission service to track the completion of every request
+	// with a timeline semaphore of its queue, which render threads may poll
+	// and wait on directly. Core in Vulkan 1.2, but the instance only asks for
+	// 1.1. Without it, each batch signals a fence instead
+	if( HasDeviceExtension(VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME)
+		&& GlobalParam->PhysicalDevice
+			   .getFeatures2<
+				   vk::PhysicalDeviceFeatures2,
+				   vk::PhysicalDeviceTimelineSemaphoreFeatures>()
+			   .get<vk::PhysicalDeviceTimelineSemaphoreFeatures>()
+			   .timelineSemaphore )
+	{
+		DeviceExtensions.emplace_back(VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME
+		);
+		GlobalParam->Features.TimelineSemaphore = true;
+	}
+
+	// Allows the CPU to write and read images directly, rather than going
+	// through a staging buffer and a pair of GPU-side copies
+	// Only used if all of our render formats support it without penalizing
+	// device-side access
+	const bool HostImageCopySupported = [&]() -> bool {
+		if( !HasDeviceExtension(VK_EXT_HOST_IMAGE_COPY_EXTENSION_NAME)
+			|| !HasDeviceExtension(VK_KHR_COPY_COMMANDS_2_EXTENSION_NAME)
+			|| !HasDeviceExtension(VK_KHR_FORMAT_FEATURE_FLAGS_2_EXTENSION_NAME
+			) )
+		{
+			return false;
+		}
+
+		const auto DeviceFeatures = GlobalParam->PhysicalDevice.getFeatures2<
+			vk::PhysicalDeviceFeatures2,
+			vk::PhysicalDeviceHostImageCopyFeaturesEXT>();
+		if( !DeviceFeatures.get<vk::PhysicalDeviceHostImageCopyFeaturesEXT>()
+				 .hostImageCopy )
+		{
+			return false;
+		}
+
+		for( const vk::Format& CurFormat : VulkanUtils::RenderFormats )
+		{
+			const auto FormatProperties
+				= GlobalParam->PhysicalDevice.getFormatProperties2<
+					vk::FormatProperties2, vk::FormatProperties3>(CurFormat);
+			if( !(FormatProperties.get<vk::FormatProperties3>()
+					  .optimalTilingFeatures
+				  & vk::FormatFeatureFlagBits2::eHostImageTransferEXT) )
+			{
+				return false;
+			}
+
+			const vk::PhysicalDeviceImageFormatInfo2 ImageFormatInfo = {
+				.format = CurFormat,
+				.type   = vk::ImageType::e2D,
+				.tiling = vk::ImageTiling::eOptimal,
+				.usage  = vk::ImageUsageFlagBits::eTransferSrc
+					   | vk::ImageUsageFlagBits::eSampled
+					   | vk::ImageUsageFlagBits::eColorAttachment
+					   | vk::ImageUsageFlagBits::eHostTransferEXT,
+			};
+			const auto ImageFormatResult
+				= GlobalParam->PhysicalDevice.getImageFormatProperties2<
+					vk::ImageFormatProperties2,
+					vk::HostImageCopyDevicePerformanceQueryEXT>(
+					ImageFormatInfo
+				);
+			if( ImageFormatResult.result != vk::Result::eSuccess
+				|| !ImageFormatResult.value
+						.get<vk::HostImageCopyDevicePerformanceQueryEXT>()
+						.optimalDeviceAccess )
+			{
+				return false;
+			}
+		}
+		return true;
+	}();
+
+	if( HostImageCopySupported )
+	{
+		DeviceExtensions.emplace_back(VK_EXT_HOST_IMAGE_COPY_EXTENSION_NAME);
+		DeviceExtensions.emplace_back(VK_KHR_COPY_COMMANDS_2_EXTENSION_NAME);
+		DeviceExtensions.emplace_back(
+			VK_KHR_FORMAT_FEATURE_FLAGS_2_EXTENSION_NAME
+		);
+
+		// Find out which image layouts the host is able to copy into and out
+		// of, preferring the layouts that the images are already in
+		std::array<vk::ImageLayout, 64> CopySrcLayouts = {};
+		std::array<vk::ImageLayout, 64> CopyDstLayouts = {};
+
+		vk::StructureChain<
+			vk::PhysicalDeviceProperties2,
+			vk::PhysicalDeviceHostImageCopyPropertiesEXT>
+			DeviceProperties;
+
+		auto& HostImageCopyProperties
+			= DeviceProperties.get<vk::PhysicalDeviceHostImageCopyPropertiesEXT>();
+		HostImageCopyProperties.copySrcLayoutCount
+			= std::uint32_t(CopySrcLayouts.size());
+		HostImageCopyProperties.pCopySrcLayouts = CopySrcLayouts.data();
+		HostImageCopyProperties.copyDstLayoutCount
+			= std::uint32_t(CopyDstLayouts.size());
+		HostImageCopyProperties.pCopyDstLayouts = CopyDstLayouts.data();
+
+		GlobalParam->PhysicalDevice.getProperties2(
+			&DeviceProperties.get<vk::PhysicalDeviceProperties2>()
+		);
+
+		const std::span<const vk::ImageLayout> SrcLayouts(
+			CopySrcLayouts.data(), HostImageCopyProperties.copySrcLayoutCount
+		);
+		const std::span<const vk::ImageLayout> DstLayouts(
+			CopyDstLayouts.data(), HostImageCopyProperties.copyDstLayoutCount
+		);
+
+		// The input image will be sampled from right after the upload
+		GlobalParam->Features.HostImageUploadLayout
+			= std::find(
+				  DstLayouts.begin(), DstLayouts.end(),
+				  vk::ImageLayout::eShaderReadOnlyOptimal
+			  ) != DstLayouts.end()
+				? vk::ImageLayout::eShaderReadOnlyOptimal
+				: vk::ImageLayout::eGeneral;
+
+		// The render pass leaves the output image in transfer-src layout
+		GlobalParam->Features.HostImageReadbackLayout
+			= std::find(
+				  SrcLayouts.begin(), SrcLayouts.end(),
+				  vk::ImageLayout::eTransferSrcOptimal
+			  ) != SrcLayouts.end()
+				? vk::ImageLayout::eTransferSrcOptimal
+				: vk::ImageLayout::eGeneral;
+
+		GlobalParam->Features.HostImageCopy = true;
+	}
+
+	// Find out how the device's memory is laid out relative to the host. This
+	// decides which transfer plans are worth using for each frame
+	GlobalParam->Topology
+		= VulkanUtils::ClassifyMemoryTopology(GlobalParam->PhysicalDevice);
+
+	// When the device and host share the same memory, the GPU may sample from
+	// and render into linear images that the CPU writes and reads directly
+	if( GlobalParam->Topology == VulkanUtils::MemoryTopology::Unified )
+	{
+		static constexpr vk::FormatFeatureFlags LinearImageFeatures
+			= vk::FormatFeatureFlagBits::eSampledImage
+			| vk::FormatFeatureFlagBits::eSampledImageFilterLinear
+			| vk::FormatFeatureFlagBits::eColorAttachment;
+
+		for( std::size_t i = 0; i < VulkanUtils::RenderFormats.size(); ++i )
+		{
+			const vk::FormatProperties FormatProperties
+				= GlobalParam->PhysicalDevice.getFormatProperties(
+					VulkanUtils::RenderFormats[i]
+				);
+			if( (FormatProperties.linearTilingFeatures & LinearImageFeatures)
+				!= LinearImageFeatures )
+			{
+				continue;
+			}
+
+			if( auto ImageFormatResult
+				= GlobalParam->PhysicalDevice.getImageFormatProperties(
+					VulkanUtils::RenderFormats[i], vk::ImageType::e2D,
+					vk::ImageTiling::eLinear,
+					vk::ImageUsageFlagBits::eSampled
+						| vk::ImageUsageFlagBits::eColorAttachment
+						| vk::ImageUsageFlagBits::eTransferSrc,
+					{}
+				);
+				ImageFormatResult.result == vk::Result::eSuccess )
+			{
+				GlobalParam->Features.LinearImageMaxExtent[i]
+					= ImageFormatResult.value.maxExtent;
+			}
+		}
+	}
+
+	// Frames that are larger than what the device can fit into a single image,
+	// or that would take up too much of its memory, are rendered in tiles
+	const vk::PhysicalDeviceLimits DeviceLimits
+		= GlobalParam->PhysicalDevice.getProperties().limits;
+	GlobalParam->MaxImageDimension = std::min(
+		{DeviceLimits.maxImageDimension2D, DeviceLimits.maxFramebufferWidth,
+		 DeviceLimits.maxFramebufferHeight,
+		 DeviceLimits.maxViewportDimensions[0],
+		 DeviceLimits.maxViewportDimensions[1]}
+	);
+	// Other render threads, and After Effects itself, will be using the device
+	// at the same time, so only a fraction of its memory is budgeted for
+	GlobalParam->ImageMemoryBudget
+		= VulkanUtils::GetLargestPhysicalDeviceHeap(GlobalParam->PhysicalDevice)
+			  .size
+		/ 4;
+	// Input textures that are not in use are kept around within the same
+	// budget
+	GlobalParam->Textures.SetBudget(GlobalParam->ImageMemoryBudget);
+
+	// Rendered frames are only cached on disk when asked for. The size of the
+	// cache is given in MiB
+	if( const char* ResultCacheDirectory
+		= std::getenv("VULKANATOR_RENDER_CACHE");
+		ResultCacheDirectory && *ResultCacheDirectory )
+	{
+		std::uint64_t ResultCacheSize = 4096;
+		if( const char* ResultCacheSizeString
+			= std::getenv("VULKANATOR_RENDER_CACHE_SIZE");
+			ResultCacheSizeString )
+		{
+			ResultCacheSize = std::strtoull(ResultCacheSizeString, nullptr, 10);
+		}
+		GlobalParam->Results.Open(
+			ResultCacheDirectory, ResultCacheSize * 1024 * 1024
+		);
+	}
+
 	// Create Logical Device
+	// Features are enabled by chaining their structures after the create info
+	vk::PhysicalDeviceTimelineSemaphoreFeatures TimelineSemaphoreFeatures = {
+		.timelineSemaphore = VK_TRUE,
+	};
+	vk::PhysicalDeviceHostImageCopyFeaturesEXT HostImageCopyFeatures = {
+		.hostImageCopy = VK_TRUE,
+	};
+
+	void* DeviceFeatureChain = nullptr;
+	if( GlobalParam->Features.TimelineSemaphore )
+	{
+		TimelineSemaphoreFeatures.pNext = DeviceFeatureChain;
+		DeviceFeatureChain              = &TimelineSemaphoreFeatures;
+	}
+	if( GlobalParam->Features.HostImageCopy )
+	{
+		HostImageCopyFeatures.pNext = DeviceFeatureChain;
+		DeviceFeatureChain          = &HostImageCopyFeatures;
+	}
+
 	const vk::DeviceCreateInfo DeviceInfo = {
+		.pNext                   = DeviceFeatureChain,
 		.queueCreateInfoCount    = std::uint32_t(QueueInfos.size()),
 		.pQueueCreateInfos       = QueueInfos.data(),
 		.enabledLayerCount       = 0u,
 		.ppEnabledLayerNames     = nullptr,
-		.enabledExtensionCount   = 0u,
-		.ppEnabledExtensionNames = nullptr,
+		.enabledExtensionCount   = std::uint32_t(DeviceExtensions.size()),
+		.ppEnabledExtensionNames = DeviceExtensions.data(),
 	};
 
 	if( auto DeviceResult
@@ -277,26 +707,14 @@ PF_Err GlobalSetup(
 		GlobalParam->Device.get(), ::vkGetDeviceProcAddr
 	);
 
-	// Create CommandPool
-	const vk::CommandPoolCreateInfo CommandPoolInfo = {
-		.flags            = vk::CommandPoolCreateFlagBits::eResetCommandBuffer,
-		.queueFamilyIndex = 0,
-	};
-
-	if( auto CommandPoolResult
-		= GlobalParam->Device->createCommandPoolUnique(CommandPoolInfo);
-		CommandPoolResult.result == vk::Result::eSuccess )
-	{
-		GlobalParam->CommandPool = std::move(CommandPoolResult.value);
-	}
-	else
-	{
-		// Error creating command pool
-		return PF_Err_INTERNAL_STRUCT_DAMAGED;
-	}
-
-	// Get queue that we will be dispatching work into
-	GlobalParam->Queue = GlobalParam->Device->getQueue(0, 0);
+	// Buffers and images are sub-allocated out of larger blocks of memory
+	GlobalParam->Allocator.Initialize(
+		GlobalParam->Device.get(), GlobalParam->PhysicalDevice
+	);
+	GlobalParam->Memory.Initialize(
+		GlobalParam->PhysicalDevice, GlobalParam->Allocator,
+		GlobalParam->Features.MemoryBudget
+	);
 
 	for( std::size_t i = 0; i < GlobalParam->RenderPasses.size(); ++i )
 	{
@@ -414,40 +832,62 @@ PF_Err GlobalSetup(
 		return PF_Err_INTERNAL_STRUCT_DAMAGED;
 	}
 
+	///// Samplers
+
+	// Renders pick one of these by the quality setting, rather than creating
+	// a sampler of their own every frame
+	static constexpr vk::Filter InputImageSamplerFilters[] = {
+		vk::Filter::eNearest,
+		vk::Filter::eLinear,
+	};
+	for( std::size_t i = 0; i < GlobalParam->InputImageSamplers.size(); ++i )
+	{
+		const vk::SamplerCreateInfo InputImageSamplerInfo = {
+			.magFilter    = InputImageSamplerFilters[i],
+			.minFilter    = InputImageSamplerFilters[i],
+			.addressModeU = vk::SamplerAddressMode::eClampToEdge,
+			.addressModeV = vk::SamplerAddressMode::eClampToEdge,
+			.addressModeW = vk::SamplerAddressMode::eClampToEdge,
+		};
+
+		if( auto SamplerResult
+			= GlobalParam->Device->createSamplerUnique(InputImageSamplerInfo);
+			SamplerResult.result == vk::Result::eSuccess )
+		{
+			GlobalParam->InputImageSamplers[i] = std::move(SamplerResult.value);
+		}
+		else
+		{
+			// Error creating sampler object
+			return PF_Err_INTERNAL_STRUCT_DAMAGED;
+		}
+	}
+
 	///// Descriptor Pool
 
-	// Here we describe how large the pool should be for each descriptor
-	// type these should be resonably large such that it won't take up too
-	// much memory but will generally contain the "worst case" In this case,
-	// we are allocating a single descriptor set for each instance of the
-	// effect so 512 should be more than enough. If you add more descriptor
-	// types, then you will have to add to this poolsize
+	// Here we describe how large each pool of the chain should be for each
+	// descriptor type. We are allocating a single descriptor set for each
+	// render context, so each pool holds as many of each descriptor type as it
+	// holds descriptor sets. Another pool is added to the chain whenever these
+	// run out. If you add more descriptor types, then you will have to add to
+	// this poolsize
+	// With push descriptors, no descriptor sets are ever allocated
+	static constexpr std::uint32_t DescriptorSetsPerPool = 256;
+
 	static vk::DescriptorPoolSize DescriptorPoolSizes[] = {
-		{
-			.type            = vk::DescriptorType::eUniformBuffer,
-			.descriptorCount = 512,
-		},
 		{
 			.type            = vk::DescriptorType::eCombinedImageSampler,
-			.descriptorCount = 512,
+			.descriptorCount = DescriptorSetsPerPool,
 		},
 	};
 
-	const vk::DescriptorPoolCreateInfo DescriptorPoolInfo = {
-		// Maximum number of total descriptor sets, upper bound
-		.maxSets = 1024,
-		// Maximum number of each individual descriptor type
-		.poolSizeCount = std::uint32_t(glm::countof(DescriptorPoolSizes)),
-		.pPoolSizes    = DescriptorPoolSizes,
-	};
-
-	if( auto DescriptorPoolResult
-		= GlobalParam->Device->createDescriptorPoolUnique(DescriptorPoolInfo);
-		DescriptorPoolResult.result == vk::Result::eSuccess )
-	{
-		GlobalParam->DescriptorPool = std::move(DescriptorPoolResult.value);
-	}
-	else
+	// Render threads each allocate out of their own shard of the chain, so
+	// that concurrent renders do not contend over a single pool's lock
+	if( !GlobalParam->Features.PushDescriptor
+		&& !GlobalParam->Descriptors.Initialize(
+			GlobalParam->Device.get(), DescriptorPoolSizes,
+			DescriptorSetsPerPool, std::thread::hardware_concurrency()
+		) )
 	{
 		// Error creating descriptor pool
 		return PF_Err_INTERNAL_STRUCT_DAMAGED;
@@ -460,18 +900,11 @@ PF_Err GlobalSetup(
 	static vk::DescriptorSetLayoutBinding DescriptorLayoutBindings[]
 
 		= {
-			// Binding 0 is a Uniform Buffer available to the any shader in the
-			// graphics pipeline
-			vk::DescriptorSetLayoutBinding{
-				.binding         = 0,
-				.descriptorType  = vk::DescriptorType::eUniformBuffer,
-				.descriptorCount = 1,
-				.stageFlags      = vk::ShaderStageFlagBits::eAllGraphics
-			},
-			// Binding 1 is a combined image sampler available to the fragment
+			// Binding 0 is a combined image sampler available to the fragment
 			// shader
+			// The uniforms are passed in as push constants instead
 			vk::DescriptorSetLayoutBinding{
-				.binding         = 1,
+				.binding         = 0,
 				.descriptorType  = vk::DescriptorType::eCombinedImageSampler,
 				.descriptorCount = 1,
 				.stageFlags      = vk::ShaderStageFlagBits::eFragment
@@ -480,8 +913,12 @@ PF_Err GlobalSetup(
 
 	// All of our shader bindings will now be packaged up into a single
 	// DescriptorSetLayout object
-	static vk::DescriptorSetLayoutCreateInfo DescriptorLayoutInfos = {
-		.flags        = {},
+	// With push descriptors, the set is pushed into the command buffer rather
+	// than allocated out of a pool
+	const vk::DescriptorSetLayoutCreateInfo DescriptorLayoutInfos = {
+		.flags = GlobalParam->Features.PushDescriptor
+				   ? vk::DescriptorSetLayoutCreateFlagBits::ePushDescriptorKHR
+				   : vk::DescriptorSetLayoutCreateFlags(),
 		.bindingCount = std::uint32_t(glm::countof(DescriptorLayoutBindings)),
 		.pBindings    = DescriptorLayoutBindings,
 	};
@@ -505,13 +942,23 @@ PF_Err GlobalSetup(
 	// Now, we describe the layout of the pipeline
 	// This is where you describe what descriptor sets and pushconstants
 	// and such that the shader will be consuming
+	// The uniforms are small enough to fit within the 128 bytes of push
+	// constants that every device supports, so they are recorded right into
+	// the command buffer rather than written into a buffer
+	static_assert(sizeof(Vulkanator::RenderParams::UniformParams) <= 128);
+	const vk::PushConstantRange UniformsRange = {
+		.stageFlags
+		= vk::ShaderStageFlagBits::eVertex | vk::ShaderStageFlagBits::eFragment,
+		.offset = 0,
+		.size   = sizeof(Vulkanator::RenderParams::UniformParams),
+	};
+
 	const vk::PipelineLayoutCreateInfo RenderPipelineLayoutInfo = {
 		.setLayoutCount = 1,
 		.pSetLayouts    = &GlobalParam->RenderDescriptorSetLayout.get(),
 
-		// This shader takes in no push constants
-		.pushConstantRangeCount = 0,
-		.pPushConstantRanges    = nullptr,
+		.pushConstantRangeCount = 1,
+		.pPushConstantRanges    = &UniformsRange,
 	};
 
 	if( auto RenderPipelineLayoutResult
@@ -704,27 +1151,32 @@ PF_Err GlobalSetup(
 	}
 
 	// Create quad vertex buffer
-	std::tie(GlobalParam->MeshBuffer, GlobalParam->MeshBufferMemory)
-		= VulkanUtils::AllocateBuffer(
-			  GlobalParam->Device.get(), GlobalParam->PhysicalDevice,
-			  Vulkanator::Quad.size() * sizeof(Vulkanator::Vertex),
-			  vk::BufferUsageFlagBits::eVertexBuffer,
-			  vk::MemoryPropertyFlagBits::eHostCached
-				  | vk::MemoryPropertyFlagBits::eHostCoherent
-		)
-			  .value();
+	if( auto MeshBufferResult = VulkanUtils::AllocateBuffer(
+			GlobalParam->Allocator,
+			Vulkanator::Quad.size() * sizeof(Vulkanator::Vertex),
+			vk::BufferUsageFlagBits::eVertexBuffer,
+			vk::MemoryPropertyFlagBits::eHostCached
+				| vk::MemoryPropertyFlagBits::eHostCoherent
+		);
+		MeshBufferResult.has_value() )
+	{
+		std::tie(GlobalParam->MeshBuffer, GlobalParam->MeshBufferMemory)
+			= std::move(MeshBufferResult.value());
+	}
+	else
+	{
+		// Error allocating vertex buffer
+		return PF_Err_OUT_OF_MEMORY;
+	}
 
 	// Write vertex buffer data in
-	if( auto MapResult = GlobalParam->Device->mapMemory(
-			GlobalParam->MeshBufferMemory.get(), 0, VK_WHOLE_SIZE
-		);
-		MapResult.result == vk::Result::eSuccess )
+	if( std::byte* const MeshData = GlobalParam->MeshBufferMemory.GetMapping();
+		MeshData )
 	{
 		std::memcpy(
-			MapResult.value, Vulkanator::Quad.data(),
+			MeshData, Vulkanator::Quad.data(),
 			Vulkanator::Quad.size() * sizeof(Vulkanator::Vertex)
 		);
-		GlobalParam->Device->unmapMemory(GlobalParam->MeshBufferMemory.get());
 	}
 	else
 	{
@@ -732,6 +1184,71 @@ PF_Err GlobalSetup(
 		return PF_Err_INTERNAL_STRUCT_DAMAGED;
 	}
 
+	// Threads are only started once nothing else is able to fail. After
+	// Effects frees the global handle of a failed setup without a setdown, so
+	// any thread that is still running by then would be left reading from
+	// freed memory
+
+	// Get the queues that we will be dispatching work into, and hand them over
+	// to the submission service
+	std::vector<vk::Queue> Queues = {
+		GlobalParam->Device->getQueue(GlobalParam->GraphicsQueueFamily, 0),
+	};
+	if( GlobalParam->DedicatedTransferQueue )
+	{
+		Queues.emplace_back(
+			GlobalParam->Device->getQueue(GlobalParam->TransferQueueFamily, 0)
+		);
+	}
+	if( !GlobalParam->Submitter.Start(
+			GlobalParam->Device.get(), Queues, GlobalParam->Dispatcher,
+			GlobalParam->Features.TimelineSemaphore
+		) )
+	{
+		// Error starting submission service
+		return PF_Err_INTERNAL_STRUCT_DAMAGED;
+	}
+
+	GlobalParam->Destruction.Start(GlobalParam->Submitter);
+	GlobalParam->Textures.SetDestructionQueue(&GlobalParam->Destruction);
+
+	// The caches of sequences that have not rendered for this long are freed.
+	// The timeout is given in seconds, and zero keeps the caches around until
+	// the device runs low on memory
+	std::uint64_t IdleTimeout = DefaultIdleTimeout;
+	if( const char* IdleTimeoutString = std::getenv("VULKANATOR_IDLE_TIMEOUT");
+		IdleTimeoutString )
+	{
+		IdleTimeout = std::strtoull(IdleTimeoutString, nullptr, 10);
+	}
+	if( IdleTimeout )
+	{
+		GlobalParam->Memory.StartReclaimer(std::chrono::seconds(IdleTimeout));
+	}
+
+	// Frames may be forced to use a single transfer plan, given by the name of
+	// the plan such as "HostImageCopy" or "CachedReadback"
+	if( const char* TransferPlanString
+		= std::getenv("VULKANATOR_TRANSFER_PLAN");
+		TransferPlanString )
+	{
+		static constexpr std::pair<std::string_view, Vulkanator::TransferPlan>
+			TransferPlanNames[] = {
+				{"DirectLinear", Vulkanator::TransferPlan::DirectLinear},
+				{"HostImageCopy", Vulkanator::TransferPlan::HostImageCopy},
+				{"WriteCombinedUpload",
+				 Vulkanator::TransferPlan::WriteCombinedUpload},
+				{"CachedReadback", Vulkanator::TransferPlan::CachedReadback},
+			};
+		for( const auto& [CurName, CurPlan] : TransferPlanNames )
+		{
+			if( CurName == TransferPlanString )
+			{
+				GlobalParam->ForcedTransferPlan = CurPlan;
+			}
+		}
+	}
+
 	return PF_Err_NONE;
 }
 
@@ -743,11 +1260,19 @@ PF_Err GlobalSetdown(
 	AEGP_SuiteHandler suites(in_data->pica_basicP);
 
 	// Lock global handle
-	if( auto GlobalParam
-		= reinterpret_cast<Vulkanator::GlobalParams*>(in_data->global_data);
-		GlobalParam )
+	if( in_data->global_data )
 	{
+		auto GlobalParam
+			= reinterpret_cast<Vulkanator::GlobalParams*>(*in_data->global_data);
+
 		// Global setdown stuff
+		// The reclaimer, destruction, and submission threads must be joined
+		// before the handle goes away
+		GlobalParam->Memory.StopReclaimer();
+		GlobalParam->Destruction.Stop();
+		GlobalParam->Submitter.Stop();
+		GlobalParam->Textures.Clear();
+
 		// GlobalParam->~GlobalParams();
 		// host_dispose_handle seems to call the deconstructor already? That's
 		// weird, but cool I guess
@@ -759,147 +1284,247 @@ PF_Err GlobalSetdown(
 	return PF_Err_NONE;
 }
 
-PF_Err SequenceSetup(
-	PF_InData* in_data, PF_OutData* out_data, PF_ParamDef* params[],
-	PF_LayerDef* output
-)
+// Counts a single setup call of the render path, along with the time spent
+// within it, for as long as this object is alive. `Creations` is the number
+// of Vulkan objects that the call creates
+struct CountedSetupCall
 {
-	AEGP_SuiteHandler suites(in_data->pica_basicP);
-
-	Vulkanator::GlobalParams* GlobalParam
-		= static_cast<Vulkanator::GlobalParams*>(
-			suites.HandleSuite1()->host_lock_handle(in_data->global_data)
-		);
+	Vulkanator::GlobalParams::SetupCallStatistics& Stats;
+	std::uint64_t                                  Creations = 0;
+	std::chrono::steady_clock::time_point          StartTime
+		= std::chrono::steady_clock::now();
 
-	// Cleanup previous sequence datas
-	if( auto SequenceParam
-		= reinterpret_cast<Vulkanator::SequenceParams*>(out_data->sequence_data
-		);
-		SequenceParam )
+	~CountedSetupCall()
+	{
+		const auto Elapsed = std::chrono::steady_clock::now() - StartTime;
+		++Stats.Calls;
+		Stats.Creations += Creations;
+		Stats.Nanoseconds
+			+= std::chrono::duration_cast<std::chrono::nanoseconds>(Elapsed)
+				   .count();
+	}
+};
+
+// Calls `Allocate`, making room for its allocation by freeing the caches of the
+// least recently rendered sequences first if the device is running low on
+// memory. If the allocation fails anyway, caches and then unused input
+// textures are freed one at a time until it succeeds or nothing is left
+// Returns an empty result if the device is truly out of memory
+template<typename AllocateFunction>
+auto AllocateWithEviction(
+	Vulkanator::GlobalParams& GlobalParam, AllocateFunction&& Allocate
+) -> decltype(Allocate())
+{
+	while( GlobalParam.Memory.IsUnderPressure()
+		   && GlobalParam.Memory.EvictOne() )
 	{
-		// Setdown sequence stuff
-		SequenceParam->~SequenceParams();
-		// Destroy handle
-		suites.HandleSuite1()->host_dispose_handle(out_data->sequence_data);
-		in_data->sequence_data = out_data->sequence_data = nullptr;
 	}
 
-	// Allocate new sequence data
-	const PF_Handle SequenceDataHandle = suites.HandleSuite1()->host_new_handle(
-		sizeof(Vulkanator::SequenceParams)
-	);
-
-	if( !SequenceDataHandle )
+	while( true )
 	{
-		return PF_Err_OUT_OF_MEMORY;
+		if( auto Result = Allocate(); Result )
+		{
+			return Result;
+		}
+
+		// Objects that were retired, and that the GPU is done with, are the
+		// cheapest to free
+		if( GlobalParam.Destruction.Flush() )
+		{
+			continue;
+		}
+
+		if( !GlobalParam.Memory.EvictOne() && !GlobalParam.Textures.EvictOne() )
+		{
+			return {};
+		}
 	}
+}
 
-	out_data->sequence_data = SequenceDataHandle;
+// Creates all of the per-thread state needed to render a single frame
+// Returns nullptr upon failure
+std::unique_ptr<Vulkanator::RenderContext>
+	CreateRenderContext(Vulkanator::GlobalParams& GlobalParam)
+{
+	auto Context = std::make_unique<Vulkanator::RenderContext>();
 
-	Vulkanator::SequenceParams* SequenceParam
-		= reinterpret_cast<Vulkanator::SequenceParams*>(*SequenceDataHandle);
-	// Setup data sequence stuff
-	// ...
-	new(SequenceParam) Vulkanator::SequenceParams();
+	// Every object of the render context is counted as a creation of a single
+	// call, as a render that has to create a render context is already rare
+	CountedSetupCall Counter{GlobalParam.SetupStats};
 
-	// Allocate Command Buffer
-	const vk::CommandBufferAllocateInfo CommandBufferInfo = {
-		.commandPool        = GlobalParam->CommandPool.get(),
-		.level              = vk::CommandBufferLevel::ePrimary,
-		.commandBufferCount = 1u,
+	// Create CommandPool
+	const vk::CommandPoolCreateInfo CommandPoolInfo = {
+		.flags            = vk::CommandPoolCreateFlagBits::eResetCommandBuffer,
+		.queueFamilyIndex = GlobalParam.GraphicsQueueFamily,
 	};
 
-	if( auto AllocResult
-		= GlobalParam->Device->allocateCommandBuffersUnique(CommandBufferInfo);
-		AllocResult.result == vk::Result::eSuccess )
+	if( auto CommandPoolResult
+		= GlobalParam.Device->createCommandPoolUnique(CommandPoolInfo);
+		CommandPoolResult.result == vk::Result::eSuccess )
 	{
-		SequenceParam->CommandBuffer = std::move(AllocResult.value.at(0));
+		Context->CommandPool = std::move(CommandPoolResult.value);
+		++Counter.Creations;
 	}
 	else
 	{
-		// Error allocating command buffer
-		return PF_Err_OUT_OF_MEMORY;
+		// Error creating command pool
+		return nullptr;
 	}
 
-	// Allocate Fence
+	// Allocate Command Buffers
+	// One for the render pass, and two more for the re-usable commands before
+	// and after it
+	const vk::CommandBufferAllocateInfo CommandBufferInfo = {
+		.commandPool        = Context->CommandPool.get(),
+		.level              = vk::CommandBufferLevel::ePrimary,
+		.commandBufferCount = 3u,
+	};
 
-	if( auto FenceResult = GlobalParam->Device->createFenceUnique({});
-		FenceResult.result == vk::Result::eSuccess )
+	if( auto AllocResult
+		= GlobalParam.Device->allocateCommandBuffersUnique(CommandBufferInfo);
+		AllocResult.result == vk::Result::eSuccess )
 	{
-		SequenceParam->Fence = std::move(FenceResult.value);
+		Context->CommandBuffer         = std::move(AllocResult.value.at(0));
+		Context->PrologueCommandBuffer = std::move(AllocResult.value.at(1));
+		Context->EpilogueCommandBuffer = std::move(AllocResult.value.at(2));
+		Counter.Creations += AllocResult.value.size();
 	}
 	else
 	{
-		// Error allocating fence
-		return PF_Err_OUT_OF_MEMORY;
+		// Error allocating command buffer
+		return nullptr;
 	}
 
-	// Allocate descriptor set
-
-	const vk::DescriptorSetAllocateInfo DescriptorAllocInfo = {
-		.descriptorPool     = GlobalParam->DescriptorPool.get(),
-		.descriptorSetCount = 1u,
-		.pSetLayouts        = &GlobalParam->RenderDescriptorSetLayout.get(),
-	};
-
-	if( auto DescriptorSetResult
-		= GlobalParam->Device->allocateDescriptorSetsUnique(DescriptorAllocInfo
-		);
-		DescriptorSetResult.result == vk::Result::eSuccess )
+	// With a dedicated transfer queue, uploads and readbacks get their own
+	// command buffers from a pool of the transfer queue's family
+	if( GlobalParam.DedicatedTransferQueue )
 	{
-		SequenceParam->DescriptorSet
-			= std::move(DescriptorSetResult.value.at(0));
-	}
-	else
-	{
-		// Error allocating descriptor set
-		return PF_Err_OUT_OF_MEMORY;
+		const vk::CommandPoolCreateInfo TransferCommandPoolInfo = {
+			.flags = vk::CommandPoolCreateFlagBits::eResetCommandBuffer,
+			.queueFamilyIndex = GlobalParam.TransferQueueFamily,
+		};
+
+		if( auto CommandPoolResult = GlobalParam.Device->createCommandPoolUnique(
+				TransferCommandPoolInfo
+			);
+			CommandPoolResult.result == vk::Result::eSuccess )
+		{
+			Context->TransferCommandPool = std::move(CommandPoolResult.value);
+			++Counter.Creations;
+		}
+		else
+		{
+			// Error creating command pool
+			return nullptr;
+		}
+
+		const vk::CommandBufferAllocateInfo TransferCommandBufferInfo = {
+			.commandPool        = Context->TransferCommandPool.get(),
+			.level              = vk::CommandBufferLevel::ePrimary,
+			.commandBufferCount = 2u,
+		};
+
+		if( auto AllocResult = GlobalParam.Device->allocateCommandBuffersUnique(
+				TransferCommandBufferInfo
+			);
+			AllocResult.result == vk::Result::eSuccess )
+		{
+			Context->UploadCommandBuffer   = std::move(AllocResult.value.at(0));
+			Context->ReadbackCommandBuffer = std::move(AllocResult.value.at(1));
+			Counter.Creations += AllocResult.value.size();
+		}
+		else
+		{
+			// Error allocating command buffer
+			return nullptr;
+		}
+
+		for( vk::UniqueSemaphore* CurSemaphore :
+			 {&Context->UploadSemaphore, &Context->RenderSemaphore} )
+		{
+			if( auto SemaphoreResult
+				= GlobalParam.Device->createSemaphoreUnique({});
+				SemaphoreResult.result == vk::Result::eSuccess )
+			{
+				*CurSemaphore = std::move(SemaphoreResult.value);
+				++Counter.Creations;
+			}
+			else
+			{
+				// Error creating semaphore
+				return nullptr;
+			}
+		}
 	}
 
-	// Allocate the actual uniform buffer
-	std::tie(SequenceParam->UniformBuffer, SequenceParam->UniformBufferMemory)
-		= VulkanUtils::AllocateBuffer(
-			  GlobalParam->Device.get(), GlobalParam->PhysicalDevice,
-			  sizeof(Vulkanator::RenderParams::Uniforms),
-			  vk::BufferUsageFlagBits::eUniformBuffer,
-			  vk::MemoryPropertyFlagBits::eHostCached
-				  | vk::MemoryPropertyFlagBits::eHostCoherent
-		)
-			  .value();
-
-	// This is used in a bit to describe what part of the buffer we are
-	// mapping to the descriptor set
-	const vk::DescriptorBufferInfo UniformBufferInfo = {
-		.buffer = SequenceParam->UniformBuffer.get(),
-		// The uniform buffer we just created
-		// This buffer is entirely used as a uniform buffer, so we map the whole
-		// thing
-		.offset = 0u,
-		.range  = VK_WHOLE_SIZE,
-	};
-
-	// Now, we write to the descriptor set so that it points to the uniform
-	// buffer memory This won't change, so we only have to do this once
-
-	// Dispatch all the writes
-	GlobalParam->Device->updateDescriptorSets(
-		{// Descriptor Writes
-		 vk::WriteDescriptorSet{
-			 .dstSet           = SequenceParam->DescriptorSet.get(),
-			 .dstBinding       = 0,
-			 .dstArrayElement  = 0,
-			 .descriptorCount  = 1,
-			 .descriptorType   = vk::DescriptorType::eUniformBuffer,
-			 .pImageInfo       = nullptr,
-			 .pBufferInfo      = &UniformBufferInfo,
-			 .pTexelBufferView = nullptr
-		 }
-		},
+	// Allocate descriptor set
+	// With push descriptors, the input image is pushed along with each render
+	// pass instead
+	if( !GlobalParam.Features.PushDescriptor )
+	{
+		Context->DescriptorSet = GlobalParam.Descriptors.Allocate(
+			GlobalParam.RenderDescriptorSetLayout.get()
+		);
+		if( !Context->DescriptorSet )
 		{
-			// Descriptor Copies
+			// Error allocating descriptor set
+			return nullptr;
 		}
+		++Counter.Creations;
+	}
+
+	return Context;
+}
+
+PF_Err SequenceSetup(
+	PF_InData* in_data, PF_OutData* out_data, PF_ParamDef* params[],
+	PF_LayerDef* output
+)
+{
+	AEGP_SuiteHandler suites(in_data->pica_basicP);
+
+	Vulkanator::GlobalParams* GlobalParam
+		= static_cast<Vulkanator::GlobalParams*>(
+			suites.HandleSuite1()->host_lock_handle(in_data->global_data)
+		);
+
+	// Cleanup previous sequence datas
+	if( auto SequenceParam
+		= reinterpret_cast<Vulkanator::SequenceParams*>(out_data->sequence_data
+		);
+		SequenceParam )
+	{
+		// Setdown sequence stuff
+		SequenceParam->~SequenceParams();
+		// Destroy handle
+		suites.HandleSuite1()->host_dispose_handle(out_data->sequence_data);
+		in_data->sequence_data = out_data->sequence_data = nullptr;
+	}
+
+	// Allocate new sequence data
+	const PF_Handle SequenceDataHandle = suites.HandleSuite1()->host_new_handle(
+		sizeof(Vulkanator::SequenceParams)
 	);
 
+	if( !SequenceDataHandle )
+	{
+		return PF_Err_OUT_OF_MEMORY;
+	}
+
+	out_data->sequence_data = SequenceDataHandle;
+
+	Vulkanator::SequenceParams* SequenceParam
+		= reinterpret_cast<Vulkanator::SequenceParams*>(*SequenceDataHandle);
+	// Setup data sequence stuff
+	// ...
+	new(SequenceParam) Vulkanator::SequenceParams();
+
+	// No GPU resources are created here. Projects may hold thousands of
+	// instances of this effect, most of which are never rendered during a
+	// session. Render contexts are created by the first render that needs one
+	SequenceParam->Contexts = std::make_shared<Vulkanator::RenderContextPool>();
+	GlobalParam->Memory.Register(SequenceParam->Contexts);
+
 	return PF_Err_NONE;
 }
 
@@ -927,6 +1552,9 @@ PF_Err SequenceSetdown(
 				*out_data->sequence_data
 			);
 		// Setdown sequence stuff
+		// The render context pool itself lives on until the last render that
+		// is still using it is done
+		SequenceParam->Contexts.reset();
 		// SequenceParam->~SequenceParams();
 		// host_dispose_handle seems to call the deconstructor already? That's
 		// weird, but cool I guess Destroy handle
@@ -1034,6 +1662,167 @@ PF_ParamDef GetParam(const PF_InData* in_data, std::int32_t ParamIndex)
 
 //////////////////////////////////////////////////////////////////////////////////////////
 
+// Texels around a footprint that filtering may also end up sampling from
+static constexpr glm::f32 FootprintMargin = 2.0f;
+
+// Maps a region of the output layer back through `Transform` to find the
+// region of the input layer that it samples from
+// The footprint is empty when the region does not sample the input at all
+vk::Rect2D ComputeInputFootprint(
+	const glm::f32mat4& Transform, const vk::Rect2D& OutputRegion,
+	const vk::Extent2D& OutputExtent, const vk::Extent2D& InputExtent
+)
+{
+	// A degenerate transform squashes the entire input layer into nothing
+	if( std::abs(glm::determinant(glm::f32mat2(Transform)))
+		<= std::numeric_limits<glm::f32>::epsilon() )
+	{
+		return {};
+	}
+
+	const glm::f32mat4 InverseTransform = glm::inverse(Transform);
+	const glm::f32vec2 OutputSize(OutputExtent.width, OutputExtent.height);
+	const glm::f32vec2 InputSize(InputExtent.width, InputExtent.height);
+
+	const glm::f32vec2 RegionOffset(
+		OutputRegion.offset.x, OutputRegion.offset.y
+	);
+	const glm::f32vec2 RegionSize(
+		OutputRegion.extent.width, OutputRegion.extent.height
+	);
+
+	// The transform is affine, so the footprint of the region is bounded by
+	// where its corners land within the input layer
+	glm::f32vec2 FootprintMin(std::numeric_limits<glm::f32>::max());
+	glm::f32vec2 FootprintMax(std::numeric_limits<glm::f32>::lowest());
+	for( const glm::f32vec2& Corner :
+		 {glm::f32vec2(0, 0), glm::f32vec2(1, 0), glm::f32vec2(0, 1),
+		  glm::f32vec2(1, 1)} )
+	{
+		// Output pixels -> clip space -> quad space -> input pixels
+		const glm::f32vec2 ClipPoint
+			= (RegionOffset + Corner * RegionSize) / OutputSize * 2.0f - 1.0f;
+		const glm::f32vec2 QuadPoint(
+			InverseTransform * glm::f32vec4(ClipPoint, 0.0f, 1.0f)
+		);
+		const glm::f32vec2 InputPoint = (QuadPoint + 1.0f) * 0.5f * InputSize;
+
+		FootprintMin = glm::min(FootprintMin, InputPoint);
+		FootprintMax = glm::max(FootprintMax, InputPoint);
+	}
+
+	// Widen the footprint by the texels that filtering samples around it, and
+	// keep it within the input layer
+	const glm::f32vec2 FootprintBegin = glm::clamp(
+		glm::floor(FootprintMin) - FootprintMargin, glm::f32vec2(0.0f),
+		InputSize
+	);
+	const glm::f32vec2 FootprintEnd = glm::clamp(
+		glm::ceil(FootprintMax) + FootprintMargin, glm::f32vec2(0.0f), InputSize
+	);
+
+	// The region lands entirely outside of the input layer
+	if( FootprintBegin.x >= FootprintEnd.x
+		|| FootprintBegin.y >= FootprintEnd.y )
+	{
+		return {};
+	}
+
+	return vk::Rect2D{
+		{std::int32_t(FootprintBegin.x), std::int32_t(FootprintBegin.y)},
+		{std::uint32_t(FootprintEnd.x - FootprintBegin.x),
+		 std::uint32_t(FootprintEnd.y - FootprintBegin.y)},
+	};
+}
+
+// Overlapping region of two rectangles, or an empty rectangle if they do not
+// overlap at all
+PF_LRect IntersectRects(const PF_LRect& A, const PF_LRect& B)
+{
+	const PF_LRect Intersection = {
+		.left   = std::max(A.left, B.left),
+		.top    = std::max(A.top, B.top),
+		.right  = std::min(A.right, B.right),
+		.bottom = std::min(A.bottom, B.bottom),
+	};
+	if( Intersection.left >= Intersection.right
+		|| Intersection.top >= Intersection.bottom )
+	{
+		return {};
+	}
+	return Intersection;
+}
+
+// Bounds of the pixels that the quad covers once it is transformed onto a
+// layer that spans `FullRect`
+PF_LRect
+	ComputeQuadBounds(const glm::f32mat4& Transform, const PF_LRect& FullRect)
+{
+	const glm::f32vec2 FullSize(
+		FullRect.right - FullRect.left, FullRect.bottom - FullRect.top
+	);
+
+	glm::f32vec2 QuadMin(std::numeric_limits<glm::f32>::max());
+	glm::f32vec2 QuadMax(std::numeric_limits<glm::f32>::lowest());
+	for( const Vulkanator::Vertex& CurVertex : Vulkanator::Quad )
+	{
+		// Quad space -> clip space -> layer pixels
+		const glm::f32vec2 ClipPoint(
+			Transform * glm::f32vec4(CurVertex.Position, 0.0f, 1.0f)
+		);
+		const glm::f32vec2 LayerPoint = (ClipPoint + 1.0f) * 0.5f * FullSize;
+
+		QuadMin = glm::min(QuadMin, LayerPoint);
+		QuadMax = glm::max(QuadMax, LayerPoint);
+	}
+
+	// Keep the bounds from overflowing when the quad is scaled up greatly,
+	// they get clipped to the layer anyways
+	QuadMin = glm::clamp(glm::floor(QuadMin), glm::f32vec2(0.0f), FullSize);
+	QuadMax = glm::clamp(glm::ceil(QuadMax), glm::f32vec2(0.0f), FullSize);
+
+	return PF_LRect{
+		.left   = FullRect.left + A_long(QuadMin.x),
+		.top    = FullRect.top + A_long(QuadMin.y),
+		.right  = FullRect.left + A_long(QuadMax.x),
+		.bottom = FullRect.top + A_long(QuadMax.y),
+	};
+}
+
+// Transform that maps all of clip space onto just `Region` of an image's clip
+// space, such as to have the quad span a sub-rectangle of a layer
+glm::f32mat4
+	RegionToClip(const vk::Rect2D& Region, const vk::Extent2D& ImageExtent)
+{
+	const glm::f32vec2 ImageSize(ImageExtent.width, ImageExtent.height);
+	const glm::f32vec2 RegionBegin
+		= glm::f32vec2(Region.offset.x, Region.offset.y) / ImageSize * 2.0f
+		- 1.0f;
+	const glm::f32vec2 RegionEnd
+		= glm::f32vec2(
+			  Region.offset.x + Region.extent.width,
+			  Region.offset.y + Region.extent.height
+		  )
+		/ ImageSize * 2.0f
+		- 1.0f;
+
+	const glm::f32mat4 Transform = glm::translate(
+		glm::identity<glm::f32mat4>(),
+		glm::f32vec3((RegionBegin + RegionEnd) * 0.5f, 0.0f)
+	);
+	return glm::scale(
+		Transform, glm::f32vec3((RegionEnd - RegionBegin) * 0.5f, 1.0f)
+	);
+}
+
+// The opposite of RegionToClip, stretches `Region` of an image's clip space
+// out over all of clip space
+glm::f32mat4
+	ClipToRegion(const vk::Rect2D& Region, const vk::Extent2D& ImageExtent)
+{
+	return glm::inverse(RegionToClip(Region, ImageExtent));
+}
+
 PF_Err SmartPreRender(
 	PF_InData* in_data, PF_OutData* out_data, PF_PreRenderExtra* extra
 )
@@ -1045,7 +1834,7 @@ PF_Err SmartPreRender(
 	const PF_PreRenderInput* Input   = extra->input;
 	PF_PreRenderOutput*      Output  = extra->output;
 
-	// Checkout all layers in their entirety
+	// Checkout layers as full frames, with all of their channels
 	Request.field                      = PF_Field_FRAME;
 	Request.preserve_rgb_of_zero_alpha = true;
 	Request.channel_mask               = PF_ChannelMask_ARGB;
@@ -1065,26 +1854,12 @@ PF_Err SmartPreRender(
         &InputCheckResult
     );
 
-	// Then, we checkout the whole texture using the size we got previously
-	// Checkout Input layer
-	FullRequest                            = Request;
-	FullRequest.rect                       = InputCheckResult.max_result_rect;
-	FullRequest.field                      = PF_Field_FRAME;
-	FullRequest.preserve_rgb_of_zero_alpha = true;
-	FullRequest.channel_mask               = PF_ChannelMask_ARGB;
-	ERR(extra->cb->checkout_layer(
-		in_data->effect_ref, Vulkanator::ParamID::Input,
-		Vulkanator::ParamID::Input, &FullRequest, in_data->current_time,
-		in_data->time_step, in_data->time_scale, &InputCheckResult
-	));
-
-	// UnionLRect(&InputCheckResult.result_rect, &Output->result_rect);
-	// UnionLRect(&InputCheckResult.max_result_rect, &Output->max_result_rect);
-	// We will always render the full frame, rather than deal with rendering to
-	// subsets of the framebuffer
-	Output->result_rect     = InputCheckResult.result_rect;
-	Output->max_result_rect = InputCheckResult.result_rect;
-	Output->flags           = PF_RenderOutputFlag_RETURNS_EXTRA_PIXELS;
+	// The output layer spans the same region as the full input layer
+	const PF_LRect     FullRect   = InputCheckResult.max_result_rect;
+	const vk::Extent2D FullExtent = {
+		.width  = static_cast<std::uint32_t>(FullRect.right - FullRect.left),
+		.height = static_cast<std::uint32_t>(FullRect.bottom - FullRect.top),
+	};
 
 	// Setup render params
 	Vulkanator::RenderParams* FrameParam = new Vulkanator::RenderParams();
@@ -1174,451 +1949,3216 @@ PF_Err SmartPreRender(
 	FrameParam->Uniforms.ColorFactor
 		= glm::f32vec4(FactorR, FactorG, FactorB, FactorA);
 
-	return err;
-}
-
-PF_Err SmartRender(
-	PF_InData* in_data, PF_OutData* out_data, PF_SmartRenderExtra* extra
-)
-{
-	PF_Err err = PF_Err_NONE;
+	// Everything outside of the transformed quad is transparent, so only the
+	// quad's bounds are ever rendered. Of which, only the requested region of
+	// the output is rendered
+	const PF_LRect QuadRect = IntersectRects(
+		ComputeQuadBounds(FrameParam->Uniforms.Transform, FullRect), FullRect
+	);
+	const PF_LRect OutputRect = IntersectRects(Request.rect, QuadRect);
 
-	AEGP_SuiteHandler suites(in_data->pica_basicP);
+	const vk::Rect2D OutputRegion = {
+		{std::int32_t(OutputRect.left - FullRect.left),
+		 std::int32_t(OutputRect.top - FullRect.top)},
+		{std::uint32_t(OutputRect.right - OutputRect.left),
+		 std::uint32_t(OutputRect.bottom - OutputRect.top)},
+	};
 
-	PF_EffectWorld* InputLayer  = {};
-	PF_EffectWorld* OutputLayer = {};
+	// Then, we map the output region back through the transform, and only
+	// checkout the region of the input layer that it samples from
+	const vk::Rect2D Footprint
+		= OutputRegion.extent.width && OutputRegion.extent.height
+			? ComputeInputFootprint(
+				  FrameParam->Uniforms.Transform, OutputRegion, FullExtent,
+				  FullExtent
+			  )
+			: vk::Rect2D{};
+
+	PF_RenderRequest InputRequest = Request;
+	InputRequest.rect             = {};
+	if( Footprint.extent.width && Footprint.extent.height )
+	{
+		InputRequest.rect = {
+			.left   = FullRect.left + Footprint.offset.x,
+			.top    = FullRect.top + Footprint.offset.y,
+			.right  = FullRect.left + Footprint.offset.x
+					+ A_long(Footprint.extent.width),
+			.bottom = FullRect.top + Footprint.offset.y
+					+ A_long(Footprint.extent.height),
+		};
+	}
 
-	// Checkout input/output layers
-	ERR(extra->cb->checkout_layer_pixels(
-		in_data->effect_ref, Vulkanator::ParamID::Input, &InputLayer
+	// Checkout Input layer
+	ERR(extra->cb->checkout_layer(
+		in_data->effect_ref, Vulkanator::ParamID::Input,
+		Vulkanator::ParamID::Input, &InputRequest, in_data->current_time,
+		in_data->time_step, in_data->time_scale, &InputCheckResult
 	));
-	ERR(extra->cb->checkout_output(in_data->effect_ref, &OutputLayer));
+	FrameParam->InputRect = InputCheckResult.result_rect;
+
+	Output->result_rect     = OutputRect;
+	Output->max_result_rect = QuadRect;
+
+	// The layers only hold a region of the full frame, so the quad is shrunk
+	// down onto the region of the input layer that was checked out, which
+	// makes its UVs span just that region. And the output region is stretched
+	// out over the entire output layer
+	const PF_LRect&  InputRect   = InputCheckResult.result_rect;
+	const vk::Rect2D InputRegion = {
+		{std::int32_t(InputRect.left - FullRect.left),
+		 std::int32_t(InputRect.top - FullRect.top)},
+		{std::uint32_t(std::max<A_long>(InputRect.right - InputRect.left, 0)),
+		 std::uint32_t(std::max<A_long>(InputRect.bottom - InputRect.top, 0))},
+	};
 
-	if( !OutputLayer || !InputLayer )
-		return PF_Err_NONE;
+	if( InputRegion.extent.width && InputRegion.extent.height
+		&& OutputRegion.extent.width && OutputRegion.extent.height )
+	{
+		FrameParam->Uniforms.Transform
+			= ClipToRegion(OutputRegion, FullExtent)
+			* FrameParam->Uniforms.Transform
+			* RegionToClip(InputRegion, FullExtent);
+	}
 
-	// Lock global handle
-	Vulkanator::GlobalParams* GlobalParam
-		= reinterpret_cast<Vulkanator::GlobalParams*>(*in_data->global_data);
-	Vulkanator::SequenceParams* SequenceParam
-		= reinterpret_cast<Vulkanator::SequenceParams*>(*in_data->sequence_data
-		);
-	Vulkanator::RenderParams* FrameParam
-		= reinterpret_cast<Vulkanator::RenderParams*>(
-			extra->input->pre_render_data
-		);
+	return err;
+}
 
-	/////// Get some traits about this render
+// Size of a single pixel of a layer, for each color depth
+static constexpr std::array<std::size_t, 3> PixelSizes
+	= {sizeof(PF_Pixel8), sizeof(PF_Pixel16), sizeof(PF_Pixel32)};
+
+// Typically we are only ever addressing the first layer/mip of an image
+// These structures can be re-used to help address this common image
+// subresource
+static const vk::ImageSubresourceLayers ImageDefaultSubresourceLayer = {
+	.aspectMask     = vk::ImageAspectFlagBits::eColor,
+	.mipLevel       = 0,
+	.baseArrayLayer = 0,
+	.layerCount     = 1,
+};
+
+static const vk::ImageSubresourceRange ImageDefaultSubresourceRange = {
+	.aspectMask     = vk::ImageAspectFlagBits::eColor,
+	.baseMipLevel   = 0,
+	.levelCount     = 1,
+	.baseArrayLayer = 0,
+	.layerCount     = 1,
+};
+
+// Picks how the pixels of a frame will get to the GPU and back, based on the
+// device's memory topology and what the device is able to do with this frame
+Vulkanator::TransferPlan SelectTransferPlan(
+	const Vulkanator::GlobalParams& GlobalParam, std::size_t Depth,
+	const vk::Extent3D& InputExtent, const vk::Extent3D& OutputExtent
+)
+{
+	const vk::Extent3D& LinearMaxExtent
+		= GlobalParam.Features.LinearImageMaxExtent.at(Depth);
 
-	// The staging buffer should be the maximum between the size of the Input
-	// layer and Output layer High level process: InputLayer->data -memcpy->>>
-	// Staging(Vulkan) -vkCmdCopyBufferToImage->>> InputImage(Vulkan) <Render
-	// into Output Image, using InputImage> OutputImage
-	// -vkCmdCopyImageToBuffer->>> Staging(Vulkan) -memcpy->>> OutputLayer->data
-	const std::size_t StagingBufferSize = glm::max(
-		InputLayer->height * InputLayer->rowbytes,
-		OutputLayer->height * OutputLayer->rowbytes
-	);
+	const auto IsAvailable = [&](Vulkanator::TransferPlan Plan) -> bool {
+		switch( Plan )
+		{
+		// When the device and the host share the same memory, the GPU can
+		// sample from and render into host-visible memory without any
+		// penalty. So there is no reason to copy anything at all, so long as
+		// the images fit
+		case Vulkanator::TransferPlan::DirectLinear:
+			return GlobalParam.Topology == VulkanUtils::MemoryTopology::Unified
+				&& InputExtent.width <= LinearMaxExtent.width
+				&& InputExtent.height <= LinearMaxExtent.height
+				&& OutputExtent.width <= LinearMaxExtent.width
+				&& OutputExtent.height <= LinearMaxExtent.height;
+		case Vulkanator::TransferPlan::HostImageCopy:
+			return GlobalParam.Features.HostImageCopy;
+		// If the host is able to map device-local memory, then the input layer
+		// can be written right into VRAM, saving the GPU from reading it over
+		// the bus
+		case Vulkanator::TransferPlan::WriteCombinedUpload:
+			return GlobalParam.Topology
+				!= VulkanUtils::MemoryTopology::Discrete;
+		case Vulkanator::TransferPlan::CachedReadback:
+			return true;
+		}
+		return false;
+	};
 
-	// Test for cache hit
-	if( (StagingBufferSize <= SequenceParam->Cache.StagingBufferSize
-		) // Can use a subset of the memory
-	)
+	if( GlobalParam.ForcedTransferPlan.has_value()
+		&& IsAvailable(GlobalParam.ForcedTransferPlan.value()) )
 	{
-		// Cache hit
-		const std::size_t SizeDifference
-			= SequenceParam->Cache.StagingBufferSize - StagingBufferSize;
+		return GlobalParam.ForcedTransferPlan.value();
+	}
 
-		// We tripped the cache threshold, so we resize it to be smaller
-		if( SizeDifference > std::size_t(
-				SequenceParam->Cache.StagingBufferSize
-				* Vulkanator::SequenceParams::SequenceCache::ShrinkThreshold
-			) )
+	// Plans that copy less come first
+	for( const Vulkanator::TransferPlan CurPlan :
+		 {Vulkanator::TransferPlan::DirectLinear,
+		  Vulkanator::TransferPlan::HostImageCopy,
+		  Vulkanator::TransferPlan::WriteCombinedUpload} )
+	{
+		if( IsAvailable(CurPlan) )
 		{
-			std::tie(
-				SequenceParam->Cache.StagingBuffer,
-				SequenceParam->Cache.StagingBufferMemory
-			)
-				= VulkanUtils::AllocateBuffer(
-					  GlobalParam->Device.get(), GlobalParam->PhysicalDevice,
-					  StagingBufferSize,
-					  vk::BufferUsageFlagBits::eTransferDst
-						  | vk::BufferUsageFlagBits::eTransferSrc,
-					  vk::MemoryPropertyFlagBits::eHostCached
-						  | vk::MemoryPropertyFlagBits::eHostCoherent
-				)
-					  .value();
-			SequenceParam->Cache.StagingBufferSize = StagingBufferSize;
+			return CurPlan;
 		}
 	}
-	else
-	{
-		// Cache miss, recreate buffer
-		std::tie(
-			SequenceParam->Cache.StagingBuffer,
-			SequenceParam->Cache.StagingBufferMemory
-		)
-			= VulkanUtils::AllocateBuffer(
-				  GlobalParam->Device.get(), GlobalParam->PhysicalDevice,
-				  StagingBufferSize,
-				  vk::BufferUsageFlagBits::eTransferDst
-					  | vk::BufferUsageFlagBits::eTransferSrc,
-				  vk::MemoryPropertyFlagBits::eHostCached
-					  | vk::MemoryPropertyFlagBits::eHostCoherent
-			)
-				  .value();
-		SequenceParam->Cache.StagingBufferSize = StagingBufferSize;
-	}
 
-	const vk::Format RenderFormat
-		= VulkanUtils::DepthToFormat(FrameParam->Uniforms.Depth);
+	return Vulkanator::TransferPlan::CachedReadback;
+}
 
-	static constexpr std::array<std::size_t, 3> PixelSizes
-		= {sizeof(PF_Pixel8), sizeof(PF_Pixel16), sizeof(PF_Pixel32)};
-	const std::size_t PixelSize = PixelSizes.at(FrameParam->Uniforms.Depth);
+// Puts a cached image that the current render has no use for at the front of a
+// render cache's spares, retiring the least recently used spare if there are
+// too many
+template<typename Resource>
+void ParkSpare(
+	Vulkanator::DestructionQueue& Destruction, std::vector<Resource>& Spares,
+	Resource&& Spare
+)
+{
+	Spares.insert(Spares.begin(), std::move(Spare));
+	if( Spares.size() > Vulkanator::RenderContext::RenderCache::SpareCapacity )
+	{
+		Destruction.Retire(std::move(Spares.back()));
+		Spares.pop_back();
+	}
+}
 
-	const vk::Extent3D InputImageExtent = {
-		.width  = static_cast<std::uint32_t>(InputLayer->width),
-		.height = static_cast<std::uint32_t>(InputLayer->height),
-		.depth  = 1,
-	};
-	const vk::Extent3D OutputImageExtent = {
-		.width  = static_cast<std::uint32_t>(OutputLayer->width),
-		.height = static_cast<std::uint32_t>(OutputLayer->height),
-		.depth  = 1,
-	};
-	const vk::Rect2D OutputRect2D = {
-		{0, 0},
-		{
-			std::uint32_t(OutputLayer->width),
-			std::uint32_t(OutputLayer->height),
-		},
-	};
+// Takes the most recently used spare that matches `Predicate`
+template<typename Resource, typename PredicateFunction>
+std::optional<Resource>
+	TakeSpare(std::vector<Resource>& Spares, PredicateFunction&& Predicate)
+{
+	const auto SpareMatch
+		= std::find_if(Spares.begin(), Spares.end(), Predicate);
+	if( SpareMatch == Spares.end() )
+	{
+		return std::nullopt;
+	}
 
-	// Create GPU-side Input Image
+	std::optional<Resource> Spare = std::move(*SpareMatch);
+	Spares.erase(SpareMatch);
+	return Spare;
+}
 
-	const vk::ImageCreateInfo InputImageInfo = {
-		.imageType   = vk::ImageType::e2D,
-		.format      = RenderFormat,
-		.extent      = InputImageExtent,
-		.mipLevels   = 1,
-		.arrayLayers = 1,
-		.samples     = vk::SampleCountFlagBits::e1,
-		.tiling      = vk::ImageTiling::eOptimal,
-		// Will be transferring from the staging buffer into this one
-		.usage = vk::ImageUsageFlagBits::eTransferSrc
-			   | vk::ImageUsageFlagBits::eTransferDst
-			   // Will be sampling from this image
-			   | vk::ImageUsageFlagBits::eSampled,
-		.sharingMode   = vk::SharingMode::eExclusive,
-		.initialLayout = vk::ImageLayout::eUndefined,
-	};
+// Memory that is left for the process to allocate within the heap that memory
+// of `Properties` is allocated from
+vk::DeviceSize GetAvailableHeapMemory(
+	const Vulkanator::GlobalParams& GlobalParam,
+	vk::MemoryPropertyFlags         Properties
+)
+{
+	const vk::PhysicalDeviceMemoryProperties MemoryProperties
+		= GlobalParam.PhysicalDevice.getMemoryProperties();
 
-	if( InputImageInfo == SequenceParam->Cache.InputImageInfoCache )
+	std::optional<std::uint32_t> HeapIndex = std::nullopt;
+	for( std::uint32_t i = 0; i < MemoryProperties.memoryTypeCount; ++i )
 	{
-		// Cache Hit
+		const vk::MemoryType& CurType = MemoryProperties.memoryTypes[i];
+		if( (CurType.propertyFlags & Properties) == Properties )
+		{
+			HeapIndex = CurType.heapIndex;
+			break;
+		}
 	}
-	else
+
+	if( !HeapIndex )
 	{
-		// Cache Miss, recreate image
-		std::tie(
-			SequenceParam->Cache.InputImage,
-			SequenceParam->Cache.InputImageMemory
-		)
-			= VulkanUtils::AllocateImage(
-				  GlobalParam->Device.get(), GlobalParam->PhysicalDevice,
-				  InputImageInfo, vk::MemoryPropertyFlagBits::eDeviceLocal
-			)
-				  .value();
-		SequenceParam->Cache.InputImageInfoCache = InputImageInfo;
+		return 0;
 	}
 
-	// This provides a mapping between the image contents and the staging buffer
+	if( GlobalParam.Features.MemoryBudget )
+	{
+		const auto BudgetProperties
+			= GlobalParam.PhysicalDevice.getMemoryProperties2<
+				vk::PhysicalDeviceMemoryProperties2,
+				vk::PhysicalDeviceMemoryBudgetPropertiesEXT>();
+		const vk::PhysicalDeviceMemoryBudgetPropertiesEXT& HeapBudgets
+			= BudgetProperties
+				  .get<vk::PhysicalDeviceMemoryBudgetPropertiesEXT>();
+
+		const vk::DeviceSize Budget = HeapBudgets.heapBudget[*HeapIndex];
+		const vk::DeviceSize Used   = HeapBudgets.heapUsage[*HeapIndex];
+		return Budget > Used ? Budget - Used : 0;
+	}
 
-	// Typically we are only ever addressing the first layer/mip of an image
-	// These structures can be re-used to help address this common image
-	// subresource
-	static const vk::ImageSubresourceLayers ImageDefaultSubresourceLayer = {
-		.aspectMask     = vk::ImageAspectFlagBits::eColor,
-		.mipLevel       = 0,
-		.baseArrayLayer = 0,
-		.layerCount     = 1,
-	};
+	// Without VK_EXT_memory_budget, only what this process has allocated is
+	// known to be taken
+	const vk::DeviceSize HeapSize
+		= MemoryProperties.memoryHeaps[*HeapIndex].size;
+	const vk::DeviceSize Used = GlobalParam.Allocator.GetHeapUsage(*HeapIndex);
+	return HeapSize > Used ? HeapSize - Used : 0;
+}
 
-	static const vk::ImageSubresourceRange ImageDefaultSubresourceRange = {
-		.aspectMask     = vk::ImageAspectFlagBits::eColor,
-		.baseMipLevel   = 0,
-		.levelCount     = 1,
-		.baseArrayLayer = 0,
-		.layerCount     = 1,
+// Allocates `Ring` to hold `StagingRingFrames` frames that each stream
+// `FrameSize` bytes through it, within its share of the heap
+bool InitializeStagingRing(
+	Vulkanator::GlobalParams& GlobalParam, Vulkanator::StagingRing& Ring,
+	vk::DeviceSize FrameSize, vk::MemoryPropertyFlags Properties,
+	vk::MemoryPropertyFlags ExcludeProperties
+)
+{
+	// They are used by both the graphics and the transfer queues
+	std::vector<std::uint32_t> QueueFamilies = {
+		GlobalParam.GraphicsQueueFamily,
 	};
+	if( GlobalParam.DedicatedTransferQueue )
+	{
+		QueueFamilies.emplace_back(GlobalParam.TransferQueueFamily);
+	}
 
-	const vk::BufferImageCopy InputBufferMapping{
-		.bufferOffset      = 0,
-		.bufferRowLength   = std::uint32_t(InputLayer->rowbytes / PixelSize),
-		.bufferImageHeight = 0,
-		.imageSubresource  = ImageDefaultSubresourceLayer,
-		.imageOffset       = {},
-		.imageExtent       = InputImageExtent,
-	};
+	const vk::DeviceSize MaxRingSize = std::max(
+		MinStagingRingSize,
+		GetAvailableHeapMemory(GlobalParam, Properties)
+			/ StagingRingHeapFraction
+	);
 
-	// Input image view, this is used to create an interpretation of a certain
+	for( vk::DeviceSize RingSize = std::clamp(
+			 FrameSize * StagingRingFrames, MinStagingRingSize, MaxRingSize
+		 );
+		 RingSize >= MinStagingRingSize; RingSize /= 2 )
+	{
+		if( Ring.Initialize(
+				GlobalParam.Allocator, RingSize, Properties, ExcludeProperties,
+				QueueFamilies
+			) )
+		{
+			return true;
+		}
+	}
+
+	// Error allocating staging ring
+	return false;
+}
+
+// Creates the staging rings that every render streams its pixels through, if
+// they have not been created yet
+// They are only created once a frame is rendered, rather than during
+// GlobalSetup, so that they are sized for the frames of the project, and take
+// up no memory at all until the effect is actually used
+bool EnsureStagingRings(
+	Vulkanator::GlobalParams& GlobalParam, vk::DeviceSize UploadSize,
+	vk::DeviceSize ReadbackSize
+)
+{
+	if( GlobalParam.StagingReady.load(std::memory_order_acquire) )
+	{
+		return true;
+	}
+
+	const std::scoped_lock StagingLock(GlobalParam.StagingMutex);
+	if( GlobalParam.StagingReady.load(std::memory_order_relaxed) )
+	{
+		return true;
+	}
+
+	if( !InitializeStagingRing(
+			GlobalParam, GlobalParam.Staging, UploadSize + ReadbackSize,
+			CachedStagingProperties, vk::MemoryPropertyFlagBits::eProtected
+		) )
+	{
+		// Error allocating staging ring
+		return false;
+	}
+
+	// Only worth having if the host is able to write into device-local memory
+	// Without it, uploads go through the host-cached ring instead
+	if( GlobalParam.Topology != VulkanUtils::MemoryTopology::Discrete )
+	{
+		static_cast<void>(InitializeStagingRing(
+			GlobalParam, GlobalParam.WriteCombinedStaging, UploadSize,
+			WriteCombinedStagingProperties,
+			vk::MemoryPropertyFlagBits::eHostCached
+				| vk::MemoryPropertyFlagBits::eProtected
+		));
+	}
+
+	GlobalParam.StagingReady.store(true, std::memory_order_release);
+	return true;
+}
+
+// Makes sure that a cached image matches `Info`, swapping in a spare image if
+// there is one that does. Otherwise, a new image is allocated using `Allocate`
+// and the image that was there before is kept as a spare
+template<typename AllocateFunction>
+bool ReserveImage(
+	Vulkanator::GlobalParams&                            GlobalParam,
+	Vulkanator::RenderContext::RenderCache&              Cache,
+	Vulkanator::RenderContext::RenderCache::CachedImage& Slot,
+	const vk::ImageCreateInfo& Info, AllocateFunction&& Allocate
+)
+{
+	using CachedImage = Vulkanator::RenderContext::RenderCache::CachedImage;
+
+	if( Slot.Image && Slot.Info == Info )
+	{
+		// Cache Hit
+		++GlobalParam.CacheStats.ImageHits;
+		return true;
+	}
+
+	if( Slot.Image )
+	{
+		ParkSpare(
+			GlobalParam.Destruction, Cache.SpareImages, std::exchange(Slot, {})
+		);
+	}
+
+	if( auto Spare = TakeSpare(
+			Cache.SpareImages,
+			[&](const CachedImage& CurSpare) -> bool {
+				return CurSpare.Info == Info;
+			}
+		);
+		Spare.has_value() )
+	{
+		// Cache Hit, from a previous render of the same size and format
+		Slot = std::move(Spare.value());
+		++GlobalParam.CacheStats.ImageHits;
+		return true;
+	}
+
+	// Cache Miss, allocate a new image
+	++GlobalParam.CacheStats.ImageMisses;
+
+	const CountedSetupCall Counter{GlobalParam.SetupStats, 1};
+
+	auto ImageResult = AllocateWithEviction(GlobalParam, Allocate);
+	if( !ImageResult && !Cache.SpareImages.empty() )
+	{
+		// This render context's own spares may be what is in the way
+		Cache.SpareImages.clear();
+		ImageResult = AllocateWithEviction(GlobalParam, Allocate);
+	}
+
+	if( !ImageResult )
+	{
+		// Error allocating image
+		return false;
+	}
+
+	std::tie(Slot.Image, Slot.Memory) = std::move(ImageResult.value());
+	Slot.Info                         = Info;
+	Slot.Layout                       = Info.initialLayout;
+	return true;
+}
+
+// Rows of a layer that are transferred and rendered together when a frame is
+// split into bands
+struct Band
+{
+	std::uint32_t Offset = 0;
+	std::uint32_t Height = 0;
+};
+
+// Frames with layers that pass through staging buffers, and are at least this
+// large, are pipelined in bands
+static constexpr std::size_t BandedFrameSize = 16ull * 1024 * 1024;
+
+// Splits the rows of a layer into bands of about `BandSize` bytes, with each
+// band starting on a multiple of `Alignment` rows
+// Fewer bands means less overlap between the CPU and GPU, but more bands means
+// more submissions and barriers
+std::vector<Band> SplitIntoBands(
+	std::uint32_t Height, std::size_t RowBytes, std::uint32_t Alignment = 1
+)
+{
+	static constexpr std::size_t   BandSize = 4ull * 1024 * 1024;
+	static constexpr std::uint32_t MaxBands = 8;
+
+	const std::size_t   LayerSize = RowBytes * Height;
+	const std::uint32_t BandCount = std::uint32_t(std::clamp<std::size_t>(
+		(LayerSize + BandSize - 1) / BandSize, 1, MaxBands
+	));
+
+	std::uint32_t BandHeight = (Height + BandCount - 1) / BandCount;
+	BandHeight = (BandHeight + Alignment - 1) / Alignment * Alignment;
+
+	std::vector<Band> Bands = {};
+	for( std::uint32_t CurOffset = 0; CurOffset < Height;
+		 CurOffset += BandHeight )
+	{
+		Bands.emplace_back(Band{
+			.Offset = CurOffset,
+			.Height = std::min(BandHeight, Height - CurOffset),
+		});
+	}
+	return Bands;
+}
+
+// Creates a view of an entire 2D image, along with its serial number
+bool CreateImageView(
+	Vulkanator::GlobalParams& GlobalParam, vk::Image Image, vk::Format Format,
+	vk::UniqueImageView& View, std::uint64_t& ViewSerial
+)
+{
+	// Image view, this is used to create an interpretation of a certain
 	// aspect of the image This allows things like having a 2D image array but
 	// creating a view around just one of the images
-	const vk::ImageViewCreateInfo InputImageViewInfo = {
+	const vk::ImageViewCreateInfo ImageViewInfo = {
 		// The target image we are making a view of
-		.image    = SequenceParam->Cache.InputImage.get(),
+		.image    = Image,
 		.viewType = vk::ImageViewType::e2D,
-		.format   = RenderFormat,
+		.format   = Format,
 		// Swizzling of color channels used during reading/sampling
 		.components       = {},
 		.subresourceRange = ImageDefaultSubresourceRange,
 	};
 
-	SequenceParam->Cache.InputImageInfoCache = InputImageInfo;
-
-	vk::UniqueImageView InputImageView = {};
+	const CountedSetupCall Counter{GlobalParam.SetupStats, 1};
 	if( auto ImageViewResult
-		= GlobalParam->Device->createImageViewUnique(InputImageViewInfo);
+		= GlobalParam.Device->createImageViewUnique(ImageViewInfo);
 		ImageViewResult.result == vk::Result::eSuccess )
 	{
-		InputImageView = std::move(ImageViewResult.value);
+		View       = std::move(ImageViewResult.value);
+		ViewSerial = ++GlobalParam.ImageViewSerial;
 	}
 	else
 	{
 		// Error creating image view
-		return PF_Err_INTERNAL_STRUCT_DAMAGED;
+		return false;
 	}
 
-	// Create GPU-side Output Image
+	return true;
+}
+
+// Creates the view of a cached image, unless it already has one
+bool ReserveImageView(
+	Vulkanator::GlobalParams&                            GlobalParam,
+	Vulkanator::RenderContext::RenderCache::CachedImage& Slot
+)
+{
+	if( Slot.View )
+	{
+		return true;
+	}
+	return CreateImageView(
+		GlobalParam, Slot.Image.get(), Slot.Info.format, Slot.View,
+		Slot.ViewSerial
+	);
+}
+
+// Creates the framebuffer that renders into a cached output image, unless it
+// already has one. The framebuffer spans the entire image
+bool ReserveFramebuffer(
+	Vulkanator::GlobalParams&                            GlobalParam,
+	Vulkanator::RenderContext::RenderCache::CachedImage& Slot,
+	vk::RenderPass                                       RenderPass
+)
+{
+	if( Slot.Framebuffer )
+	{
+		return true;
+	}
+
+	if( !ReserveImageView(GlobalParam, Slot) )
+	{
+		return false;
+	}
+
+	// Create Render pass Framebuffer, this maps the Output buffer as a color
+	// attachment for a Renderpass to render into You can add more attachments
+	// of different formats, but they must all have the same width,height,layers
+	// Framebuffers will define the image data that render passes will be able
+	// to address in total
+	// Render passes are compatible with the framebuffer for as long as they
+	// have the same format as the image, which never changes
+	const vk::FramebufferCreateInfo FramebufferInfo = {
+		.renderPass      = RenderPass,
+		.attachmentCount = 1,
+		.pAttachments    = &Slot.View.get(),
+		.width           = Slot.Info.extent.width,
+		.height          = Slot.Info.extent.height,
+		.layers          = 1,
+	};
+
+	const CountedSetupCall Counter{GlobalParam.SetupStats, 1};
+	if( auto FramebufferResult
+		= GlobalParam.Device->createFramebufferUnique(FramebufferInfo);
+		FramebufferResult.result == vk::Result::eSuccess )
+	{
+		Slot.Framebuffer = std::move(FramebufferResult.value);
+	}
+	else
+	{
+		// Error creating framebuffer
+		return false;
+	}
+
+	return true;
+}
+
+// Gets the sampler that the input image will be sampled with
+vk::Sampler GetInputImageSampler(
+	const Vulkanator::GlobalParams& GlobalParam, PF_Quality Quality
+)
+{
+	// Port After Effect's quality setting over into the sampler setting
+	switch( Quality )
+	{
+	// Low quality -> Nearest interpolation
+	case PF_Quality_LO:
+	{
+		return GlobalParam.InputImageSamplers[0].get();
+	}
+	// High quality -> Linear interpolation
+	default:
+	case PF_Quality_HI:
+	{
+		return GlobalParam.InputImageSamplers[1].get();
+	}
+	}
+}
+
+// Sets the input image that the render context's next render passes sample
+// from. Without push descriptors, binding 0 of the render context's descriptor
+// set is pointed at it, unless it already is
+void BindInputImage(
+	Vulkanator::GlobalParams& GlobalParam, Vulkanator::RenderContext& Context,
+	vk::ImageView View, std::uint64_t ViewSerial, vk::Sampler Sampler,
+	vk::ImageLayout Layout
+)
+{
+	const Vulkanator::RenderContext::BoundImage NewBinding = {
+		.View       = View,
+		.ViewSerial = ViewSerial,
+		.Sampler    = Sampler,
+		.Layout     = Layout,
+	};
+	if( Context.BoundInputImage == NewBinding )
+	{
+		return;
+	}
+
+	Context.BoundInputImage = NewBinding;
+	if( GlobalParam.Features.PushDescriptor )
+	{
+		return;
+	}
+
+	// Write combined image+sampler object into the descriptor set
+	// Here, we combine both the sampler and the image, and we state the format
+	// that the image will be in by the time this sampler will be in-use
+	const vk::DescriptorImageInfo InputImageSamplerWrite{
+		.sampler     = Sampler,
+		.imageView   = View,
+		.imageLayout = Layout,
+	};
+
+	{
+		const CountedSetupCall Counter{GlobalParam.SetupStats};
+		GlobalParam.Device->updateDescriptorSets(
+			{vk::WriteDescriptorSet{
+				.dstSet          = Context.DescriptorSet.Get(),
+				.dstBinding      = 0,
+				.dstArrayElement = 0,
+				.descriptorCount = 1,
+				.descriptorType  = vk::DescriptorType::eCombinedImageSampler,
+				.pImageInfo      = &InputImageSamplerWrite,
+			}},
+			{}
+		);
+	}
+}
+
+// Records the render pass that draws the quad into `RenderArea` of a
+// framebuffer. The viewport always covers the entire framebuffer, and the
+// scissor limits drawing to the render area
+void RecordRenderPass(
+	vk::CommandBuffer RenderCmd, const Vulkanator::GlobalParams& GlobalParam,
+	const Vulkanator::RenderContext&               Context,
+	const Vulkanator::RenderParams::UniformParams& Uniforms,
+	vk::Framebuffer Framebuffer, const vk::Extent2D& FramebufferExtent,
+	const vk::Rect2D& RenderArea
+)
+{
+	const std::size_t Depth = Uniforms.Depth;
+
+	// Begin Render Pass
+
+	// This is the color that we clear the framebuffer with
+	// Default clear value is just "0" through out
+	static const vk::ClearValue ClearValue = {};
+
+	const vk::RenderPassBeginInfo RenderPassBeginInfo = {
+		// Assign our render pass, based on depth
+		.renderPass = GlobalParam.RenderPasses[Depth].get(),
+		// Assign our output framebuffer, which has 1 color attachment
+		.framebuffer = Framebuffer,
+
+		// Rectangular region of the output buffer to render into
+		// Only this region is cleared and drawn to, the rest of the
+		// output image is left as-is
+		.renderArea      = RenderArea,
+		.clearValueCount = 1,
+		.pClearValues    = &ClearValue,
+	};
+
+	////////////// Render pass begin
+	RenderCmd.beginRenderPass(
+		RenderPassBeginInfo, vk::SubpassContents::eInline
+	);
+
+	// Render pass commands here!!!
+	// Bind our shader
+	RenderCmd.bindPipeline(
+		vk::PipelineBindPoint::eGraphics,
+		GlobalParam.RenderPipelines[Depth].get()
+	);
+	// Bind our input image
+	if( GlobalParam.Features.PushDescriptor )
+	{
+		const vk::DescriptorImageInfo InputImageSamplerWrite{
+			.sampler     = Context.BoundInputImage.Sampler,
+			.imageView   = Context.BoundInputImage.View,
+			.imageLayout = Context.BoundInputImage.Layout,
+		};
+		RenderCmd.pushDescriptorSetKHR(
+			vk::PipelineBindPoint::eGraphics,
+			GlobalParam.RenderPipelineLayout.get(), 0,
+			{vk::WriteDescriptorSet{
+				.dstBinding      = 0,
+				.dstArrayElement = 0,
+				.descriptorCount = 1,
+				.descriptorType  = vk::DescriptorType::eCombinedImageSampler,
+				.pImageInfo      = &InputImageSamplerWrite,
+			}},
+			GlobalParam.Dispatcher
+		);
+	}
+	else
+	{
+		RenderCmd.bindDescriptorSets(
+			vk::PipelineBindPoint::eGraphics,
+			GlobalParam.RenderPipelineLayout.get(), 0,
+			{Context.DescriptorSet.Get()}, {}
+		);
+	}
+	// Pass along our uniforms
+	RenderCmd.pushConstants(
+		GlobalParam.RenderPipelineLayout.get(),
+		vk::ShaderStageFlagBits::eVertex | vk::ShaderStageFlagBits::eFragment,
+		0, sizeof(Uniforms), &Uniforms
+	);
+	// Bind our mesh
+	RenderCmd.bindVertexBuffers(0, {GlobalParam.MeshBuffer.get()}, {0});
+
+	// Set viewport and scissor region for this render
+	const vk::Viewport OutputViewport = {
+		.x        = 0,
+		.y        = 0,
+		.width    = glm::f32(FramebufferExtent.width),
+		.height   = glm::f32(FramebufferExtent.height),
+		.minDepth = 0.0f,
+		.maxDepth = 1.0f,
+	};
+	RenderCmd.setViewport(0, {OutputViewport});
+	RenderCmd.setScissor(0, {RenderArea});
+
+	// Draw!!
+	RenderCmd.draw(4, 1, 0, 0);
+
+	RenderCmd.endRenderPass();
+	////////////// Render pass end
+}
+
+// A region of the output layer that is rendered on its own when a frame is
+// split into tiles, along with the region of the input layer that it samples
+struct Tile
+{
+	vk::Rect2D Output    = {};
+	vk::Rect2D Footprint = {};
+};
+
+// Tiles are never split any smaller than this
+static constexpr std::uint32_t MinTileSize = 64;
+
+// The widest and the tallest of the footprints of `Tiles`, which every tile
+// shares a single input image of
+vk::Extent2D GetFootprintImageExtent(std::span<const Tile> Tiles)
+{
+	vk::Extent2D Result = {};
+	for( const Tile& CurTile : Tiles )
+	{
+		const vk::Extent2D& Footprint = CurTile.Footprint.extent;
+		Result.width  = std::max(Result.width, Footprint.width);
+		Result.height = std::max(Result.height, Footprint.height);
+	}
+	return Result;
+}
+
+// Whether the images of a frame are too large for the device to render the
+// frame all at once
+bool NeedsTiling(
+	const Vulkanator::GlobalParams& GlobalParam,
+	const vk::Extent3D& InputExtent, const vk::Extent3D& OutputExtent,
+	std::size_t PixelSize
+)
+{
+	const std::size_t ImageMemory
+		= (std::size_t(InputExtent.width) * InputExtent.height
+		   + std::size_t(OutputExtent.width) * OutputExtent.height)
+		* PixelSize;
+
+	return InputExtent.width > GlobalParam.MaxImageDimension
+		|| InputExtent.height > GlobalParam.MaxImageDimension
+		|| OutputExtent.width > GlobalParam.MaxImageDimension
+		|| OutputExtent.height > GlobalParam.MaxImageDimension
+		|| ImageMemory > GlobalParam.ImageMemoryBudget;
+}
+
+// Splits the output layer into the largest square tiles whose images, and the
+// images of their footprints, fit within the device's limits and budget
+// Returns no tiles at all if even the smallest tiles do not fit, such as when
+// the transform shrinks a very large input layer down into a few pixels
+std::vector<Tile> SplitIntoTiles(
+	const Vulkanator::GlobalParams& GlobalParam, const glm::f32mat4& Transform,
+	const vk::Extent2D& InputExtent, const vk::Extent2D& OutputExtent,
+	std::size_t PixelSize
+)
+{
+	for( std::uint32_t TileSize = GlobalParam.MaxImageDimension;
+		 TileSize >= MinTileSize; TileSize /= 2 )
+	{
+		std::vector<Tile> Tiles = {};
+		for( std::uint32_t CurY = 0; CurY < OutputExtent.height;
+			 CurY += TileSize )
+		{
+			for( std::uint32_t CurX = 0; CurX < OutputExtent.width;
+				 CurX += TileSize )
+			{
+				Tile& CurTile  = Tiles.emplace_back();
+				CurTile.Output = {
+					{std::int32_t(CurX), std::int32_t(CurY)},
+					{std::min(TileSize, OutputExtent.width - CurX),
+					 std::min(TileSize, OutputExtent.height - CurY)},
+				};
+				CurTile.Footprint = ComputeInputFootprint(
+					Transform, CurTile.Output, OutputExtent, InputExtent
+				);
+			}
+		}
+
+		// Every tile renders into a single output image the size of the first
+		// tile, which is always the largest one, and samples from a single
+		// input image that fits the largest footprint
+		const vk::Extent2D& TileExtent      = Tiles.front().Output.extent;
+		const vk::Extent2D  FootprintExtent = GetFootprintImageExtent(Tiles);
+		const std::size_t   TileMemory
+			= (std::size_t(TileExtent.width) * TileExtent.height
+			   + std::size_t(FootprintExtent.width) * FootprintExtent.height)
+			* PixelSize;
+
+		// Each tile is staged within a single region of the staging ring, with
+		// the upload placed ahead of the readback. Two tiles are in flight at
+		// any time
+		const vk::DeviceSize StagingSize
+			= TileMemory + Vulkanator::StagingRing::Alignment;
+
+		if( FootprintExtent.width <= GlobalParam.MaxImageDimension
+			&& FootprintExtent.height <= GlobalParam.MaxImageDimension
+			&& TileMemory <= GlobalParam.ImageMemoryBudget
+			&& StagingSize * 2 <= GlobalParam.Staging.GetCapacity() )
+		{
+			return Tiles;
+		}
+	}
+
+	return {};
+}
+
+// Renders a frame that is too large for the device to render all at once, one
+// tile of the output layer at a time
+// Each tile only uploads its footprint of the input layer. The transform is
+// then adjusted so that the footprint's image stands in for the input layer,
+// and the tile's image stands in for the output layer
+// The images are allocated once for every tile. While the GPU renders one
+// tile, the next one is staged and submitted, and the one before it is
+// stitched into the output layer
+PF_Err SmartRenderTiled(
+	Vulkanator::GlobalParams& GlobalParam, Vulkanator::RenderContext& Context,
+	Vulkanator::RenderParams& FrameParam, PF_Quality Quality,
+	PF_EffectWorld* InputLayer, PF_EffectWorld* OutputLayer
+)
+{
+	const std::size_t Depth        = FrameParam.Uniforms.Depth;
+	const vk::Format  RenderFormat = VulkanUtils::DepthToFormat(Depth);
+	const std::size_t PixelSize    = PixelSizes.at(Depth);
+
+	const vk::Extent2D InputExtent = {
+		.width  = static_cast<std::uint32_t>(InputLayer->width),
+		.height = static_cast<std::uint32_t>(InputLayer->height),
+	};
+	const vk::Extent2D OutputExtent = {
+		.width  = static_cast<std::uint32_t>(OutputLayer->width),
+		.height = static_cast<std::uint32_t>(OutputLayer->height),
+	};
+
+	const std::vector<Tile> Tiles = SplitIntoTiles(
+		GlobalParam, FrameParam.Uniforms.Transform, InputExtent, OutputExtent,
+		PixelSize
+	);
+
+	if( Tiles.empty() )
+	{
+		// Frame can not be split into tiles that fit on the device
+		return PF_Err_OUT_OF_MEMORY;
+	}
+
+	// Every tile renders into the top-left corner of an output image the size
+	// of the largest tile, and uploads its footprint into the top-left corner
+	// of an input image that fits the largest footprint
+	const vk::Extent2D TileImageExtent      = Tiles.front().Output.extent;
+	const vk::Extent2D FootprintImageExtent = GetFootprintImageExtent(Tiles);
+
+	// Tiles overwrite the input image with other parts of the input layer, and
+	// never sample from input textures
+	GlobalParam.Destruction.Retire(
+		std::exchange(Context.Cache.InputTexture, {})
+	);
+	Context.Cache.InputIdentity.reset();
+
+	// Tiles are recorded into the command buffers that frames otherwise re-use
+	Context.Recorded.reset();
+
+	GlobalParam.LastTransferPlan.store(
+		Vulkanator::TransferPlan::CachedReadback, std::memory_order_relaxed
+	);
+
+	if( !FootprintImageExtent.width || !FootprintImageExtent.height )
+	{
+		// Nothing from the input layer lands within the output layer
+		for( A_long CurRow = 0; CurRow < OutputLayer->height; ++CurRow )
+		{
+			std::memset(
+				static_cast<std::byte*>(OutputLayer->data)
+					+ std::size_t(OutputLayer->rowbytes) * CurRow,
+				0, std::size_t(OutputLayer->width) * PixelSize
+			);
+		}
+		return PF_Err_NONE;
+	}
+
+	// Create GPU-side Output Image, shared by every tile
 	const vk::ImageCreateInfo OutputImageInfo = {
 		.imageType   = vk::ImageType::e2D,
 		.format      = RenderFormat,
-		.extent      = OutputImageExtent,
+		.extent      = {TileImageExtent.width, TileImageExtent.height, 1},
 		.mipLevels   = 1,
 		.arrayLayers = 1,
 		.samples     = vk::SampleCountFlagBits::e1,
 		.tiling      = vk::ImageTiling::eOptimal,
-		.usage
-		// Will be transferring from this image into the staging buffer
-		= vk::ImageUsageFlagBits::eTransferSrc
-		// Will be rendering into this image within a render pass
-		| vk::ImageUsageFlagBits::eColorAttachment,
+		.usage       = vk::ImageUsageFlagBits::eColorAttachment
+				| vk::ImageUsageFlagBits::eTransferSrc,
 		.sharingMode   = vk::SharingMode::eExclusive,
 		.initialLayout = vk::ImageLayout::eUndefined,
 	};
 
-	if( OutputImageInfo == SequenceParam->Cache.OutputImageInfoCache )
-	{
-		// Cache Hit
-	}
-	else
-	{
-		// Cache Miss, recreate image
-		std::tie(
-			SequenceParam->Cache.OutputImage,
-			SequenceParam->Cache.OutputImageMemory
-		)
-			= VulkanUtils::AllocateImage(
-				  GlobalParam->Device.get(), GlobalParam->PhysicalDevice,
-				  OutputImageInfo, vk::MemoryPropertyFlagBits::eDeviceLocal
-			)
-				  .value();
-		SequenceParam->Cache.OutputImageInfoCache = OutputImageInfo;
-	}
+	if( !ReserveImage(
+			GlobalParam, Context.Cache, Context.Cache.Output, OutputImageInfo,
+			[&]() {
+				return VulkanUtils::AllocateImage(
+					GlobalParam.Allocator, OutputImageInfo,
+					vk::MemoryPropertyFlagBits::eDeviceLocal
+				);
+			}
+		) )
+	{
+		// Error allocating output image
+		return PF_Err_OUT_OF_MEMORY;
+	}
+
+	if( !ReserveFramebuffer(
+			GlobalParam, Context.Cache.Output,
+			GlobalParam.RenderPasses[Depth].get()
+		) )
+	{
+		// Error creating framebuffer
+		return PF_Err_INTERNAL_STRUCT_DAMAGED;
+	}
+
+	// Create GPU-side Input Image, shared by every tile
+	const vk::ImageCreateInfo InputImageInfo = {
+		.imageType = vk::ImageType::e2D,
+		.format    = RenderFormat,
+		.extent
+		= {FootprintImageExtent.width, FootprintImageExtent.height, 1},
+		.mipLevels   = 1,
+		.arrayLayers = 1,
+		.samples     = vk::SampleCountFlagBits::e1,
+		.tiling      = vk::ImageTiling::eOptimal,
+		.usage       = vk::ImageUsageFlagBits::eSampled
+				| vk::ImageUsageFlagBits::eTransferDst,
+		.sharingMode   = vk::SharingMode::eExclusive,
+		.initialLayout = vk::ImageLayout::eUndefined,
+	};
+
+	if( !ReserveImage(
+			GlobalParam, Context.Cache, Context.Cache.Input, InputImageInfo,
+			[&]() {
+				return VulkanUtils::AllocateImage(
+					GlobalParam.Allocator, InputImageInfo,
+					vk::MemoryPropertyFlagBits::eDeviceLocal
+				);
+			}
+		) )
+	{
+		// Error allocating input image
+		return PF_Err_OUT_OF_MEMORY;
+	}
+
+	if( !ReserveImageView(GlobalParam, Context.Cache.Input) )
+	{
+		// Error creating image view
+		return PF_Err_INTERNAL_STRUCT_DAMAGED;
+	}
+
+	// The input image stays the same for every tile, so its descriptor is
+	// only ever written once
+	BindInputImage(
+		GlobalParam, Context, Context.Cache.Input.View.get(),
+		Context.Cache.Input.ViewSerial,
+		GetInputImageSampler(GlobalParam, Quality),
+		vk::ImageLayout::eShaderReadOnlyOptimal
+	);
+
+	const std::byte* InputData
+		= static_cast<const std::byte*>(InputLayer->data);
+	std::byte* OutputData = static_cast<std::byte*>(OutputLayer->data);
+
+	const vk::CommandBufferBeginInfo BeginInfo = {
+		.flags = vk::CommandBufferUsageFlagBits::eOneTimeSubmit,
+	};
+
+	// Two tiles are in flight at once, each with its own command buffer and
+	// its own region of the staging ring. The region retires once the tile
+	// has been stitched
+	struct TileInFlight
+	{
+		const Tile*                            Source         = nullptr;
+		Vulkanator::StagingRing::Region        Staging        = {};
+		vk::DeviceSize                         ReadbackOffset = 0;
+		Vulkanator::SubmissionService::Request Request;
+	};
+	std::array<std::optional<TileInFlight>, 2> InFlight = {};
+
+	const std::array<vk::CommandBuffer, 2> TileCommandBuffers = {
+		Context.CommandBuffer.get(),
+		Context.PrologueCommandBuffer.get(),
+	};
+
+	// Waits on the tile of `Slot`, if there is one, and stitches it into the
+	// output layer
+	const auto FinishTile = [&](std::optional<TileInFlight>& Slot) -> bool {
+		if( !Slot )
+		{
+			return true;
+		}
+
+		const vk::Result WaitResult = Slot->Request.Wait();
+		if( WaitResult == vk::Result::eTimeout )
+		{
+			// The GPU may still be using the tile's staging region and the
+			// render context
+			GlobalParam.Destruction.Retire(std::move(Slot->Staging));
+			Context.Abandoned = true;
+		}
+
+		const bool Succeeded = WaitResult == vk::Result::eSuccess;
+		if( Succeeded )
+		{
+			const vk::Rect2D& TileOutput  = Slot->Source->Output;
+			const std::size_t TileRowSize = TileOutput.extent.width * PixelSize;
+			const std::byte*  TileReadbackMapping
+				= Slot->Staging.GetMapping() + Slot->ReadbackOffset;
+			std::byte* const TileOutputData
+				= OutputData
+				+ std::size_t(OutputLayer->rowbytes) * TileOutput.offset.y
+				+ TileOutput.offset.x * PixelSize;
+
+			//////////// Stitch the tile into the output layer
+			for( std::uint32_t CurRow = 0; CurRow < TileOutput.extent.height;
+				 ++CurRow )
+			{
+				std::memcpy(
+					TileOutputData
+						+ std::size_t(OutputLayer->rowbytes) * CurRow,
+					TileReadbackMapping + TileRowSize * CurRow, TileRowSize
+				);
+			}
+		}
+
+		Slot.reset();
+		return Succeeded;
+	};
+
+	// Every tile that was submitted has to be waited on before returning, even
+	// upon an error
+	const auto FinishTiles = [&]() -> bool {
+		bool Succeeded = true;
+		for( std::optional<TileInFlight>& Slot : InFlight )
+		{
+			if( !FinishTile(Slot) )
+			{
+				Succeeded = false;
+			}
+		}
+		return Succeeded;
+	};
+
+	for( std::size_t TileIndex = 0; TileIndex < Tiles.size(); ++TileIndex )
+	{
+		const Tile&       CurTile     = Tiles[TileIndex];
+		const vk::Rect2D& Footprint   = CurTile.Footprint;
+		const std::size_t TileRowSize = CurTile.Output.extent.width * PixelSize;
+
+		if( !Footprint.extent.width || !Footprint.extent.height )
+		{
+			// Nothing from the input layer lands within this tile
+			std::byte* const TileOutputData
+				= OutputData
+				+ std::size_t(OutputLayer->rowbytes) * CurTile.Output.offset.y
+				+ CurTile.Output.offset.x * PixelSize;
+			for( std::uint32_t CurRow = 0;
+				 CurRow < CurTile.Output.extent.height; ++CurRow )
+			{
+				std::memset(
+					TileOutputData
+						+ std::size_t(OutputLayer->rowbytes) * CurRow,
+					0, TileRowSize
+				);
+			}
+			continue;
+		}
+
+		// The command buffer and staging region of this slot were last used by
+		// the tile from two tiles ago, while the previous tile may still be
+		// rendering
+		std::optional<TileInFlight>& Slot = InFlight[TileIndex % 2];
+		const vk::CommandBuffer&     Cmd  = TileCommandBuffers[TileIndex % 2];
+		if( !FinishTile(Slot) )
+		{
+			// Error submitting or waiting on command buffer
+			FinishTiles();
+			return PF_Err_INTERNAL_STRUCT_DAMAGED;
+		}
+
+		// The footprint is uploaded from the start of the region, and the tile
+		// is read back right after it
+		const std::size_t FootprintRowSize = Footprint.extent.width * PixelSize;
+		const vk::DeviceSize ReadbackOffset = Vulkanator::StagingRing::Align(
+			FootprintRowSize * Footprint.extent.height
+		);
+
+		Vulkanator::StagingRing::Region TileStaging
+			= GlobalParam.Staging.Allocate(
+				ReadbackOffset + TileRowSize * CurTile.Output.extent.height
+			);
+		if( !TileStaging )
+		{
+			// Error allocating staging region
+			FinishTiles();
+			return PF_Err_OUT_OF_MEMORY;
+		}
+
+		// Pack the rows of the footprint tightly into the staging buffer
+		std::byte* const TileUploadMapping = TileStaging.GetMapping();
+		const std::byte* FootprintInputData
+			= InputData
+			+ std::size_t(InputLayer->rowbytes) * Footprint.offset.y
+			+ Footprint.offset.x * PixelSize;
+		for( std::uint32_t CurRow = 0; CurRow < Footprint.extent.height;
+			 ++CurRow )
+		{
+			std::memcpy(
+				TileUploadMapping + FootprintRowSize * CurRow,
+				FootprintInputData + std::size_t(InputLayer->rowbytes) * CurRow,
+				FootprintRowSize
+			);
+		}
+		GlobalParam.UploadStats.Bytes
+			+= FootprintRowSize * Footprint.extent.height;
+
+		// The quad is shrunk down onto just the footprint's region of the input
+		// layer, and its UVs onto the footprint's corner of the input image.
+		// And the tile's region of the output layer is stretched out over the
+		// entire tile image
+		const vk::Rect2D TileImageRegion = {
+			CurTile.Output.offset, TileImageExtent
+		};
+
+		auto TileUniforms      = FrameParam.Uniforms;
+		TileUniforms.Transform = ClipToRegion(TileImageRegion, OutputExtent)
+							   * FrameParam.Uniforms.Transform
+							   * RegionToClip(Footprint, InputExtent);
+		TileUniforms.CoordScale = glm::f32vec2(
+			glm::f32(Footprint.extent.width) / FootprintImageExtent.width,
+			glm::f32(Footprint.extent.height) / FootprintImageExtent.height
+		);
+
+		Cmd.reset(vk::CommandBufferResetFlagBits::eReleaseResources);
+		if( Cmd.begin(BeginInfo) != vk::Result::eSuccess )
+		{
+			// Error beginning command buffer
+			FinishTiles();
+			return PF_Err_INTERNAL_STRUCT_DAMAGED;
+		}
+
+		////// Upload staging buffer into Input Image
+		// The previous tile may still be sampling from the input image
+		const vk::ImageMemoryBarrier InputWriteBarrier = {
+			.srcAccessMask       = vk::AccessFlags(),
+			.dstAccessMask       = vk::AccessFlagBits::eTransferWrite,
+			.oldLayout           = vk::ImageLayout::eUndefined,
+			.newLayout           = vk::ImageLayout::eTransferDstOptimal,
+			.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+			.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+			.image               = Context.Cache.Input.Image.get(),
+			.subresourceRange    = ImageDefaultSubresourceRange,
+		};
+		Cmd.pipelineBarrier(
+			vk::PipelineStageFlagBits::eHost
+				| vk::PipelineStageFlagBits::eFragmentShader,
+			vk::PipelineStageFlagBits::eTransfer, vk::DependencyFlags(), {}, {},
+			{InputWriteBarrier}
+		);
+
+		// The rest of the input image holds whatever the other tiles left in
+		// it. Where there is room, the last column and row of the footprint are
+		// repeated once past it, so that filtering along the footprint's edges
+		// clamps just like it would if the footprint filled the entire image
+		const std::uint32_t FootprintWidth  = Footprint.extent.width;
+		const std::uint32_t FootprintHeight = Footprint.extent.height;
+		const vk::DeviceSize LastColumnOffset
+			= vk::DeviceSize(FootprintWidth - 1) * PixelSize;
+		const vk::DeviceSize LastRowOffset
+			= FootprintRowSize * (FootprintHeight - 1);
+		const bool RepeatColumn = FootprintWidth < FootprintImageExtent.width;
+		const bool RepeatRow    = FootprintHeight < FootprintImageExtent.height;
+
+		const auto FootprintCopy
+			= [&](vk::DeviceSize Offset, const vk::Offset3D& ImageOffset,
+				  const vk::Extent3D& ImageExtent) -> vk::BufferImageCopy {
+			return vk::BufferImageCopy{
+				.bufferOffset      = TileStaging.GetOffset() + Offset,
+				.bufferRowLength   = FootprintWidth,
+				.bufferImageHeight = FootprintHeight,
+				.imageSubresource  = ImageDefaultSubresourceLayer,
+				.imageOffset       = ImageOffset,
+				.imageExtent       = ImageExtent,
+			};
+		};
+
+		std::vector<vk::BufferImageCopy> InputBufferMappings = {
+			FootprintCopy(0, {}, {FootprintWidth, FootprintHeight, 1}),
+		};
+		if( RepeatColumn )
+		{
+			InputBufferMappings.emplace_back(FootprintCopy(
+				LastColumnOffset, {std::int32_t(FootprintWidth), 0, 0},
+				{1, FootprintHeight, 1}
+			));
+		}
+		if( RepeatRow )
+		{
+			InputBufferMappings.emplace_back(FootprintCopy(
+				LastRowOffset, {0, std::int32_t(FootprintHeight), 0},
+				{FootprintWidth, 1, 1}
+			));
+		}
+		if( RepeatColumn && RepeatRow )
+		{
+			InputBufferMappings.emplace_back(FootprintCopy(
+				LastRowOffset + LastColumnOffset,
+				{std::int32_t(FootprintWidth), std::int32_t(FootprintHeight),
+				 0},
+				{1, 1, 1}
+			));
+		}
+
+		Cmd.copyBufferToImage(
+			TileStaging.GetBuffer(), Context.Cache.Input.Image.get(),
+			vk::ImageLayout::eTransferDstOptimal, InputBufferMappings
+		);
+
+		// Ready the input image to be sampled from, and the output image to be
+		// rendered into. The previous tile may still be reading the output
+		// image back
+		const vk::ImageMemoryBarrier InputReadBarrier = {
+			.srcAccessMask       = vk::AccessFlagBits::eTransferWrite,
+			.dstAccessMask       = vk::AccessFlagBits::eShaderRead,
+			.oldLayout           = vk::ImageLayout::eTransferDstOptimal,
+			.newLayout           = vk::ImageLayout::eShaderReadOnlyOptimal,
+			.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+			.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+			.image               = Context.Cache.Input.Image.get(),
+			.subresourceRange    = ImageDefaultSubresourceRange,
+		};
+		const vk::ImageMemoryBarrier OutputWriteBarrier = {
+			.srcAccessMask       = vk::AccessFlags(),
+			.dstAccessMask       = vk::AccessFlagBits::eColorAttachmentWrite,
+			.oldLayout           = vk::ImageLayout::eUndefined,
+			.newLayout           = vk::ImageLayout::eColorAttachmentOptimal,
+			.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+			.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+			.image               = Context.Cache.Output.Image.get(),
+			.subresourceRange    = ImageDefaultSubresourceRange,
+		};
+		Cmd.pipelineBarrier(
+			vk::PipelineStageFlagBits::eTransfer,
+			vk::PipelineStageFlagBits::eFragmentShader
+				| vk::PipelineStageFlagBits::eColorAttachmentOutput,
+			vk::DependencyFlags(), {}, {},
+			{InputReadBarrier, OutputWriteBarrier}
+		);
+
+		//////// RENDERING COMMANDS HERE
+		RecordRenderPass(
+			Cmd, GlobalParam, Context, TileUniforms,
+			Context.Cache.Output.Framebuffer.get(), TileImageExtent,
+			{{0, 0}, CurTile.Output.extent}
+		);
+
+		////// Download Output Image into staging buffer
+		const vk::ImageMemoryBarrier OutputReadBarrier = {
+			.srcAccessMask       = vk::AccessFlagBits::eColorAttachmentWrite,
+			.dstAccessMask       = vk::AccessFlagBits::eTransferRead,
+			.oldLayout           = vk::ImageLayout::eTransferSrcOptimal,
+			.newLayout           = vk::ImageLayout::eTransferSrcOptimal,
+			.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+			.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+			.image               = Context.Cache.Output.Image.get(),
+			.subresourceRange    = ImageDefaultSubresourceRange,
+		};
+		Cmd.pipelineBarrier(
+			vk::PipelineStageFlagBits::eColorAttachmentOutput,
+			vk::PipelineStageFlagBits::eTransfer, vk::DependencyFlags(), {}, {},
+			{OutputReadBarrier}
+		);
+
+		const vk::BufferImageCopy OutputBufferMapping = {
+			.bufferOffset      = TileStaging.GetOffset() + ReadbackOffset,
+			.bufferRowLength   = 0,
+			.bufferImageHeight = 0,
+			.imageSubresource  = ImageDefaultSubresourceLayer,
+			.imageOffset       = {},
+			.imageExtent
+			= {CurTile.Output.extent.width, CurTile.Output.extent.height, 1},
+		};
+		Cmd.copyImageToBuffer(
+			Context.Cache.Output.Image.get(),
+			vk::ImageLayout::eTransferSrcOptimal, TileStaging.GetBuffer(),
+			{OutputBufferMapping}
+		);
+
+		// Make the transfer-writes visible to the host once the work completes
+		const vk::BufferMemoryBarrier ReadbackBarrier = {
+			.srcAccessMask       = vk::AccessFlagBits::eTransferWrite,
+			.dstAccessMask       = vk::AccessFlagBits::eHostRead,
+			.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+			.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+			.buffer              = TileStaging.GetBuffer(),
+			.offset              = TileStaging.GetOffset() + ReadbackOffset,
+			.size                = TileRowSize * CurTile.Output.extent.height,
+		};
+		Cmd.pipelineBarrier(
+			vk::PipelineStageFlagBits::eTransfer,
+			vk::PipelineStageFlagBits::eHost, vk::DependencyFlags(), {},
+			{ReadbackBarrier}, {}
+		);
+
+		if( Cmd.end() != vk::Result::eSuccess )
+		{
+			// Error ending command buffer
+			FinishTiles();
+			return PF_Err_INTERNAL_STRUCT_DAMAGED;
+		}
+
+		Context.Cache.Input.Layout = vk::ImageLayout::eShaderReadOnlyOptimal;
+
+		Slot.emplace();
+		Slot->Source             = &CurTile;
+		Slot->Staging            = std::move(TileStaging);
+		Slot->ReadbackOffset     = ReadbackOffset;
+		Slot->Request.SubmitInfo = {
+			.commandBufferCount = 1,
+			.pCommandBuffers    = &Cmd,
+		};
+		Slot->Request.QueueIndex = Vulkanator::GlobalParams::GraphicsQueueIndex;
+		GlobalParam.Submitter.Submit(Slot->Request);
+	}
+
+	if( !FinishTiles() )
+	{
+		// Error submitting or waiting on command buffer
+		return PF_Err_INTERNAL_STRUCT_DAMAGED;
+	}
+
+	return PF_Err_NONE;
+}
+
+// Pixels along each side of the tiles that the input layer is fingerprinted in
+static constexpr std::uint32_t InputTileSize = 128;
+
+// Regions of the input layer to upload into the input image
+struct InputTileUpload
+{
+	std::vector<vk::BufferImageCopy> Regions = {};
+	// Where the next tile is staged at
+	std::size_t   StagingOffset = 0;
+	std::uint64_t Bytes         = 0;
+	std::uint64_t Tiles         = 0;
+	std::uint64_t SkippedTiles  = 0;
+};
+
+// Fingerprints a single tile of the input layer
+Vulkanator::Hash128 HashInputTile(
+	const PF_EffectWorld& InputLayer, std::size_t PixelSize,
+	std::uint32_t TileX, std::uint32_t TileY
+)
+{
+	const std::uint32_t TileLeft = TileX * InputTileSize;
+	const std::uint32_t TileTop  = TileY * InputTileSize;
+	const std::uint32_t TileWidth
+		= std::min(InputTileSize, std::uint32_t(InputLayer.width) - TileLeft);
+	const std::uint32_t TileHeight
+		= std::min(InputTileSize, std::uint32_t(InputLayer.height) - TileTop);
+	const std::size_t RowBytes = std::size_t(InputLayer.rowbytes);
+	const std::byte*  TileData = static_cast<const std::byte*>(InputLayer.data)
+							  + RowBytes * TileTop + TileLeft * PixelSize;
+
+	Vulkanator::ContentHasher TileHasher;
+	for( std::uint32_t CurRow = 0; CurRow < TileHeight; ++CurRow )
+	{
+		TileHasher.Update(TileData + RowBytes * CurRow, TileWidth * PixelSize);
+	}
+	return TileHasher.Finalize();
+}
+
+// Fingerprints every tile of the input layer into `TileHashes`, and returns
+// the fingerprint of the entire input layer
+// Hashing has to stay cheaper than the upload that it may save, so the rows of
+// tiles are spread across After Effects' own worker threads
+// This is a pass of its own rather than part of staging the dirty tiles,
+// since everything that it decides comes before staging. The fingerprint of
+// the entire layer is the key of the result cache and of the texture cache,
+// and either of them may hold the layer already, which skips the upload
+// altogether. Only then is a texture reclaimed and a staging region
+// allocated, and which tiles are dirty depends on the reclaimed texture
+Vulkanator::Hash128 HashInputTiles(
+	PF_InData* in_data, PF_OutData* out_data, const PF_EffectWorld& InputLayer,
+	std::size_t PixelSize, std::span<Vulkanator::Hash128> TileHashes
+)
+{
+	struct HashTilesJob
+	{
+		const PF_EffectWorld&          InputLayer;
+		std::size_t                    PixelSize;
+		std::uint32_t                  TilesX;
+		std::span<Vulkanator::Hash128> TileHashes;
+	};
+
+	const std::uint32_t TilesX
+		= (std::uint32_t(InputLayer.width) + InputTileSize - 1) / InputTileSize;
+	const std::uint32_t TilesY
+		= (std::uint32_t(InputLayer.height) + InputTileSize - 1)
+		/ InputTileSize;
+
+	// Each iteration hashes an entire row of tiles
+	const auto HashTileRow
+		= [](void* RefCon, A_long, A_long TileY, A_long) -> PF_Err {
+		const HashTilesJob& Job = *static_cast<const HashTilesJob*>(RefCon);
+		for( std::uint32_t TileX = 0; TileX < Job.TilesX; ++TileX )
+		{
+			Job.TileHashes[std::size_t(TileY) * Job.TilesX + TileX]
+				= HashInputTile(
+					Job.InputLayer, Job.PixelSize, TileX, std::uint32_t(TileY)
+				);
+		}
+		return PF_Err_NONE;
+	};
+
+	HashTilesJob Job = {InputLayer, PixelSize, TilesX, TileHashes};
+
+	const AEFX_SuiteScoper<PF_Iterate8Suite2, true> IterateSuite(
+		in_data, kPFIterate8Suite, kPFIterate8SuiteVersion2, out_data
+	);
+	if( TilesY <= 1 || !IterateSuite.get()
+		|| IterateSuite->iterate_generic(A_long(TilesY), &Job, HashTileRow)
+			   != PF_Err_NONE )
+	{
+		for( std::uint32_t TileY = 0; TileY < TilesY; ++TileY )
+		{
+			HashTileRow(&Job, 0, A_long(TileY), A_long(TilesY));
+		}
+	}
+
+	return Vulkanator::ContentHasher::Hash(
+		TileHashes.data(), TileHashes.size_bytes()
+	);
+}
+
+// Uploads the tiles within rows [RowBegin, RowEnd) of the input layer whose
+// fingerprints in `TileHashes` differ from those in `PreviousTileHashes`, the
+// fingerprints of what the input image already holds. Every tile is uploaded
+// when `PreviousTileHashes` is empty
+// Dirty tiles are packed tightly into `Staging` and copied from there. Without
+// a staging buffer, the tiles are copied right out of the layer's imported
+// buffer at `BufferOffset`
+void UploadDirtyInputTiles(
+	const PF_EffectWorld& InputLayer, std::size_t PixelSize,
+	std::uint32_t RowBegin, std::uint32_t RowEnd,
+	std::span<const Vulkanator::Hash128> TileHashes,
+	std::span<const Vulkanator::Hash128> PreviousTileHashes, std::byte* Staging,
+	vk::DeviceSize BufferOffset, InputTileUpload& Upload
+)
+{
+	const std::uint32_t LayerWidth  = std::uint32_t(InputLayer.width);
+	const std::uint32_t LayerHeight = std::uint32_t(InputLayer.height);
+	const std::uint32_t TilesX
+		= (LayerWidth + InputTileSize - 1) / InputTileSize;
+	const std::size_t RowBytes = std::size_t(InputLayer.rowbytes);
+	const std::byte*  LayerData
+		= static_cast<const std::byte*>(InputLayer.data);
+
+	for( std::uint32_t TileY = RowBegin / InputTileSize;
+		 TileY * InputTileSize < RowEnd; ++TileY )
+	{
+		const std::uint32_t TileTop = TileY * InputTileSize;
+		const std::uint32_t TileHeight
+			= std::min(InputTileSize, LayerHeight - TileTop);
+
+		for( std::uint32_t TileX = 0; TileX < TilesX; ++TileX )
+		{
+			const std::uint32_t TileLeft = TileX * InputTileSize;
+			const std::uint32_t TileWidth
+				= std::min(InputTileSize, LayerWidth - TileLeft);
+			const std::size_t TileRowSize = TileWidth * PixelSize;
+			const std::byte*  TileData
+				= LayerData + RowBytes * TileTop + TileLeft * PixelSize;
+			const std::size_t TileIndex = std::size_t(TileY) * TilesX + TileX;
+
+			++Upload.Tiles;
+			if( !PreviousTileHashes.empty()
+				&& TileHashes[TileIndex] == PreviousTileHashes[TileIndex] )
+			{
+				// The input image already holds this tile
+				++Upload.SkippedTiles;
+				continue;
+			}
+
+			vk::BufferImageCopy& TileRegion = Upload.Regions.emplace_back();
+			TileRegion.imageSubresource     = ImageDefaultSubresourceLayer;
+			TileRegion.imageOffset.x        = std::int32_t(TileLeft);
+			TileRegion.imageOffset.y        = std::int32_t(TileTop);
+			TileRegion.imageExtent.width    = TileWidth;
+			TileRegion.imageExtent.height   = TileHeight;
+			TileRegion.imageExtent.depth    = 1;
+
+			if( Staging )
+			{
+				for( std::uint32_t CurRow = 0; CurRow < TileHeight; ++CurRow )
+				{
+					std::memcpy(
+						Staging + Upload.StagingOffset + TileRowSize * CurRow,
+						TileData + RowBytes * CurRow, TileRowSize
+					);
+				}
+				TileRegion.bufferOffset
+					= BufferOffset + Upload.StagingOffset;
+				TileRegion.bufferRowLength = 0;
+				Upload.StagingOffset += TileRowSize * TileHeight;
+			}
+			else
+			{
+				TileRegion.bufferOffset = BufferOffset + RowBytes * TileTop
+										+ TileLeft * PixelSize;
+				TileRegion.bufferRowLength
+					= std::uint32_t(RowBytes / PixelSize);
+			}
+
+			Upload.Bytes += TileRowSize * TileHeight;
+		}
+	}
+}
+
+// Gets the identity of the input layer that is checked out for the current
+// frame. Empty when After Effects is not able to provide the layer's state, in
+// which case only the tile fingerprints can tell what did not change
+std::optional<Vulkanator::InputLayerIdentity> GetInputLayerIdentity(
+	PF_InData* in_data, PF_OutData* out_data,
+	const Vulkanator::RenderParams& FrameParam
+)
+{
+	const AEFX_SuiteScoper<PF_ParamUtilsSuite3, true> ParamUtilsSuite(
+		in_data, kPFParamUtilsSuite, kPFParamUtilsSuiteVersion3, out_data
+	);
+	if( !ParamUtilsSuite.get() )
+	{
+		return std::nullopt;
+	}
+
+	Vulkanator::InputLayerIdentity Identity = {
+		.Rect        = FrameParam.InputRect,
+		.DownsampleX = in_data->downsample_x,
+		.DownsampleY = in_data->downsample_y,
+	};
+
+	// The same span of time that the input layer was checked out for
+	const A_Time StartTime = {in_data->current_time, in_data->time_scale};
+	const A_Time Duration  = {in_data->time_step, in_data->time_scale};
+	if( ParamUtilsSuite->PF_GetCurrentState(
+			in_data->effect_ref, Vulkanator::ParamID::Input, &StartTime,
+			&Duration, &Identity.State
+		)
+		!= PF_Err_NONE )
+	{
+		return std::nullopt;
+	}
+
+	return Identity;
+}
+
+// Determines if two input layers hold the very same pixels
+bool IsSameInputLayer(
+	PF_InData* in_data, PF_OutData* out_data,
+	const Vulkanator::InputLayerIdentity& A,
+	const Vulkanator::InputLayerIdentity& B
+)
+{
+	if( A.Rect.left != B.Rect.left || A.Rect.top != B.Rect.top
+		|| A.Rect.right != B.Rect.right || A.Rect.bottom != B.Rect.bottom )
+	{
+		return false;
+	}
+
+	if( A.DownsampleX.num != B.DownsampleX.num
+		|| A.DownsampleX.den != B.DownsampleX.den
+		|| A.DownsampleY.num != B.DownsampleY.num
+		|| A.DownsampleY.den != B.DownsampleY.den )
+	{
+		return false;
+	}
+
+	const AEFX_SuiteScoper<PF_ParamUtilsSuite3, true> ParamUtilsSuite(
+		in_data, kPFParamUtilsSuite, kPFParamUtilsSuiteVersion3, out_data
+	);
+	if( !ParamUtilsSuite.get() )
+	{
+		return false;
+	}
+
+	A_Boolean Identical = false;
+	if( ParamUtilsSuite->PF_AreStatesIdentical(
+			in_data->effect_ref, &A.State, &B.State, &Identical
+		)
+		!= PF_Err_NONE )
+	{
+		return false;
+	}
+
+	return Identical;
+}
+
+// Once a render has uploaded the input layer into its input texture, the
+// texture is published into the global texture cache, so that renders with
+// identical input layers sample it rather than uploading their own copy
+// Textures that were only read from are left as they are
+void PublishInputTexture(
+	Vulkanator::GlobalParams&                           GlobalParam,
+	const std::shared_ptr<Vulkanator::Texture>&         InputTexture,
+	const std::optional<Vulkanator::TextureCache::Key>& TextureKey,
+	bool ReadOnly, vk::ImageLayout Layout,
+	std::vector<Vulkanator::Hash128> TileHashes
+)
+{
+	if( ReadOnly || !InputTexture || !TextureKey )
+	{
+		return;
+	}
+
+	InputTexture->Layout     = Layout;
+	InputTexture->TileHashes = std::move(TileHashes);
+	GlobalParam.Textures.Insert(*TextureKey, InputTexture);
+}
+
+// Bumped whenever renders produce different pixels from the same inputs, such
+// as when the shaders change, so that stale frames are never loaded from the
+// on-disk result cache
+static constexpr std::uint32_t ResultCacheVersion = 1;
+
+// Fingerprints everything that the output pixels of a render depend on
+// The uniforms are hashed one field at a time since their padding bytes are
+// undefined
+Vulkanator::Hash128 GetResultKey(
+	const Vulkanator::Hash128&      InputHash,
+	const Vulkanator::RenderParams& FrameParam, PF_Quality Quality,
+	const vk::Extent3D& InputExtent, const vk::Extent3D& OutputExtent
+)
+{
+	Vulkanator::ContentHasher Hasher;
+
+	const auto HashValue = [&Hasher](const auto& Value) -> void {
+		Hasher.Update(&Value, sizeof(Value));
+	};
+	HashValue(ResultCacheVersion);
+	HashValue(InputHash);
+	HashValue(FrameParam.Uniforms.Depth);
+	HashValue(FrameParam.Uniforms.Transform);
+	HashValue(FrameParam.Uniforms.ColorFactor);
+	HashValue(Quality);
+	HashValue(InputExtent.width);
+	HashValue(InputExtent.height);
+	HashValue(OutputExtent.width);
+	HashValue(OutputExtent.height);
+
+	return Hasher.Finalize();
+}
+
+// Keeps the output layer of a completed render in the on-disk result cache
+void StoreRenderResult(
+	Vulkanator::GlobalParams&                  GlobalParam,
+	const std::optional<Vulkanator::Hash128>& ResultKey,
+	const PF_EffectWorld& OutputLayer, std::size_t PixelSize
+)
+{
+	if( !ResultKey )
+	{
+		return;
+	}
+
+	GlobalParam.Results.Store(
+		*ResultKey, std::uint32_t(OutputLayer.width),
+		std::uint32_t(OutputLayer.height), PixelSize,
+		static_cast<const std::byte*>(OutputLayer.data),
+		std::size_t(OutputLayer.rowbytes)
+	);
+}
+
+// Checks out a render context from a sequence's pool for the lifetime of this
+// object, creating a new one if every existing context is currently in-use
+// Abandoned contexts are retired instead of going back into the pool
+struct RenderContextLease
+{
+	Vulkanator::DestructionQueue&                  Destruction;
+	std::shared_ptr<Vulkanator::RenderContextPool> Pool;
+	std::unique_ptr<Vulkanator::RenderContext>     Context;
+
+	RenderContextLease(
+		Vulkanator::GlobalParams& Global, Vulkanator::SequenceParams& Sequence
+	)
+		: Destruction(Global.Destruction), Pool(Sequence.Contexts)
+	{
+		if( !Pool )
+		{
+			return;
+		}
+
+		// This sequence's caches are now the last ones to be evicted
+		Global.Memory.Touch(*Pool);
+
+		Context = Pool->AcquireContext();
+		if( !Context )
+		{
+			Context = CreateRenderContext(Global);
+		}
+	}
+
+	~RenderContextLease()
+	{
+		if( !Context )
+		{
+			return;
+		}
+
+		if( Context->Abandoned )
+		{
+			Destruction.Retire(std::move(Context));
+		}
+		else
+		{
+			Pool->ReleaseContext(std::move(Context));
+		}
+	}
+};
+
+PF_Err SmartRender(
+	PF_InData* in_data, PF_OutData* out_data, PF_SmartRenderExtra* extra
+)
+{
+	PF_Err err = PF_Err_NONE;
+
+	AEGP_SuiteHandler suites(in_data->pica_basicP);
+
+	PF_EffectWorld* InputLayer  = {};
+	PF_EffectWorld* OutputLayer = {};
+
+	// Checkout input/output layers
+	ERR(extra->cb->checkout_layer_pixels(
+		in_data->effect_ref, Vulkanator::ParamID::Input, &InputLayer
+	));
+	ERR(extra->cb->checkout_output(in_data->effect_ref, &OutputLayer));
+
+	if( !OutputLayer )
+		return PF_Err_NONE;
+
+	// Lock global handle
+	Vulkanator::GlobalParams* GlobalParam
+		= reinterpret_cast<Vulkanator::GlobalParams*>(*in_data->global_data);
+	Vulkanator::RenderParams* FrameParam
+		= reinterpret_cast<Vulkanator::RenderParams*>(
+			extra->input->pre_render_data
+		);
+
+	// With multi-frame rendering, sequence data is only available as a
+	// read-only handle during a render. The render context pool within it is
+	// internally synchronized though, so it is safe to share among threads
+	Vulkanator::SequenceParams* SequenceParam = nullptr;
+	if( in_data->sequence_data )
+	{
+		SequenceParam = reinterpret_cast<Vulkanator::SequenceParams*>(
+			*in_data->sequence_data
+		);
+	}
+	else
+	{
+		const AEFX_SuiteScoper<PF_EffectSequenceDataSuite1> SequenceDataSuite(
+			in_data, kPFEffectSequenceDataSuite,
+			kPFEffectSequenceDataSuiteVersion1, out_data
+		);
+		PF_ConstHandle ConstSequenceData = nullptr;
+		ERR(SequenceDataSuite->PF_GetConstSequenceData(
+			in_data->effect_ref, &ConstSequenceData
+		));
+
+		if( err || !ConstSequenceData )
+			return PF_Err_INTERNAL_STRUCT_DAMAGED;
+
+		SequenceParam = const_cast<Vulkanator::SequenceParams*>(
+			reinterpret_cast<const Vulkanator::SequenceParams*>(
+				*ConstSequenceData
+			)
+		);
+	}
+
+	++GlobalParam->SetupStats.Frames;
+
+	// Check out a render context for the duration of this render. It will be
+	// returned to the sequence's pool when this function returns
+	RenderContextLease ContextLease(*GlobalParam, *SequenceParam);
+	if( !ContextLease.Context )
+	{
+		// Error creating render context
+		return PF_Err_OUT_OF_MEMORY;
+	}
+	Vulkanator::RenderContext& Context = *ContextLease.Context;
+
+	/////// Get some traits about this render
+
+	const vk::Format RenderFormat
+		= VulkanUtils::DepthToFormat(FrameParam->Uniforms.Depth);
+
+	const std::size_t PixelSize = PixelSizes.at(FrameParam->Uniforms.Depth);
+
+	// Nothing from the input layer lands within the requested output, such as
+	// when it was transformed away
+	if( !InputLayer || !InputLayer->width || !InputLayer->height )
+	{
+		for( A_long CurRow = 0; CurRow < OutputLayer->height; ++CurRow )
+		{
+			std::memset(
+				static_cast<std::byte*>(OutputLayer->data)
+					+ std::size_t(OutputLayer->rowbytes) * CurRow,
+				0, std::size_t(OutputLayer->width) * PixelSize
+			);
+		}
+		return PF_Err_NONE;
+	}
+
+	const std::size_t InputLayerSize
+		= std::size_t(InputLayer->rowbytes) * InputLayer->height;
+	const std::size_t OutputLayerSize
+		= std::size_t(OutputLayer->rowbytes) * OutputLayer->height;
+
+	const vk::Extent3D InputImageExtent = {
+		.width  = static_cast<std::uint32_t>(InputLayer->width),
+		.height = static_cast<std::uint32_t>(InputLayer->height),
+		.depth  = 1,
+	};
+	const vk::Extent3D OutputImageExtent = {
+		.width  = static_cast<std::uint32_t>(OutputLayer->width),
+		.height = static_cast<std::uint32_t>(OutputLayer->height),
+		.depth  = 1,
+	};
+
+	// The staging rings are sized for this frame as it would be at full
+	// resolution, so that later full resolution renders fit in them as well
+	const double FullResolutionScale
+		= (double(in_data->downsample_x.den) / in_data->downsample_x.num)
+		* (double(in_data->downsample_y.den) / in_data->downsample_y.num);
+	if( !EnsureStagingRings(
+			*GlobalParam,
+			vk::DeviceSize(InputLayerSize * FullResolutionScale),
+			vk::DeviceSize(OutputLayerSize * FullResolutionScale)
+		) )
+	{
+		// Error allocating staging rings
+		return PF_Err_OUT_OF_MEMORY;
+	}
+
+	// Frames that go beyond the device's image limits, or that would take up
+	// too much of its memory, are rendered one tile at a time
+	if( NeedsTiling(
+			*GlobalParam, InputImageExtent, OutputImageExtent, PixelSize
+		) )
+	{
+		return SmartRenderTiled(
+			*GlobalParam, Context, *FrameParam, in_data->quality, InputLayer,
+			OutputLayer
+		);
+	}
+
+	Vulkanator::TransferPlan Plan = SelectTransferPlan(
+		*GlobalParam, FrameParam->Uniforms.Depth, InputImageExtent,
+		OutputImageExtent
+	);
+
+	// With host image copies or direct linear images, the CPU writes the input
+	// image and reads the output image directly. Neither the staging buffers
+	// nor any GPU-side copies are involved
+	const bool HostImageCopy = Plan == Vulkanator::TransferPlan::HostImageCopy;
+	const bool DirectLinear  = Plan == Vulkanator::TransferPlan::DirectLinear;
+	const bool HostAccess    = HostImageCopy || DirectLinear;
+
+	// When the input layer is identical to the one that the input image was
+	// last uploaded from, such as when only the effect's parameters changed or
+	// the layer is held on the same frame, then none of it is uploaded again
+	// The identity is only put back into the cache once the render completes
+	const std::optional<Vulkanator::InputLayerIdentity> InputIdentity
+		= GetInputLayerIdentity(in_data, out_data, *FrameParam);
+	bool InputUnchanged = InputIdentity && Context.Cache.InputIdentity
+					   && IsSameInputLayer(
+							  in_data, out_data, *InputIdentity,
+							  *Context.Cache.InputIdentity
+					   );
+	std::optional<Vulkanator::Hash128> InputHash
+		= InputUnchanged ? Context.Cache.InputHash : std::nullopt;
+	Context.Cache.InputIdentity.reset();
+	Context.Cache.InputHash.reset();
+
+	const std::size_t InputTilesX
+		= (InputImageExtent.width + InputTileSize - 1) / InputTileSize;
+	const std::size_t InputTilesY
+		= (InputImageExtent.height + InputTileSize - 1) / InputTileSize;
+	const std::size_t InputTileCount = InputTilesX * InputTilesY;
+
+	// Fingerprints of each tile of the input layer, once hashed
+	std::vector<Vulkanator::Hash128> InputTileHashes = {};
+
+	// When this exact frame was rendered before, possibly by an earlier
+	// session, its output is copied straight out of the on-disk result cache
+	// without involving the GPU at all
+	std::optional<Vulkanator::Hash128> ResultKey = {};
+	if( GlobalParam->Results.IsOpen() )
+	{
+		if( !InputHash )
+		{
+			InputTileHashes.resize(InputTileCount);
+			InputHash = HashInputTiles(
+				in_data, out_data, *InputLayer, PixelSize, InputTileHashes
+			);
+		}
+
+		ResultKey = GetResultKey(
+			*InputHash, *FrameParam, in_data->quality, InputImageExtent,
+			OutputImageExtent
+		);
+
+		if( GlobalParam->Results.Load(
+				*ResultKey, OutputImageExtent.width, OutputImageExtent.height,
+				PixelSize, static_cast<std::byte*>(OutputLayer->data),
+				std::size_t(OutputLayer->rowbytes)
+			) )
+		{
+			// The input image was left untouched
+			if( InputUnchanged )
+			{
+				Context.Cache.InputIdentity = InputIdentity;
+				Context.Cache.InputHash     = InputHash;
+			}
+			return PF_Err_NONE;
+		}
+	}
+
+	// Zero-copy path
+	// When the device is able to import host memory, the input and output
+	// layers' pixels may be imported as buffers and the GPU copies directly
+	// from and into After Effects' memory. Every import creates a buffer and
+	// allocates device memory, and the commands that refer to it can not be
+	// submitted again. So layers are only imported when the frame would not
+	// fit within the staging ring otherwise. Whichever layer can not be
+	// imported falls back to going through the staging buffer
+	vk::UniqueBuffer       InputHostBuffer        = {};
+	vk::UniqueDeviceMemory InputHostBufferMemory  = {};
+	vk::UniqueBuffer       OutputHostBuffer       = {};
+	vk::UniqueDeviceMemory OutputHostBufferMemory = {};
+
+	// Only layers whose pixels and rows are aligned to what the device is able
+	// to import are imported. Anything else is staged
+	const vk::DeviceSize ImportAlignment
+		= GlobalParam->Features.MinImportedHostPointerAlignment;
+	const auto IsImportable = [&](const PF_EffectWorld& Layer) -> bool {
+		const std::uintptr_t Address
+			= reinterpret_cast<std::uintptr_t>(Layer.data);
+		return ImportAlignment && (Address % ImportAlignment) == 0
+			&& (std::size_t(Layer.rowbytes) % ImportAlignment) == 0;
+	};
+
+	const vk::DeviceSize StagedFrameSize
+		= Vulkanator::StagingRing::Align(InputLayerSize) + OutputLayerSize;
+	if( !HostAccess && GlobalParam->Features.ExternalMemoryHost
+		&& StagedFrameSize > GlobalParam->Staging.GetCapacity() )
+	{
+		// An unchanged input layer is never copied from, so it is not imported
+		if( !InputUnchanged && IsImportable(*InputLayer) )
+		{
+			// A buffer, and the memory that it imports
+			const CountedSetupCall Counter{GlobalParam->SetupStats, 2};
+			if( auto ImportResult = VulkanUtils::ImportHostBuffer(
+					GlobalParam->Device.get(), GlobalParam->PhysicalDevice,
+					GlobalParam->Dispatcher, InputLayer->data, InputLayerSize,
+					vk::BufferUsageFlagBits::eTransferSrc, ImportAlignment
+				);
+				ImportResult )
+			{
+				std::tie(InputHostBuffer, InputHostBufferMemory)
+					= std::move(ImportResult.value());
+			}
+		}
+
+		if( IsImportable(*OutputLayer) )
+		{
+			const CountedSetupCall Counter{GlobalParam->SetupStats, 2};
+			if( auto ImportResult = VulkanUtils::ImportHostBuffer(
+					GlobalParam->Device.get(), GlobalParam->PhysicalDevice,
+					GlobalParam->Dispatcher, OutputLayer->data, OutputLayerSize,
+					vk::BufferUsageFlagBits::eTransferDst, ImportAlignment
+				);
+				ImportResult )
+			{
+				std::tie(OutputHostBuffer, OutputHostBufferMemory)
+					= std::move(ImportResult.value());
+			}
+		}
+	}
+
+	const bool StageInput  = !HostAccess && !InputHostBuffer;
+	const bool StageOutput = !HostAccess && !OutputHostBuffer;
+
+	// Frames that have to be staged, but that do not fit within the staging
+	// ring all at once, are streamed through it one tile at a time
+	const vk::DeviceSize FullStagingSize
+		= (StageInput ? Vulkanator::StagingRing::Align(InputLayerSize) : 0u)
+		+ (StageOutput ? OutputLayerSize : 0u);
+	if( FullStagingSize > GlobalParam->Staging.GetCapacity() )
+	{
+		return SmartRenderTiled(
+			*GlobalParam, Context, *FrameParam, in_data->quality, InputLayer,
+			OutputLayer
+		);
+	}
+
+	// High level process:
+	// InputLayer->data -memcpy->>> Upload region of a staging ring(Vulkan)
+	// -vkCmdCopyBufferToImage->>> InputImage(Vulkan)
+	// <Render into Output Image, using InputImage> OutputImage
+	// -vkCmdCopyImageToBuffer->>> Readback region of the staging ring(Vulkan)
+	// -memcpy->>> OutputLayer->data
+	//
+	// The CPU only ever writes the upload region sequentially, which
+	// write-combined memory is good at. But reading from write-combined memory
+	// is very slow, so the readback region is always within the host-cached
+	// ring. The regions retire once this render has waited on its GPU work.
+	//
+	// The write-combined ring is always allocated from before the host-cached
+	// ring, and never while holding a region of the host-cached ring, so that
+	// renders waiting on either ring to free up never wait on each other
+
+	Vulkanator::StagingRing::Region UploadStaging = {};
+	if( Plan == Vulkanator::TransferPlan::WriteCombinedUpload && StageInput )
+	{
+		UploadStaging = GlobalParam->WriteCombinedStaging.Allocate(
+			InputLayerSize
+		);
+		if( !UploadStaging )
+		{
+			// The write-combined ring may not be available, or is too small
+			// for this frame, fall back to staging through host memory
+			Plan = Vulkanator::TransferPlan::CachedReadback;
+		}
+	}
+
+	// Both the upload and the readback share a single region of the
+	// host-cached ring
+	const vk::DeviceSize CachedUploadSize
+		= (StageInput && !UploadStaging)
+			? Vulkanator::StagingRing::Align(InputLayerSize)
+			: 0u;
+	const vk::DeviceSize CachedReadbackSize
+		= StageOutput ? OutputLayerSize : 0u;
+
+	Vulkanator::StagingRing::Region CachedStaging = {};
+	if( CachedUploadSize + CachedReadbackSize )
+	{
+		CachedStaging = GlobalParam->Staging.Allocate(
+			CachedUploadSize + CachedReadbackSize
+		);
+		if( !CachedStaging )
+		{
+			// Error allocating staging region
+			return PF_Err_OUT_OF_MEMORY;
+		}
+	}
+
+	if( CachedUploadSize )
+	{
+		UploadStaging = std::move(CachedStaging);
+	}
+
+	GlobalParam->LastTransferPlan.store(Plan, std::memory_order_relaxed);
+
+	// Buffers that the GPU will be copying the input layer from, and copying
+	// the output layer into
+	const vk::Buffer UploadBuffer
+		= StageInput ? UploadStaging.GetBuffer() : InputHostBuffer.get();
+	const vk::DeviceSize UploadBufferOffset
+		= StageInput ? UploadStaging.GetOffset() : 0u;
+	std::byte* const UploadMapping
+		= StageInput ? UploadStaging.GetMapping() : nullptr;
+
+	// When the upload and the readback share a region, the readback is placed
+	// after the upload
+	const Vulkanator::StagingRing::Region& ReadbackStaging
+		= CachedUploadSize ? UploadStaging : CachedStaging;
+	const vk::Buffer ReadbackBuffer
+		= StageOutput ? ReadbackStaging.GetBuffer() : OutputHostBuffer.get();
+	const vk::DeviceSize ReadbackBufferOffset
+		= StageOutput ? ReadbackStaging.GetOffset() + CachedUploadSize : 0u;
+	std::byte* const ReadbackMapping
+		= StageOutput ? ReadbackStaging.GetMapping() + CachedUploadSize
+					  : nullptr;
+
+	const vk::Rect2D OutputRect2D = {
+		{0, 0},
+		{
+			std::uint32_t(OutputLayer->width),
+			std::uint32_t(OutputLayer->height),
+		},
+	};
+
+	// Create GPU-side Input Image
+
+	const vk::ImageCreateInfo InputImageInfo = {
+		.imageType   = vk::ImageType::e2D,
+		.format      = RenderFormat,
+		.extent      = InputImageExtent,
+		.mipLevels   = 1,
+		.arrayLayers = 1,
+		.samples     = vk::SampleCountFlagBits::e1,
+		// Linear images may be written to by the host through a mapping
+		.tiling = DirectLinear ? vk::ImageTiling::eLinear
+							   : vk::ImageTiling::eOptimal,
+		// Will be sampling from this image
+		.usage = vk::ImageUsageFlagBits::eSampled
+			   // Will be transferring from the staging buffer into this one
+			   | (HostAccess ? vk::ImageUsageFlags()
+							 : vk::ImageUsageFlagBits::eTransferSrc
+								   | vk::ImageUsageFlagBits::eTransferDst)
+			   // Will be written to by the host directly
+			   | (HostImageCopy ? vk::ImageUsageFlagBits::eHostTransferEXT
+								: vk::ImageUsageFlags()),
+		.sharingMode = vk::SharingMode::eExclusive,
+		// The host may only write into linear images that are in either the
+		// preinitialized or general layout
+		.initialLayout = DirectLinear ? vk::ImageLayout::ePreinitialized
+									  : vk::ImageLayout::eUndefined,
+	};
+
+	// The image that gets sampled from, and the layout that it is in before
+	// this render
+	vk::Image       InputImage       = {};
+	vk::ImageLayout InputPriorLayout = vk::ImageLayout::eUndefined;
+
+	// When the GPU copies the input layer into the input image, the input
+	// image is a texture that is looked up by the contents of the input layer,
+	// so that identical input layers of other effect instances are only ever
+	// uploaded once. When there is no such texture yet, only the tiles that
+	// differ from what a re-usable texture already holds get uploaded
+	std::shared_ptr<Vulkanator::Texture>         InputTexture       = {};
+	std::optional<Vulkanator::TextureCache::Key> InputTextureKey    = {};
+	std::vector<Vulkanator::Hash128>             PreviousTileHashes = {};
+
+	if( HostAccess )
+	{
+		// Host-accessed input images belong to this render context alone
+		GlobalParam->Destruction.Retire(
+			std::exchange(Context.Cache.InputTexture, {})
+		);
+
+		const vk::MemoryPropertyFlags InputImageProperties
+			= DirectLinear ? vk::MemoryPropertyFlagBits::eHostVisible
+							   | vk::MemoryPropertyFlagBits::eHostCoherent
+						   : vk::MemoryPropertyFlagBits::eDeviceLocal;
+
+		// Any other image holds the input layer of some other render
+		if( InputImageInfo != Context.Cache.Input.Info )
+		{
+			InputUnchanged = false;
+		}
+
+		if( !ReserveImage(
+				*GlobalParam, Context.Cache, Context.Cache.Input,
+				InputImageInfo,
+				[&]() {
+					return VulkanUtils::AllocateImage(
+						GlobalParam->Allocator, InputImageInfo,
+						InputImageProperties
+					);
+				}
+			) )
+		{
+			// Error allocating input image
+			return PF_Err_OUT_OF_MEMORY;
+		}
+
+		InputImage       = Context.Cache.Input.Image.get();
+		InputPriorLayout = Context.Cache.Input.Layout;
+	}
+	else
+	{
+		// The render context's own input image is not needed anymore, but a
+		// later render may still be able to use it
+		if( Context.Cache.Input.Image )
+		{
+			ParkSpare(
+				GlobalParam->Destruction, Context.Cache.SpareImages,
+				std::exchange(Context.Cache.Input, {})
+			);
+		}
+
+		if( InputUnchanged && Context.Cache.InputTexture
+			&& Context.Cache.InputTexture->Info == InputImageInfo )
+		{
+			// The texture of the previous render already holds the input layer
+			InputTexture = Context.Cache.InputTexture;
+		}
+		else
+		{
+			InputUnchanged = false;
+
+			if( InputTileHashes.empty() )
+			{
+				InputTileHashes.resize(InputTileCount);
+				InputHash = HashInputTiles(
+					in_data, out_data, *InputLayer, PixelSize, InputTileHashes
+				);
+			}
+			InputTextureKey = Vulkanator::TextureCache::Key{
+				.Hash   = *InputHash,
+				.Format = RenderFormat,
+				.Extent = InputImageExtent,
+			};
+
+			InputTexture = GlobalParam->Textures.Find(*InputTextureKey);
+		}
+
+		if( InputTexture )
+		{
+			// Another render already uploaded these exact pixels
+			InputUnchanged = true;
+		}
+		else if( (InputTexture = GlobalParam->Textures.Reclaim(
+					  InputImageInfo, Context.Cache.InputTexture
+				  )) )
+		{
+			// Only the tiles that differ from the reclaimed texture's contents
+			// get uploaded. The fingerprints are only put back once the upload
+			// has completed, so that any failure leaves them empty
+			PreviousTileHashes = std::exchange(InputTexture->TileHashes, {});
+			if( PreviousTileHashes.size() != InputTileCount )
+			{
+				PreviousTileHashes.clear();
+			}
+		}
+		else if( auto ImageResult = AllocateWithEviction(
+					 *GlobalParam,
+					 [&]() {
+						 const CountedSetupCall Counter{
+							 GlobalParam->SetupStats, 1
+						 };
+						 return VulkanUtils::AllocateImage(
+							 GlobalParam->Allocator, InputImageInfo,
+							 vk::MemoryPropertyFlagBits::eDeviceLocal
+						 );
+					 }
+				 );
+				 ImageResult.has_value() )
+		{
+			InputTexture       = std::make_shared<Vulkanator::Texture>();
+			InputTexture->Info = InputImageInfo;
+			std::tie(InputTexture->Image, InputTexture->Memory)
+				= std::move(ImageResult.value());
+			InputTexture->Size = InputTexture->Memory.GetSize();
+		}
+		else
+		{
+			// Error allocating input image
+			return PF_Err_OUT_OF_MEMORY;
+		}
+
+		if( !InputTexture->View
+			&& !CreateImageView(
+				*GlobalParam, InputTexture->Image.get(), RenderFormat,
+				InputTexture->View, InputTexture->ViewSerial
+			) )
+		{
+			// Error creating image view
+			return PF_Err_INTERNAL_STRUCT_DAMAGED;
+		}
+
+		if( Context.Cache.InputTexture != InputTexture )
+		{
+			GlobalParam->Destruction.Retire(
+				std::exchange(Context.Cache.InputTexture, InputTexture)
+			);
+		}
+
+		InputImage       = InputTexture->Image.get();
+		InputPriorLayout = InputTexture->Layout;
+	}
+
+	// Whether the input image keeps any of its current contents
+	const bool InputKept = InputUnchanged || !PreviousTileHashes.empty();
+
+	std::byte* const InputTileStaging = UploadMapping;
+	InputTileUpload Upload = {};
+	if( InputUnchanged && !HostAccess )
+	{
+		Upload.Tiles        = InputTileCount;
+		Upload.SkippedTiles = InputTileCount;
+	}
+
+	// Input textures get their view as soon as they are allocated, while the
+	// render context's own input image gets its view the first time it is
+	// used. Either way, the view lives for as long as the image does
+	if( !InputTexture && !ReserveImageView(*GlobalParam, Context.Cache.Input) )
+	{
+		// Error creating image view
+		return PF_Err_INTERNAL_STRUCT_DAMAGED;
+	}
+	const vk::ImageView InputImageView
+		= InputTexture ? InputTexture->View.get()
+					   : Context.Cache.Input.View.get();
+	const std::uint64_t InputImageViewSerial
+		= InputTexture ? InputTexture->ViewSerial
+					   : Context.Cache.Input.ViewSerial;
+
+	// Create GPU-side Output Image
+	const vk::ImageCreateInfo OutputImageInfo = {
+		.imageType   = vk::ImageType::e2D,
+		.format      = RenderFormat,
+		.extent      = OutputImageExtent,
+		.mipLevels   = 1,
+		.arrayLayers = 1,
+		.samples     = vk::SampleCountFlagBits::e1,
+		// Linear images may be read from by the host through a mapping
+		.tiling = DirectLinear ? vk::ImageTiling::eLinear
+							   : vk::ImageTiling::eOptimal,
+		.usage
+		// Will be rendering into this image within a render pass
+		= vk::ImageUsageFlagBits::eColorAttachment
+		// Will be transferring from this image into the staging buffer, and
+		// the render pass leaves it in the transfer-src layout
+		| vk::ImageUsageFlagBits::eTransferSrc
+		// Will be read from by the host directly
+		| (HostImageCopy ? vk::ImageUsageFlagBits::eHostTransferEXT
+						 : vk::ImageUsageFlags()),
+		.sharingMode   = vk::SharingMode::eExclusive,
+		.initialLayout = vk::ImageLayout::eUndefined,
+	};
+
+	if( !ReserveImage(
+			*GlobalParam, Context.Cache, Context.Cache.Output, OutputImageInfo,
+			[&]() {
+				auto Result = VulkanUtils::AllocateImage(
+					GlobalParam->Allocator, OutputImageInfo,
+					DirectLinear
+						? vk::MemoryPropertyFlagBits::eHostVisible
+							  | vk::MemoryPropertyFlagBits::eHostCoherent
+							  | vk::MemoryPropertyFlagBits::eHostCached
+						: vk::MemoryPropertyFlagBits::eDeviceLocal
+				);
+
+				// Host-cached memory is much faster for the CPU to read from,
+				// but not every device has it
+				if( !Result && DirectLinear )
+				{
+					Result = VulkanUtils::AllocateImage(
+						GlobalParam->Allocator, OutputImageInfo,
+						vk::MemoryPropertyFlagBits::eHostVisible
+							| vk::MemoryPropertyFlagBits::eHostCoherent
+					);
+				}
+				return Result;
+			}
+		) )
+	{
+		// Error allocating output image
+		return PF_Err_OUT_OF_MEMORY;
+	}
+
+	// This provides a mapping between the image contents and the staging buffer
+	const vk::BufferImageCopy OutputBufferMapping = {
+		.bufferOffset      = ReadbackBufferOffset,
+		.bufferRowLength   = std::uint32_t(OutputLayer->rowbytes / PixelSize),
+		.bufferImageHeight = 0,
+		.imageSubresource  = ImageDefaultSubresourceLayer,
+		.imageOffset       = {},
+		.imageExtent       = OutputImageExtent,
+	};
+
+	// The output image's view and framebuffer are created the first time that
+	// it is rendered into, and kept for as long as the image is
+	if( !ReserveFramebuffer(
+			*GlobalParam, Context.Cache.Output,
+			GlobalParam->RenderPasses[FrameParam->Uniforms.Depth].get()
+		) )
+	{
+		// Error creating framebuffer
+		return PF_Err_INTERNAL_STRUCT_DAMAGED;
+	}
+	const vk::Framebuffer OutputFramebuffer
+		= Context.Cache.Output.Framebuffer.get();
+
+	// The input image will ideally be in "shader read only optimal" by the
+	// time it is sampled, immediately after we are done uploading the texture
+	// to the GPU
+	// Host image copies may only be able to write into the general layout, and
+	// the host may only ever write into linear images in the general layout
+	const vk::ImageLayout InputImageLayout
+		= DirectLinear  ? vk::ImageLayout::eGeneral
+		: HostImageCopy ? GlobalParam->Features.HostImageUploadLayout
+						: vk::ImageLayout::eShaderReadOnlyOptimal;
+
+	// Likewise for the layout that the host reads the output image from
+	const vk::ImageLayout OutputImageHostLayout
+		= DirectLinear ? vk::ImageLayout::eGeneral
+					   : GlobalParam->Features.HostImageReadbackLayout;
+
+	// Only written into the descriptor set when any of it changed since the
+	// previous render of this render context
+	BindInputImage(
+		*GlobalParam, Context, InputImageView, InputImageViewSerial,
+		GetInputImageSampler(*GlobalParam, in_data->quality), InputImageLayout
+	);
+
+	// Large frames are split into bands, so that the CPU may copy a band in or
+	// out while the GPU works on another band
+	const bool Banded = (StageInput && InputLayerSize >= BandedFrameSize)
+					 || (StageOutput && OutputLayerSize >= BandedFrameSize);
+
+	// Copy the dirty tiles of the input layer into the upload staging buffer
+	// Banded frames are copied in one band at a time as they are submitted
+	if( !HostAccess && !Banded && !InputUnchanged )
+	{
+		UploadDirtyInputTiles(
+			*InputLayer, PixelSize, 0, InputImageExtent.height, InputTileHashes,
+			PreviousTileHashes, InputTileStaging, UploadBufferOffset, Upload
+		);
+	}
+
+	// Or write the input layer into the linear input image directly
+	if( DirectLinear && !InputUnchanged
+		&& !VulkanUtils::WriteLinearImage(
+			GlobalParam->Device.get(), InputImage,
+			Context.Cache.Input.Memory, InputLayer->data,
+			InputLayer->rowbytes, InputImageExtent.width * PixelSize,
+			InputImageExtent.height
+		) )
+	{
+		// Error writing input image
+		return PF_Err_INTERNAL_STRUCT_DAMAGED;
+	}
+
+	// Or write the input layer into the input image directly
+	if( HostImageCopy && !InputUnchanged )
+	{
+		const vk::HostImageLayoutTransitionInfoEXT InputImageTransition = {
+			.image            = InputImage,
+			.oldLayout        = vk::ImageLayout::eUndefined,
+			.newLayout        = InputImageLayout,
+			.subresourceRange = ImageDefaultSubresourceRange,
+		};
+
+		if( GlobalParam->Device->transitionImageLayoutEXT(
+				{InputImageTransition}, GlobalParam->Dispatcher
+			)
+			!= vk::Result::eSuccess )
+		{
+			// Error transitioning input image
+			return PF_Err_INTERNAL_STRUCT_DAMAGED;
+		}
+
+		const vk::MemoryToImageCopyEXT InputImageRegion = {
+			.pHostPointer      = InputLayer->data,
+			.memoryRowLength   = std::uint32_t(InputLayer->rowbytes / PixelSize),
+			.memoryImageHeight = 0,
+			.imageSubresource  = ImageDefaultSubresourceLayer,
+			.imageOffset       = {},
+			.imageExtent       = InputImageExtent,
+		};
+
+		const vk::CopyMemoryToImageInfoEXT InputImageCopy = {
+			.dstImage       = InputImage,
+			.dstImageLayout = InputImageLayout,
+			.regionCount    = 1,
+			.pRegions       = &InputImageRegion,
+		};
+
+		if( GlobalParam->Device->copyMemoryToImageEXT(
+				InputImageCopy, GlobalParam->Dispatcher
+			)
+			!= vk::Result::eSuccess )
+		{
+			// Error uploading input image
+			return PF_Err_INTERNAL_STRUCT_DAMAGED;
+		}
+	}
+
+	// Allocate input and output buffers
+
+	// When the GPU work of this render times out, the GPU may still be using
+	// everything that it was recorded with. None of it may be freed or re-used
+	// until the GPU is done with it
+	const auto AbandonRender = [&]() -> void {
+		GlobalParam->Destruction.Retire(std::move(UploadStaging));
+		GlobalParam->Destruction.Retire(std::move(CachedStaging));
+		GlobalParam->Destruction.Retire(std::move(InputHostBuffer));
+		GlobalParam->Destruction.Retire(std::move(InputHostBufferMemory));
+		GlobalParam->Destruction.Retire(std::move(OutputHostBuffer));
+		GlobalParam->Destruction.Retire(std::move(OutputHostBufferMemory));
+		GlobalParam->Destruction.Retire(std::move(InputTexture));
+		Context.Abandoned = true;
+	};
+
+	//////////// Render
+
+	if( Banded )
+	{
+		// Banded frames are pipelined in two phases
+		// Upload: The CPU copies input band k+1 into the staging buffer while
+		// the GPU copies input band k into the input image
+		// Render: The CPU copies output band k-1 out of the staging buffer
+		// while the GPU renders and copies out output band k
+		// Since the transform may sample from anywhere in the input image,
+		// rendering only begins once the entire input image is uploaded
+		// Layers that do not go through a staging buffer are a single band
+		// Unchanged input textures may be shared with other renders, so they
+		// are only ever read from and have no bands at all
+		std::vector<Band> InputBands = {};
+		if( StageInput && !InputUnchanged )
+		{
+			// Bands of the input layer are made of entire rows of tiles
+			InputBands = SplitIntoBands(
+				InputImageExtent.height, InputLayer->rowbytes, InputTileSize
+			);
+		}
+		else if( !InputUnchanged )
+		{
+			InputBands = {{.Height = InputImageExtent.height}};
+		}
+
+		std::vector<Band> OutputBands = {{.Height = OutputImageExtent.height}};
+		if( StageOutput )
+		{
+			OutputBands = SplitIntoBands(
+				OutputImageExtent.height, OutputLayer->rowbytes
+			);
+		}
+
+		// Allocate more band command buffers if needed
+		const std::size_t BandCount = InputBands.size() + OutputBands.size();
+		if( Context.BandCommandBuffers.size() < BandCount )
+		{
+			const std::size_t NewBandCount
+				= BandCount - Context.BandCommandBuffers.size();
+			const CountedSetupCall Counter{
+				GlobalParam->SetupStats, NewBandCount
+			};
+
+			const vk::CommandBufferAllocateInfo BandCommandBufferInfo = {
+				.commandPool        = Context.CommandPool.get(),
+				.level              = vk::CommandBufferLevel::ePrimary,
+				.commandBufferCount = std::uint32_t(NewBandCount),
+			};
+
+			if( auto AllocResult
+				= GlobalParam->Device->allocateCommandBuffersUnique(
+					BandCommandBufferInfo
+				);
+				AllocResult.result == vk::Result::eSuccess )
+			{
+				for( vk::UniqueCommandBuffer& CurCmd : AllocResult.value )
+				{
+					Context.BandCommandBuffers.emplace_back(std::move(CurCmd));
+				}
+			}
+			else
+			{
+				// Error allocating command buffers
+				return PF_Err_OUT_OF_MEMORY;
+			}
+		}
+
+		const vk::CommandBufferBeginInfo BandBeginInfo = {
+			.flags = vk::CommandBufferUsageFlagBits::eOneTimeSubmit,
+		};
+
+		// Each band is submitted as soon as it is recorded. Requests can not
+		// be moved around once submitted, which a deque guarantees
+		std::deque<Vulkanator::SubmissionService::Request> BandRequests;
+
+		// Once anything is submitted, every request has to be waited on before
+		// returning. So any error only stops further bands from being submitted
+		bool BandFailed = false;
+
+		const auto BeginBand = [&](std::size_t BandIndex) -> vk::CommandBuffer {
+			vk::CommandBuffer BandCmd
+				= Context.BandCommandBuffers[BandIndex].get();
+			BandCmd.reset(vk::CommandBufferResetFlagBits::eReleaseResources);
+			if( BandCmd.begin(BandBeginInfo) != vk::Result::eSuccess )
+			{
+				BandFailed = true;
+			}
+			return BandCmd;
+		};
+
+		const auto SubmitBand = [&](std::size_t BandIndex) -> void {
+			if( Context.BandCommandBuffers[BandIndex]->end()
+				!= vk::Result::eSuccess )
+			{
+				BandFailed = true;
+				return;
+			}
+			Vulkanator::SubmissionService::Request& BandRequest
+				= BandRequests.emplace_back();
+			BandRequest.SubmitInfo = {
+				.commandBufferCount = 1,
+				.pCommandBuffers = &Context.BandCommandBuffers[BandIndex].get(),
+			};
+			BandRequest.QueueIndex
+				= Vulkanator::GlobalParams::GraphicsQueueIndex;
+			GlobalParam->Submitter.Submit(BandRequest);
+		};
+
+		////// Upload phase
+		for( std::size_t i = 0; i < InputBands.size() && !BandFailed; ++i )
+		{
+			const Band&       CurBand = InputBands[i];
+			const std::size_t BandOffset
+				= std::size_t(InputLayer->rowbytes) * CurBand.Offset;
+
+			// Dirty tiles of this band are staged within the band's own
+			// region of the staging buffer
+			Upload.Regions.clear();
+			Upload.StagingOffset = BandOffset;
+			UploadDirtyInputTiles(
+				*InputLayer, PixelSize, CurBand.Offset,
+				CurBand.Offset + CurBand.Height, InputTileHashes,
+				PreviousTileHashes, InputTileStaging, UploadBufferOffset, Upload
+			);
+
+			const vk::CommandBuffer BandCmd = BeginBand(i);
+			if( BandFailed )
+			{
+				break;
+			}
+
+			if( i == 0 )
+			{
+				// Get Input Image ready to be written to, keeping the contents
+				// of the tiles that are not uploaded again
+				const vk::ImageMemoryBarrier InputWriteBarrier = {
+					.srcAccessMask       = vk::AccessFlags(),
+					.dstAccessMask       = vk::AccessFlagBits::eTransferWrite,
+					.oldLayout           = InputKept
+											 ? InputPriorLayout
+											 : vk::ImageLayout::eUndefined,
+					.newLayout           = vk::ImageLayout::eTransferDstOptimal,
+					.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+					.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+					.image               = InputImage,
+					.subresourceRange    = ImageDefaultSubresourceRange,
+				};
+				BandCmd.pipelineBarrier(
+					vk::PipelineStageFlagBits::eHost
+						| vk::PipelineStageFlagBits::eFragmentShader,
+					vk::PipelineStageFlagBits::eTransfer, vk::DependencyFlags(),
+					{}, {}, {InputWriteBarrier}
+				);
+			}
+
+			// Upload this band's dirty tiles into the Input Image
+			if( !Upload.Regions.empty() )
+			{
+				BandCmd.copyBufferToImage(
+					UploadBuffer, InputImage,
+					vk::ImageLayout::eTransferDstOptimal, Upload.Regions
+				);
+			}
+
+			SubmitBand(i);
+		}
+
+		////// Render phase
+		for( std::size_t i = 0; i < OutputBands.size() && !BandFailed; ++i )
+		{
+			const Band&       CurBand    = OutputBands[i];
+			const std::size_t BandIndex  = InputBands.size() + i;
+			const std::size_t BandOffset
+				= std::size_t(OutputLayer->rowbytes) * CurBand.Offset;
+
+			const vk::CommandBuffer BandCmd = BeginBand(BandIndex);
+			if( BandFailed )
+			{
+				break;
+			}
+
+			if( i == 0 )
+			{
+				// The upload is complete, ready the input image to be sampled
+				// from, and the output image to be rendered into
+				const vk::ImageMemoryBarrier InputReadBarrier = {
+					.srcAccessMask       = vk::AccessFlagBits::eTransferWrite,
+					.dstAccessMask       = vk::AccessFlagBits::eShaderRead,
+					.oldLayout           = vk::ImageLayout::eTransferDstOptimal,
+					.newLayout           = InputImageLayout,
+					.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+					.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+					.image               = InputImage,
+					.subresourceRange    = ImageDefaultSubresourceRange,
+				};
+				const vk::ImageMemoryBarrier OutputWriteBarrier = {
+					.srcAccessMask = vk::AccessFlags(),
+					.dstAccessMask = vk::AccessFlagBits::eColorAttachmentWrite,
+					.oldLayout     = vk::ImageLayout::eUndefined,
+					.newLayout     = vk::ImageLayout::eColorAttachmentOptimal,
+					.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+					.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+					.image               = Context.Cache.Output.Image.get(),
+					.subresourceRange    = ImageDefaultSubresourceRange,
+				};
+				std::vector<vk::ImageMemoryBarrier> RenderBarriers
+					= {OutputWriteBarrier};
+				if( !InputUnchanged )
+				{
+					RenderBarriers.emplace_back(InputReadBarrier);
+				}
+				BandCmd.pipelineBarrier(
+					vk::PipelineStageFlagBits::eTransfer,
+					vk::PipelineStageFlagBits::eFragmentShader
+						| vk::PipelineStageFlagBits::eColorAttachmentOutput,
+					vk::DependencyFlags(), {}, {}, RenderBarriers
+				);
+			}
+			else
+			{
+				// The previous band left the output image in transfer-src
+				// layout. Unlike the first band, the earlier bands' pixels
+				// have to be kept
+				const vk::ImageMemoryBarrier OutputWriteBarrier = {
+					.srcAccessMask = vk::AccessFlagBits::eTransferRead,
+					.dstAccessMask = vk::AccessFlagBits::eColorAttachmentWrite,
+					.oldLayout     = vk::ImageLayout::eTransferSrcOptimal,
+					.newLayout     = vk::ImageLayout::eColorAttachmentOptimal,
+					.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+					.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+					.image               = Context.Cache.Output.Image.get(),
+					.subresourceRange    = ImageDefaultSubresourceRange,
+				};
+				BandCmd.pipelineBarrier(
+					vk::PipelineStageFlagBits::eTransfer,
+					vk::PipelineStageFlagBits::eColorAttachmentOutput,
+					vk::DependencyFlags(), {}, {}, {OutputWriteBarrier}
+				);
+			}
+
+			const vk::Rect2D BandRect = {
+				{0, std::int32_t(CurBand.Offset)},
+				{OutputImageExtent.width, CurBand.Height},
+			};
+			RecordRenderPass(
+				BandCmd, *GlobalParam, Context, FrameParam->Uniforms,
+				OutputFramebuffer, OutputRect2D.extent, BandRect
+			);
+
+			////// Download this band's rows into the staging buffer
+			const vk::ImageMemoryBarrier OutputReadBarrier = {
+				.srcAccessMask = vk::AccessFlagBits::eColorAttachmentWrite,
+				.dstAccessMask = vk::AccessFlagBits::eTransferRead,
+				.oldLayout     = vk::ImageLayout::eTransferSrcOptimal,
+				.newLayout     = vk::ImageLayout::eTransferSrcOptimal,
+				.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+				.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+				.image               = Context.Cache.Output.Image.get(),
+				.subresourceRange    = ImageDefaultSubresourceRange,
+			};
+			BandCmd.pipelineBarrier(
+				vk::PipelineStageFlagBits::eColorAttachmentOutput,
+				vk::PipelineStageFlagBits::eTransfer, vk::DependencyFlags(), {},
+				{}, {OutputReadBarrier}
+			);
+
+			const vk::BufferImageCopy BandMapping = {
+				.bufferOffset = ReadbackBufferOffset + BandOffset,
+				.bufferRowLength
+				= std::uint32_t(OutputLayer->rowbytes / PixelSize),
+				.bufferImageHeight = 0,
+				.imageSubresource  = ImageDefaultSubresourceLayer,
+				.imageOffset       = {0, std::int32_t(CurBand.Offset), 0},
+				.imageExtent = {OutputImageExtent.width, CurBand.Height, 1},
+			};
+			BandCmd.copyImageToBuffer(
+				Context.Cache.Output.Image.get(),
+				vk::ImageLayout::eTransferSrcOptimal, ReadbackBuffer,
+				{BandMapping}
+			);
+
+			// Make the transfer-writes visible to the host once this band
+			// completes
+			const vk::BufferMemoryBarrier ReadbackBarrier = {
+				.srcAccessMask       = vk::AccessFlagBits::eTransferWrite,
+				.dstAccessMask       = vk::AccessFlagBits::eHostRead,
+				.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+				.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+				.buffer              = ReadbackBuffer,
+				.offset              = ReadbackBufferOffset,
+				.size                = OutputLayerSize,
+			};
+			BandCmd.pipelineBarrier(
+				vk::PipelineStageFlagBits::eTransfer,
+				vk::PipelineStageFlagBits::eHost, vk::DependencyFlags(), {},
+				{ReadbackBarrier}, {}
+			);
+
+			SubmitBand(BandIndex);
+		}
+
+		// Wait on each band in the order that they were submitted, copying
+		// each output band out while the GPU works on the next one
+		bool BandTimedOut = false;
+		for( std::size_t i = 0; i < BandRequests.size(); ++i )
+		{
+			const vk::Result WaitResult = BandRequests[i].Wait();
+			if( WaitResult != vk::Result::eSuccess )
+			{
+				BandFailed = true;
+				BandTimedOut |= WaitResult == vk::Result::eTimeout;
+			}
+
+			if( BandFailed || !StageOutput || i < InputBands.size() )
+			{
+				continue;
+			}
+
+			const Band&       CurBand = OutputBands[i - InputBands.size()];
+			const std::size_t BandOffset
+				= std::size_t(OutputLayer->rowbytes) * CurBand.Offset;
+			std::memcpy(
+				static_cast<std::byte*>(OutputLayer->data) + BandOffset,
+				ReadbackMapping + BandOffset,
+				std::size_t(OutputLayer->rowbytes) * CurBand.Height
+			);
+		}
+
+		if( BandTimedOut )
+		{
+			AbandonRender();
+		}
 
-	// This provides a mapping between the image contents and the staging buffer
-	const vk::BufferImageCopy OutputBufferMapping = {
-		.bufferOffset      = 0,
-		.bufferRowLength   = std::uint32_t(OutputLayer->rowbytes / PixelSize),
-		.bufferImageHeight = 0,
-		.imageSubresource  = ImageDefaultSubresourceLayer,
-		.imageOffset       = {},
-		.imageExtent       = OutputImageExtent,
-	};
+		if( BandFailed )
+		{
+			// Error recording, submitting, or waiting on a band
+			return PF_Err_INTERNAL_STRUCT_DAMAGED;
+		}
 
-	// Output image view, this is used to create an interpretation of a certain
-	// aspect of the image This allows things like having a 2D image array but
-	// creating a view around just one of the images
-	const vk::ImageViewCreateInfo OutputImageViewInfo = {
-		// The target image we are making a view of
-		.image    = SequenceParam->Cache.OutputImage.get(),
-		.viewType = vk::ImageViewType::e2D,
-		.format   = RenderFormat,
-		// Swizzling of color channels used during reading/sampling
-		.components       = {},
-		.subresourceRange = ImageDefaultSubresourceRange,
-	};
+		PublishInputTexture(
+			*GlobalParam, InputTexture, InputTextureKey, InputUnchanged,
+			InputImageLayout, std::move(InputTileHashes)
+		);
+		Context.Cache.InputIdentity = InputIdentity;
+		Context.Cache.InputHash     = InputHash;
+		GlobalParam->UploadStats.Bytes += Upload.Bytes;
+		GlobalParam->UploadStats.Tiles += Upload.Tiles;
+		GlobalParam->UploadStats.SkippedTiles += Upload.SkippedTiles;
 
-	vk::UniqueImageView OutputImageView = {};
-	if( auto ImageViewResult
-		= GlobalParam->Device->createImageViewUnique(OutputImageViewInfo);
-		ImageViewResult.result == vk::Result::eSuccess )
-	{
-		OutputImageView = std::move(ImageViewResult.value);
+		StoreRenderResult(*GlobalParam, ResultKey, *OutputLayer, PixelSize);
+		return err;
 	}
-	else
+
+	// When the GPU is copying the layers in and out, and the device has a
+	// dedicated transfer queue, then the copies run on the transfer queue.
+	// The images then have to change ownership between the queue families, and
+	// semaphores order the upload, render, and readback
+	// Banded frames stay on the graphics queue, rather than handing the images
+	// back and forth between queue families for every band
+	// Input images that retain their contents from a previous render stay on
+	// the graphics queue that last used them as well
+	const bool SplitTransfer = GlobalParam->DedicatedTransferQueue
+							&& !HostAccess && !Banded && !InputKept;
+
+	const std::uint32_t GraphicsFamily
+		= SplitTransfer ? GlobalParam->GraphicsQueueFamily
+						: VK_QUEUE_FAMILY_IGNORED;
+	const std::uint32_t TransferFamily
+		= SplitTransfer ? GlobalParam->TransferQueueFamily
+						: VK_QUEUE_FAMILY_IGNORED;
+
+	// Render pass commands, recorded every frame
+	const vk::CommandBuffer Cmd = Context.CommandBuffer.get();
+	// Commands before and after the render pass, re-used across frames
+	const vk::CommandBuffer PrologueCmd = Context.PrologueCommandBuffer.get();
+	const vk::CommandBuffer EpilogueCmd = Context.EpilogueCommandBuffer.get();
+	// Upload and Readback commands
+	const vk::CommandBuffer UploadCmd
+		= SplitTransfer ? Context.UploadCommandBuffer.get() : PrologueCmd;
+	const vk::CommandBuffer ReadbackCmd
+		= SplitTransfer ? Context.ReadbackCommandBuffer.get() : EpilogueCmd;
+
+	// Imported host buffers are created for every frame that imports, and a
+	// later import may get the same handle, so commands that refer to them are
+	// never submitted again
+	std::optional<Vulkanator::RenderContext::RecordedCommands> Recording = {};
+	if( !InputHostBuffer && !OutputHostBuffer )
 	{
-		// Error creating image view
-		return PF_Err_INTERNAL_STRUCT_DAMAGED;
+		Recording = Vulkanator::RenderContext::RecordedCommands{
+			.InputViewSerial  = InputImageViewSerial,
+			.OutputViewSerial = Context.Cache.Output.ViewSerial,
+			.InputPriorLayout = InputPriorLayout,
+			.Plan             = Plan,
+			.InputUnchanged   = InputUnchanged,
+			.InputKept        = InputKept,
+			.SplitTransfer    = SplitTransfer,
+			.UploadBuffer     = UploadBuffer,
+			.UploadOffset     = UploadBufferOffset,
+			.InputLayerSize   = InputLayerSize,
+			.ReadbackBuffer   = ReadbackBuffer,
+			.ReadbackOffset   = ReadbackBufferOffset,
+			.OutputLayerSize  = OutputLayerSize,
+			.OutputRowLength  = OutputBufferMapping.bufferRowLength,
+			.UploadRegions    = Upload.Regions,
+		};
 	}
-	///////
-
-	// Create input image sampler
 
-	// Port After Effect's quality setting over into the sampler setting
-	vk::Filter LayerFilter = {};
-	switch( in_data->quality )
-	{
-	// Low quality -> Nearest interpolation
-	case PF_Quality_LO:
+	const bool ReuseCommands = Recording && Context.Recorded == Recording;
+	if( !ReuseCommands )
 	{
-		LayerFilter = vk::Filter::eNearest;
-		break;
+		// The re-usable commands are about to be recorded again, and are not
+		// in a state to be submitted until that succeeds
+		Context.Recorded.reset();
 	}
-	// High quality -> Linear interpolation
-	default:
-	case PF_Quality_HI:
+
+	std::vector<vk::CommandBuffer> ReusableCommandBuffers = {};
+	if( !ReuseCommands )
 	{
-		LayerFilter = vk::Filter::eLinear;
-		break;
-	}
+		ReusableCommandBuffers = {PrologueCmd, EpilogueCmd};
+		if( SplitTransfer )
+		{
+			ReusableCommandBuffers.emplace_back(UploadCmd);
+			ReusableCommandBuffers.emplace_back(ReadbackCmd);
+		}
 	}
 
-	const vk::SamplerCreateInfo InputImageSamplerInfo = {
-		.magFilter    = LayerFilter,
-		.minFilter    = LayerFilter,
-		.addressModeU = vk::SamplerAddressMode::eClampToEdge,
-		.addressModeV = vk::SamplerAddressMode::eClampToEdge,
-		.addressModeW = vk::SamplerAddressMode::eClampToEdge,
-	};
+	const std::chrono::steady_clock::time_point RecordBegin
+		= std::chrono::steady_clock::now();
 
-	if( auto SamplerResult
-		= GlobalParam->Device->createSamplerUnique(InputImageSamplerInfo);
-		SamplerResult.result == vk::Result::eSuccess )
+	// Without the one-time-submit flag, since these are submitted again by
+	// later renders. Renders of the same render context never overlap, so
+	// they are never pending more than once
+	const vk::CommandBufferBeginInfo ReusableBeginInfo = {};
+	for( const vk::CommandBuffer& CurCmd : ReusableCommandBuffers )
 	{
-		FrameParam->InputImageSampler = std::move(SamplerResult.value);
+		CurCmd.reset(vk::CommandBufferResetFlags());
+
+		if( auto BeginResult = CurCmd.begin(ReusableBeginInfo);
+			BeginResult != vk::Result::eSuccess )
+		{
+			// Error beginning command buffer
+			return PF_Err_INTERNAL_STRUCT_DAMAGED;
+		}
 	}
-	else
+
+	if( !ReuseCommands )
 	{
-		// Error creating sampler object
-		return PF_Err_INTERNAL_STRUCT_DAMAGED;
-	}
+		////// Upload staging buffer into Input Image
 
-	// Write combined image+sampler object into the descriptor set
-	// Here, we combine both the sampler and the image, and we state the format
-	// that the image will be in by the time this sampler will be in-use, which
-	// is ideally "shader read only optimal" immediately after we are done
-	// uploading the texture to the GPU
-	const vk::DescriptorImageInfo InputImageSamplerWrite{
-		.sampler     = FrameParam->InputImageSampler.get(),
-		.imageView   = InputImageView.get(),
-		.imageLayout = vk::ImageLayout::eShaderReadOnlyOptimal,
-	};
-
-	// Write the image sampler to the descriptor set
-	GlobalParam->Device->updateDescriptorSets(
-		{vk::WriteDescriptorSet{
-			.dstSet          = SequenceParam->DescriptorSet.get(),
-			.dstBinding      = 1,
-			.dstArrayElement = 0,
-			.descriptorCount = 1,
-			.descriptorType  = vk::DescriptorType::eCombinedImageSampler,
-			.pImageInfo      = &InputImageSamplerWrite,
-		}},
-		{}
-	);
+		// Output Image is going to be written to as a color attachment within
+		// a render pass
+		std::vector<vk::ImageMemoryBarrier> RenderImageBarriers = {
+			vk::ImageMemoryBarrier{
+				.srcAccessMask       = vk::AccessFlags(),
+				.dstAccessMask       = vk::AccessFlagBits::eColorAttachmentWrite,
+				.oldLayout           = vk::ImageLayout::eUndefined,
+				.newLayout           = vk::ImageLayout::eColorAttachmentOptimal,
+				.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+				.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+				.image               = Context.Cache.Output.Image.get(),
+				.subresourceRange    = ImageDefaultSubresourceRange,
+			},
+		};
 
-	// Create Render pass Framebuffer, this maps the Output buffer as a color
-	// attachment for a Renderpass to render into You can add more attachments
-	// of different formats, but they must all have the same width,height,layers
-	// Framebuffers will define the image data that render passes will be able
-	// to address in total
-	const vk::FramebufferCreateInfo OutputFramebufferInfo = {
+		// When the host wrote the input image directly, it is already in the
+		// layout that it will be sampled in
+		if( DirectLinear )
+		{
+			// Linear images are written through a mapping while in the
+			// general layout. The first time around, it is still in its
+			// preinitialized layout. Host-writes before the submission are
+			// already visible to the device
+			RenderImageBarriers.emplace_back(vk::ImageMemoryBarrier{
+				.srcAccessMask       = vk::AccessFlags(),
+				.dstAccessMask       = vk::AccessFlagBits::eShaderRead,
+				.oldLayout           = InputPriorLayout,
+				.newLayout           = InputImageLayout,
+				.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+				.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+				.image               = InputImage,
+				.subresourceRange    = ImageDefaultSubresourceRange,
+			});
+		}
+		// Unchanged input textures may be shared with other renders, so they
+		// are never written to or transitioned. They are already in the
+		// layout that they will be sampled in
+		else if( !HostImageCopy && !InputUnchanged )
+		{
+			// Layout transitions, prepare to copy
+			// Transfer buffers into images
+			UploadCmd.pipelineBarrier(
+				vk::PipelineStageFlagBits::eHost
+					| vk::PipelineStageFlagBits::eFragmentShader,
+				vk::PipelineStageFlagBits::eTransfer, vk::DependencyFlags(), {},
+				{
+					// Get staging buffer ready for a read
+					vk::BufferMemoryBarrier{
+						.srcAccessMask       = vk::AccessFlags(),
+						.dstAccessMask       = vk::AccessFlagBits::eTransferRead,
+						.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+						.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+						.buffer              = UploadBuffer,
+						.offset              = UploadBufferOffset,
+						.size                = InputLayerSize,
+					},
+				},
+				{
+					// Get Input Image ready to be written to, keeping the
+					// contents of the tiles that are not uploaded again
+					vk::ImageMemoryBarrier{
+						.srcAccessMask = vk::AccessFlags(),
+						.dstAccessMask = vk::AccessFlagBits::eTransferWrite,
+						.oldLayout     = InputKept
+										   ? InputPriorLayout
+										   : vk::ImageLayout::eUndefined,
+						.newLayout     = vk::ImageLayout::eTransferDstOptimal,
+						.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+						.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+						.image            = InputImage,
+						.subresourceRange = ImageDefaultSubresourceRange
+					},
+				}
+			);
 
-		// This is for the framebuffer to know what ~~~compatible~~~
-		// renderpasses
-		// will be rendered into it
-		// https://www.khronos.org/registry/vulkan/specs/1.2-extensions/html/vkspec.html#renderpass-compatibility
-		.renderPass
-		= GlobalParam->RenderPasses[FrameParam->Uniforms.Depth].get(),
-		.attachmentCount = 1,
-		.pAttachments    = &OutputImageView.get(),
+			// Upload the dirty tiles of the input layer into the Input Image
+			if( !Upload.Regions.empty() )
+			{
+				UploadCmd.copyBufferToImage(
+					UploadBuffer, InputImage,
+					vk::ImageLayout::eTransferDstOptimal, Upload.Regions
+				);
+			}
 
-		// Specify the width, height, and layers that the framebuffer image
-		// attachments are;
-		.width  = static_cast<std::uint32_t>(OutputLayer->width),
-		.height = static_cast<std::uint32_t>(OutputLayer->height),
-		.layers = 1,
-	};
+			// Input Image is going to be read
+			const vk::ImageMemoryBarrier InputReadBarrier = {
+				.srcAccessMask       = vk::AccessFlagBits::eTransferWrite,
+				.dstAccessMask       = vk::AccessFlagBits::eShaderRead,
+				.oldLayout           = vk::ImageLayout::eTransferDstOptimal,
+				.newLayout           = vk::ImageLayout::eShaderReadOnlyOptimal,
+				.srcQueueFamilyIndex = TransferFamily,
+				.dstQueueFamilyIndex = GraphicsFamily,
+				.image               = InputImage,
+				.subresourceRange    = ImageDefaultSubresourceRange,
+			};
+
+			if( SplitTransfer )
+			{
+				// Release the input image from the transfer queue's family.
+				// The graphics queue acquires it after waiting on the upload
+				vk::ImageMemoryBarrier InputReleaseBarrier = InputReadBarrier;
+				InputReleaseBarrier.dstAccessMask          = vk::AccessFlags();
+				UploadCmd.pipelineBarrier(
+					vk::PipelineStageFlagBits::eTransfer,
+					vk::PipelineStageFlagBits::eBottomOfPipe,
+					vk::DependencyFlags(), {}, {}, {InputReleaseBarrier}
+				);
+
+				vk::ImageMemoryBarrier InputAcquireBarrier = InputReadBarrier;
+				InputAcquireBarrier.srcAccessMask          = vk::AccessFlags();
+				RenderImageBarriers.emplace_back(InputAcquireBarrier);
+			}
+			else
+			{
+				RenderImageBarriers.emplace_back(InputReadBarrier);
+			}
+		}
 
-	vk::UniqueFramebuffer OutputFramebuffer = {};
-	if( auto FramebufferResult
-		= GlobalParam->Device->createFramebufferUnique(OutputFramebufferInfo);
-		FramebufferResult.result == vk::Result::eSuccess )
-	{
-		OutputFramebuffer = std::move(FramebufferResult.value);
-	}
-	else
-	{
-		// Error creating framebuffer
-		return PF_Err_INTERNAL_STRUCT_DAMAGED;
-	}
+		// Layout transitions, copy is complete, ready input image to be sampled
+		// from
+		PrologueCmd.pipelineBarrier(
+			vk::PipelineStageFlagBits::eTransfer,
+			vk::PipelineStageFlagBits::eFragmentShader
+				| vk::PipelineStageFlagBits::eColorAttachmentOutput,
+			vk::DependencyFlags(), {}, {}, RenderImageBarriers
+		);
 
-	// Copy Input image data into staging buffer, but keep it mapped, as we will
-	// read the output image data from it later too
-	void* StagingBufferMapping = nullptr;
+		//////// The render pass is recorded in between, every frame
 
-	if( auto MapResult = GlobalParam->Device->mapMemory(
-			SequenceParam->Cache.StagingBufferMemory.get(), 0, VK_WHOLE_SIZE
-		);
-		MapResult.result == vk::Result::eSuccess )
-	{
-		StagingBufferMapping = MapResult.value;
+		if( HostAccess )
+		{
+			// The host will be reading the output image directly once the work
+			// completes
+			EpilogueCmd.pipelineBarrier(
+				vk::PipelineStageFlagBits::eColorAttachmentOutput,
+				vk::PipelineStageFlagBits::eHost, vk::DependencyFlags(), {}, {},
+				{
+					vk::ImageMemoryBarrier{
+						.srcAccessMask
+						= vk::AccessFlagBits::eColorAttachmentWrite,
+						.dstAccessMask = vk::AccessFlagBits::eHostRead,
+						.oldLayout     = vk::ImageLayout::eTransferSrcOptimal,
+						.newLayout     = OutputImageHostLayout,
+						.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+						.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+						.image            = Context.Cache.Output.Image.get(),
+						.subresourceRange = ImageDefaultSubresourceRange,
+					},
+				}
+			);
+		}
+		else
+		{
+			// Output Image is going to be copied from
+			const vk::ImageMemoryBarrier OutputReadBarrier = {
+				.srcAccessMask       = vk::AccessFlagBits::eColorAttachmentWrite,
+				.dstAccessMask       = vk::AccessFlagBits::eTransferRead,
+				.oldLayout           = vk::ImageLayout::eTransferSrcOptimal,
+				.newLayout           = vk::ImageLayout::eTransferSrcOptimal,
+				.srcQueueFamilyIndex = GraphicsFamily,
+				.dstQueueFamilyIndex = TransferFamily,
+				.image               = Context.Cache.Output.Image.get(),
+				.subresourceRange    = ImageDefaultSubresourceRange,
+			};
+
+			vk::ImageMemoryBarrier OutputAcquireBarrier = OutputReadBarrier;
+			if( SplitTransfer )
+			{
+				// Release the output image from the graphics queue's family.
+				// The transfer queue acquires it after waiting on the render
+				vk::ImageMemoryBarrier OutputReleaseBarrier = OutputReadBarrier;
+				OutputReleaseBarrier.dstAccessMask          = vk::AccessFlags();
+				EpilogueCmd.pipelineBarrier(
+					vk::PipelineStageFlagBits::eColorAttachmentOutput,
+					vk::PipelineStageFlagBits::eBottomOfPipe,
+					vk::DependencyFlags(), {}, {}, {OutputReleaseBarrier}
+				);
+
+				OutputAcquireBarrier.srcAccessMask = vk::AccessFlags();
+			}
+
+			////// Download Output Image into staging buffer
+			ReadbackCmd.pipelineBarrier(
+				// Wait for render pass to finish writing, or for the render
+				// semaphore when on the transfer queue
+				SplitTransfer ? vk::PipelineStageFlagBits::eTransfer
+							  : vk::PipelineStageFlagBits::eColorAttachmentOutput,
+				vk::PipelineStageFlagBits::eTransfer, // Get it ready for a read
+				vk::DependencyFlags(), {},
+				{
+					// Get Staging buffer ready for a write
+					vk::BufferMemoryBarrier{
+						.srcAccessMask       = vk::AccessFlags(),
+						.dstAccessMask       = vk::AccessFlagBits::eTransferWrite,
+						.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+						.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+						.buffer              = ReadbackBuffer,
+						.offset              = ReadbackBufferOffset,
+						.size                = OutputLayerSize,
+					},
+				},
+				{
+					// Output Image ready for a read
+					OutputAcquireBarrier,
+				}
+			);
+			ReadbackCmd.copyImageToBuffer(
+				Context.Cache.Output.Image.get(),
+				vk::ImageLayout::eTransferSrcOptimal, ReadbackBuffer,
+				{OutputBufferMapping}
+			);
+
+			// Make the transfer-writes visible to the host once the work
+			// completes
+			ReadbackCmd.pipelineBarrier(
+				vk::PipelineStageFlagBits::eTransfer,
+				vk::PipelineStageFlagBits::eHost, vk::DependencyFlags(), {},
+				{
+					vk::BufferMemoryBarrier{
+						.srcAccessMask       = vk::AccessFlagBits::eTransferWrite,
+						.dstAccessMask       = vk::AccessFlagBits::eHostRead,
+						.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+						.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+						.buffer              = ReadbackBuffer,
+						.offset              = ReadbackBufferOffset,
+						.size                = OutputLayerSize,
+					},
+				},
+				{}
+			);
+		}
 	}
-	else
+
+	for( const vk::CommandBuffer& CurCmd : ReusableCommandBuffers )
 	{
-		// Error mapping staging buffer
-		return PF_Err_INTERNAL_STRUCT_DAMAGED;
+		if( auto EndResult = CurCmd.end(); EndResult != vk::Result::eSuccess )
+		{
+			// Error ending command buffer
+			return PF_Err_INTERNAL_STRUCT_DAMAGED;
+		}
 	}
 
-	// Copy into staging buffer
-	std::memcpy(
-		StagingBufferMapping, InputLayer->data,
-		InputLayer->rowbytes * InputLayer->height
-	);
-
-	if( auto MapResult = GlobalParam->Device->mapMemory(
-			SequenceParam->UniformBufferMemory.get(), 0, VK_WHOLE_SIZE
-		);
-		MapResult.result == vk::Result::eSuccess )
+	if( ReuseCommands )
 	{
-		std::memcpy(
-			MapResult.value, &FrameParam->Uniforms, sizeof(FrameParam->Uniforms)
-		);
-		GlobalParam->Device->unmapMemory(SequenceParam->UniformBufferMemory.get(
-		));
+		++GlobalParam->ReuseStats.Reuses;
+		GlobalParam->ReuseStats.SavedNanoseconds += Context.RecordTime.count();
 	}
 	else
 	{
-		// Error mapping staging buffer
-		return PF_Err_INTERNAL_STRUCT_DAMAGED;
+		++GlobalParam->ReuseStats.Recordings;
+		Context.RecordTime = std::chrono::steady_clock::now() - RecordBegin;
+		Context.Recorded   = std::move(Recording);
 	}
 
-	// Allocate input and output buffers
-
-	//////////// Render
-
-	SequenceParam->CommandBuffer->reset(
-		vk::CommandBufferResetFlagBits::eReleaseResources
-	);
+	// The render pass is tiny, so its memory is kept for the next frame
+	Cmd.reset(vk::CommandBufferResetFlags());
 
 	const vk::CommandBufferBeginInfo BeginInfo = {
 		.flags = vk::CommandBufferUsageFlagBits::eOneTimeSubmit,
 	};
 
-	// Render Commands
-	vk::CommandBuffer& Cmd = SequenceParam->CommandBuffer.get();
 	if( auto BeginResult = Cmd.begin(BeginInfo);
 		BeginResult != vk::Result::eSuccess )
 	{
@@ -1626,226 +5166,193 @@ PF_Err SmartRender(
 		return PF_Err_INTERNAL_STRUCT_DAMAGED;
 	}
 
+	//////// RENDERING COMMANDS HERE
+	RecordRenderPass(
+		Cmd, *GlobalParam, Context, FrameParam->Uniforms, OutputFramebuffer,
+		OutputRect2D.extent, OutputRect2D
+	);
+
+	if( auto EndResult = Cmd.end(); EndResult != vk::Result::eSuccess )
 	{
-		////// Upload staging buffer into Input Image
+		// Error ending command buffer
+		return PF_Err_INTERNAL_STRUCT_DAMAGED;
+	}
 
-		// Layout transitions, prepare to copy
-		// Transfer buffers into images
-		Cmd.pipelineBarrier(
-			vk::PipelineStageFlagBits::eHost,
-			vk::PipelineStageFlagBits::eTransfer, vk::DependencyFlags(), {},
-			{
-				// Get staging buffer ready for a read
-				vk::BufferMemoryBarrier{
-					.srcAccessMask       = vk::AccessFlags(),
-					.dstAccessMask       = vk::AccessFlagBits::eTransferRead,
-					.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
-					.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
-					.buffer = SequenceParam->Cache.StagingBuffer.get(),
-					.offset = 0u,
-					.size   = VK_WHOLE_SIZE
-				},
-			},
-			{
-				// Get Input Image ready to be written to
-				vk::ImageMemoryBarrier{
-					.srcAccessMask       = vk::AccessFlags(),
-					.dstAccessMask       = vk::AccessFlagBits::eTransferWrite,
-					.oldLayout           = vk::ImageLayout::eUndefined,
-					.newLayout           = vk::ImageLayout::eTransferDstOptimal,
-					.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
-					.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
-					.image            = SequenceParam->Cache.InputImage.get(),
-					.subresourceRange = ImageDefaultSubresourceRange
-				},
-			}
-		);
+	if( HostAccess )
+	{
+		Context.Cache.Input.Layout = InputImageLayout;
+	}
 
-		// Upload input image data from staging buffer into Input Image
-		Cmd.copyBufferToImage(
-			SequenceParam->Cache.StagingBuffer.get(),
-			SequenceParam->Cache.InputImage.get(),
-			vk::ImageLayout::eTransferDstOptimal, {InputBufferMapping}
-		);
+	// Submit GPU work to queues
+	// The submission service may batch this together with the work of other
+	// render threads into a single submit
+	static constexpr vk::PipelineStageFlags TransferWaitStage
+		= vk::PipelineStageFlagBits::eTransfer;
 
-		// Layout transitions, copy is complete, ready input image to be sampled
-		// from
-		Cmd.pipelineBarrier(
-			vk::PipelineStageFlagBits::eTransfer,
-			vk::PipelineStageFlagBits::eComputeShader, vk::DependencyFlags(),
-			{}, {},
-			{// Input Image is going to be read
-			 vk::ImageMemoryBarrier{
-				 .srcAccessMask       = vk::AccessFlagBits::eTransferWrite,
-				 .dstAccessMask       = vk::AccessFlagBits::eShaderRead,
-				 .oldLayout           = vk::ImageLayout::eTransferDstOptimal,
-				 .newLayout           = vk::ImageLayout::eShaderReadOnlyOptimal,
-				 .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
-				 .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
-				 .image               = SequenceParam->Cache.InputImage.get(),
-				 .subresourceRange    = ImageDefaultSubresourceRange,
-			 },
-			 // Output Image is going to be written to as a color attachment
-			 // within a render pass
-			 vk::ImageMemoryBarrier{
-				 .srcAccessMask = vk::AccessFlags(),
-				 .dstAccessMask = vk::AccessFlagBits::eShaderWrite,
-				 .oldLayout     = vk::ImageLayout::eUndefined,
-				 .newLayout     = vk::ImageLayout::eColorAttachmentOptimal,
-				 .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
-				 .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
-				 .image               = SequenceParam->Cache.OutputImage.get(),
-				 .subresourceRange    = ImageDefaultSubresourceRange,
-			 }
-			}
-		);
+	// The render pass is submitted in between the re-usable commands
+	const std::array<vk::CommandBuffer, 3> RenderCommandBuffers
+		= {PrologueCmd, Cmd, EpilogueCmd};
 
-		//////// RENDERING COMMANDS HERE
+	Vulkanator::SubmissionService::Request UploadRequest;
+	Vulkanator::SubmissionService::Request RenderRequest;
+	Vulkanator::SubmissionService::Request ReadbackRequest;
 
-		// Begin Render Pass
-
-		// This is the color that we clear the framebuffer with
-		// Default clear value is just "0" through out
-		static const vk::ClearValue ClearValue = {};
-
-		const vk::RenderPassBeginInfo BeginInfo = {
-			// Assign our render pass, based on depth
-			.renderPass
-			= GlobalParam->RenderPasses[FrameParam->Uniforms.Depth].get(),
-			// Assign our output framebuffer, which has 1 color attachment
-			.framebuffer = OutputFramebuffer.get(),
-
-			// Rectangular region of the output buffer to render into
-			// TODO: we could potentially have a cached layer-sized output
-			// image,
-			// and only render into a subset of this image using extent_hint if
-			// we
-			// wanted to. But we use the exact output size for more immediate
-			// memory
-			// savings
-			.renderArea      = OutputRect2D,
-			.clearValueCount = 1,
-			.pClearValues    = &ClearValue,
-		};
+	std::vector<Vulkanator::SubmissionService::Request*> SubmitRequests
+		= {&RenderRequest};
 
-		////////////// Render pass begin
-		Cmd.beginRenderPass(BeginInfo, vk::SubpassContents::eInline);
+	if( SplitTransfer )
+	{
+		// Upload -> UploadSemaphore -> Render -> RenderSemaphore -> Readback
+		UploadRequest.SubmitInfo = {
+			.commandBufferCount   = 1,
+			.pCommandBuffers      = &UploadCmd,
+			.signalSemaphoreCount = 1,
+			.pSignalSemaphores    = &Context.UploadSemaphore.get(),
+		};
+		UploadRequest.QueueIndex
+			= Vulkanator::GlobalParams::TransferQueueIndex;
+
+		RenderRequest.SubmitInfo = {
+			.waitSemaphoreCount   = 1,
+			.pWaitSemaphores      = &Context.UploadSemaphore.get(),
+			.pWaitDstStageMask    = &TransferWaitStage,
+			.commandBufferCount   = std::uint32_t(RenderCommandBuffers.size()),
+			.pCommandBuffers      = RenderCommandBuffers.data(),
+			.signalSemaphoreCount = 1,
+			.pSignalSemaphores    = &Context.RenderSemaphore.get(),
+		};
+		RenderRequest.QueueIndex = Vulkanator::GlobalParams::GraphicsQueueIndex;
+
+		ReadbackRequest.SubmitInfo = {
+			.waitSemaphoreCount = 1,
+			.pWaitSemaphores    = &Context.RenderSemaphore.get(),
+			.pWaitDstStageMask  = &TransferWaitStage,
+			.commandBufferCount = 1,
+			.pCommandBuffers    = &ReadbackCmd,
+		};
+		ReadbackRequest.QueueIndex
+			= Vulkanator::GlobalParams::TransferQueueIndex;
 
-		// Render pass commands here!!!
-		// Bind our shader
-		Cmd.bindPipeline(
-			vk::PipelineBindPoint::eGraphics,
-			GlobalParam->RenderPipelines[FrameParam->Uniforms.Depth].get()
-		);
-		// Bind our Descriptor set
-		Cmd.bindDescriptorSets(
-			vk::PipelineBindPoint::eGraphics,
-			GlobalParam->RenderPipelineLayout.get(), 0,
-			{SequenceParam->DescriptorSet.get()}, {}
-		);
-		// Bind our mesh
-		Cmd.bindVertexBuffers(0, {GlobalParam->MeshBuffer.get()}, {0});
-
-		// Set viewport and scissor region for this render, we draw to the
-		// entire output buffer
-		const vk::Viewport OutputViewport = {
-			.x        = 0,
-			.y        = 0,
-			.width    = glm::f32(OutputLayer->width),
-			.height   = glm::f32(OutputLayer->height),
-			.minDepth = 0.0f,
-			.maxDepth = 1.0f,
+		SubmitRequests = {&UploadRequest, &RenderRequest, &ReadbackRequest};
+	}
+	else
+	{
+		RenderRequest.SubmitInfo = {
+			.commandBufferCount = std::uint32_t(RenderCommandBuffers.size()),
+			.pCommandBuffers    = RenderCommandBuffers.data(),
 		};
-		Cmd.setViewport(0, {OutputViewport});
-		Cmd.setScissor(0, {OutputRect2D});
+		RenderRequest.QueueIndex = Vulkanator::GlobalParams::GraphicsQueueIndex;
+	}
 
-		// Draw!!
-		Cmd.draw(4, 1, 0, 0);
+	// Requests from the same thread are submitted in the same order, so each
+	// semaphore is always signaled by an earlier submission than its wait
+	for( Vulkanator::SubmissionService::Request* CurRequest : SubmitRequests )
+	{
+		GlobalParam->Submitter.Submit(*CurRequest);
+	}
 
-		Cmd.endRenderPass();
-		////////////// Render pass end
+	// Wait for GPU work to finish
+	// Every request has to be waited on before it goes out of scope
+	bool SubmitFailed   = false;
+	bool SubmitTimedOut = false;
+	for( Vulkanator::SubmissionService::Request* CurRequest : SubmitRequests )
+	{
+		const vk::Result WaitResult = CurRequest->Wait();
+		if( WaitResult != vk::Result::eSuccess )
+		{
+			SubmitFailed = true;
+			SubmitTimedOut |= WaitResult == vk::Result::eTimeout;
+		}
+	}
 
-		////// Download Output Image into staging buffer
-		Cmd.pipelineBarrier(
-			vk::PipelineStageFlagBits::eColorAttachmentOutput, // Wait for
-															   // render pass to
-															   // finish writing
-			vk::PipelineStageFlagBits::eTransfer, // Get it ready for a read
-			vk::DependencyFlags(), {},
-			{
-				// Get Staging buffer ready for a write
-				vk::BufferMemoryBarrier{
-					.srcAccessMask       = vk::AccessFlags(),
-					.dstAccessMask       = vk::AccessFlagBits::eTransferWrite,
-					.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
-					.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
-					.buffer = SequenceParam->Cache.StagingBuffer.get(),
-					.offset = 0u,
-					.size   = VK_WHOLE_SIZE,
-				},
-			},
-			{
-				//// Output Image ready for a read
-				// vk::ImageMemoryBarrier(
-				//	vk::AccessFlagBits::eColorAttachmentWrite,
-				// vk::AccessFlagBits::eTransferRead,
-				//	vk::ImageLayout::eTransferSrcOptimal,
-				// vk::ImageLayout::eTransferSrcOptimal,
-				// VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED,
-				// OutputImage.get(),
-				//	vk::ImageSubresourceRange(vk::ImageAspectFlagBits::eColor,
-				// 0, 1, 0, 1)
-				//)
-			}
-		);
-		Cmd.copyImageToBuffer(
-			SequenceParam->Cache.OutputImage.get(),
-			vk::ImageLayout::eTransferSrcOptimal,
-			SequenceParam->Cache.StagingBuffer.get(), {OutputBufferMapping}
-		);
+	if( SubmitTimedOut )
+	{
+		AbandonRender();
 	}
 
-	if( auto EndResult = Cmd.end(); EndResult != vk::Result::eSuccess )
+	if( SubmitFailed )
 	{
-		// Error beginning command buffer
+		// Error submitting or waiting on command buffer
 		return PF_Err_INTERNAL_STRUCT_DAMAGED;
 	}
 
-	// Submit GPU work to queue
-	const vk::SubmitInfo SubmitInfo = {
-		.commandBufferCount = 1,
-		.pCommandBuffers    = &Cmd,
-	};
+	// The host writes the entire input layer into the input image directly,
+	// so there is nothing to fingerprint. Otherwise, other renders may now
+	// sample the uploaded input texture
+	if( HostAccess )
+	{
+		if( !InputUnchanged )
+		{
+			Upload.Bytes = std::uint64_t(InputImageExtent.width) * PixelSize
+						 * InputImageExtent.height;
+		}
+	}
+	else
+	{
+		PublishInputTexture(
+			*GlobalParam, InputTexture, InputTextureKey, InputUnchanged,
+			InputImageLayout, std::move(InputTileHashes)
+		);
+	}
+	Context.Cache.InputIdentity = InputIdentity;
+	Context.Cache.InputHash     = InputHash;
+	GlobalParam->UploadStats.Bytes += Upload.Bytes;
+	GlobalParam->UploadStats.Tiles += Upload.Tiles;
+	GlobalParam->UploadStats.SkippedTiles += Upload.SkippedTiles;
 
-	if( auto SubmitResult
-		= GlobalParam->Queue.submit(SubmitInfo, SequenceParam->Fence.get());
-		SubmitResult != vk::Result::eSuccess )
+	//////////// Download output image data into the output layer
+	// When the output layer was imported, the GPU already wrote into it
+	if( StageOutput )
 	{
-		// Error submitting command buffer
-		return PF_Err_INTERNAL_STRUCT_DAMAGED;
+		std::memcpy(
+			OutputLayer->data, ReadbackMapping,
+			OutputLayerSize
+		);
 	}
 
-	// Wait for GPU work to finish
-	if( GlobalParam->Device->waitForFences(
-			{SequenceParam->Fence.get()}, VK_TRUE, ~0u
-		)
-		!= vk::Result::eSuccess )
+	// Or read the linear output image into the output layer directly
+	if( DirectLinear
+		&& !VulkanUtils::ReadLinearImage(
+			GlobalParam->Device.get(), Context.Cache.Output.Image.get(),
+			Context.Cache.Output.Memory, OutputLayer->data,
+			OutputLayer->rowbytes, OutputImageExtent.width * PixelSize,
+			OutputImageExtent.height
+		) )
 	{
-		// Error waiting on fence
+		// Error reading output image
 		return PF_Err_INTERNAL_STRUCT_DAMAGED;
 	}
-	// Reset(unsignal) fence for later re-use
-	GlobalParam->Device->resetFences({SequenceParam->Fence.get()});
 
-	//////////// Download output image data into the output layer
-	std::memcpy(
-		OutputLayer->data, StagingBufferMapping,
-		std::size_t(OutputLayer->rowbytes) * OutputLayer->height
-	);
-	GlobalParam->Device->unmapMemory(
-		SequenceParam->Cache.StagingBufferMemory.get()
-	);
+	// Or read the output image into the output layer directly
+	if( HostImageCopy )
+	{
+		const vk::ImageToMemoryCopyEXT OutputImageRegion = {
+			.pHostPointer      = OutputLayer->data,
+			.memoryRowLength   = std::uint32_t(OutputLayer->rowbytes / PixelSize),
+			.memoryImageHeight = 0,
+			.imageSubresource  = ImageDefaultSubresourceLayer,
+			.imageOffset       = {},
+			.imageExtent       = OutputImageExtent,
+		};
+
+		const vk::CopyImageToMemoryInfoEXT OutputImageCopy = {
+			.srcImage       = Context.Cache.Output.Image.get(),
+			.srcImageLayout = GlobalParam->Features.HostImageReadbackLayout,
+			.regionCount    = 1,
+			.pRegions       = &OutputImageRegion,
+		};
+
+		if( GlobalParam->Device->copyImageToMemoryEXT(
+				OutputImageCopy, GlobalParam->Dispatcher
+			)
+			!= vk::Result::eSuccess )
+		{
+			// Error reading back output image
+			return PF_Err_INTERNAL_STRUCT_DAMAGED;
+		}
+	}
 
+	StoreRenderResult(*GlobalParam, ResultKey, *OutputLayer, PixelSize);
 	return err;
 }
 
@@ -1891,6 +5398,50 @@ DllExport PF_Err EntryPoint(
 	return PF_Err_NONE;
 }
 
+vk::DeviceSize Vulkanator::RenderContext::RenderCache::GetFootprint() const
+{
+	vk::DeviceSize Footprint = Input.Memory.GetSize() + Output.Memory.GetSize()
+							 + (InputTexture ? InputTexture->Size : 0);
+	for( const CachedImage& CurSpare : SpareImages )
+	{
+		Footprint += CurSpare.Memory.GetSize();
+	}
+	return Footprint;
+}
+
+std::unique_ptr<Vulkanator::RenderContext>
+	Vulkanator::RenderContextPool::AcquireContext()
+{
+	const std::scoped_lock ContextLock(ContextMutex);
+	if( FreeContexts.empty() )
+	{
+		return nullptr;
+	}
+	std::unique_ptr<RenderContext> Context = std::move(FreeContexts.back());
+	FreeContexts.pop_back();
+	Footprint -= Context->Cache.GetFootprint();
+	return Context;
+}
+
+void Vulkanator::RenderContextPool::ReleaseContext(
+	std::unique_ptr<RenderContext> Context
+)
+{
+	const std::scoped_lock ContextLock(ContextMutex);
+	Footprint += Context->Cache.GetFootprint();
+	FreeContexts.emplace_back(std::move(Context));
+}
+
+vk::DeviceSize Vulkanator::RenderContextPool::EvictCaches()
+{
+	const std::scoped_lock ContextLock(ContextMutex);
+	for( std::unique_ptr<RenderContext>& CurContext : FreeContexts )
+	{
+		CurContext->Cache = {};
+	}
+	return Footprint.exchange(0);
+}
+
 // This is to tell vulkan how to interpret per-vertex data
 
 vk::VertexInputBindingDescription& Vulkanator::Vertex::BindingDescription()
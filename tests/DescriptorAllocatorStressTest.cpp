@@ -0,0 +1,227 @@
+#include "MockHost.hpp"
+#include "TestDevice.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include "DescriptorAllocator.hpp"
+
+// Opens thousands of sequences from many threads at once, each with a few
+// render contexts that hold a descriptor set of their own, then churns through
+// closing and re-opening them. Sequences are closed by other threads than the
+// ones that opened them, which frees their descriptor sets back into shards
+// that the freeing thread does not allocate from. The pool chain of every
+// shard has to grow to fit them all, and shrink back down once they are freed
+
+using namespace VulkanatorTest;
+
+// Kept small, so that the chains grow into hundreds of pools
+static constexpr std::uint32_t SetsPerPool        = 16;
+static constexpr std::size_t   ShardCount         = 8;
+static constexpr std::uint32_t SequencesPerThread = 256;
+// Each sequence holds between one and this many render contexts
+static constexpr std::uint32_t MaxContexts = 3;
+// Sequences that every thread closes and re-opens, after opening all of them
+static constexpr std::uint32_t ChurnRounds = 2000;
+// Reset pools that each shard keeps around for re-use
+static constexpr std::uint32_t MaxFreePools = 2;
+static constexpr std::uint32_t FillRepeats  = 2;
+
+struct Sequence
+{
+	std::vector<Vulkanator::DescriptorAllocator::DescriptorSet> Contexts = {};
+};
+
+// Opens a sequence with between one and `MaxContexts` render contexts
+static bool OpenSequence(
+	Vulkanator::DescriptorAllocator& Allocator, vk::DescriptorSetLayout Layout,
+	std::uint32_t ContextCount, Sequence& NewSequence
+)
+{
+	for( std::uint32_t i = 0; i < ContextCount; ++i )
+	{
+		NewSequence.Contexts.emplace_back(Allocator.Allocate(Layout));
+		if( !NewSequence.Contexts.back() )
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+int main()
+{
+	TestDevice Device;
+	Check(Device.Initialize(), "Error creating device");
+
+	// The same layout that the effect renders with
+	const vk::DescriptorSetLayoutBinding InputBinding = {
+		.binding         = 0,
+		.descriptorType  = vk::DescriptorType::eCombinedImageSampler,
+		.descriptorCount = 1,
+		.stageFlags      = vk::ShaderStageFlagBits::eFragment,
+	};
+	const vk::DescriptorSetLayoutCreateInfo LayoutInfo = {
+		.bindingCount = 1,
+		.pBindings    = &InputBinding,
+	};
+	auto LayoutResult
+		= Device.Device->createDescriptorSetLayoutUnique(LayoutInfo);
+	Check(
+		LayoutResult.result == vk::Result::eSuccess,
+		"Error creating descriptor set layout"
+	);
+	const vk::DescriptorSetLayout Layout = LayoutResult.value.get();
+
+	const vk::DescriptorPoolSize PoolSize = {
+		.type            = vk::DescriptorType::eCombinedImageSampler,
+		.descriptorCount = SetsPerPool,
+	};
+
+	Vulkanator::DescriptorAllocator Allocator;
+	Check(
+		Allocator.Initialize(
+			Device.Device.get(), {&PoolSize, 1}, SetsPerPool, ShardCount
+		),
+		"Error initializing descriptor allocator"
+	);
+
+	const std::uint32_t ThreadCount
+		= std::max(16u, std::thread::hardware_concurrency());
+
+	std::vector<std::vector<Sequence>> ThreadSequences(ThreadCount);
+	std::atomic<std::uint32_t>         Failures = 0;
+
+	// Runs `Task` on every thread at once, and waits for all of them
+	const auto RunThreads = [&](const auto& Task) -> void {
+		std::vector<std::thread> Threads;
+		for( std::uint32_t i = 0; i < ThreadCount; ++i )
+		{
+			Threads.emplace_back(Task, i);
+		}
+		for( std::thread& CurThread : Threads )
+		{
+			CurThread.join();
+		}
+	};
+
+	std::uint64_t FirstFillGrows = 0;
+	for( std::uint32_t Repeat = 0; Repeat < FillRepeats; ++Repeat )
+	{
+		//////////// Open every sequence
+		RunThreads([&](std::uint32_t ThreadIndex) -> void {
+			std::vector<Sequence>& Sequences = ThreadSequences[ThreadIndex];
+			Sequences.resize(SequencesPerThread);
+			for( std::uint32_t i = 0; i < SequencesPerThread; ++i )
+			{
+				if( !OpenSequence(
+						Allocator, Layout, 1 + (i % MaxContexts), Sequences[i]
+					) )
+				{
+					++Failures;
+				}
+			}
+		});
+		Check(Failures == 0, "Error allocating descriptor sets");
+
+		std::set<VkDescriptorSet> UniqueSets;
+		std::uint64_t             LiveSets = 0;
+		for( const std::vector<Sequence>& Sequences : ThreadSequences )
+		{
+			for( const Sequence& CurSequence : Sequences )
+			{
+				for( const auto& CurSet : CurSequence.Contexts )
+				{
+					UniqueSets.insert(VkDescriptorSet(CurSet.Get()));
+					++LiveSets;
+				}
+			}
+		}
+		Check(
+			UniqueSets.size() == LiveSets,
+			"A descriptor set was handed out twice"
+		);
+
+		const Vulkanator::DescriptorAllocator::Statistics FullStats
+			= Allocator.GetStatistics();
+		std::printf(
+			"Fill %u: %u sequences, %llu sets, %llu pools, %llu grows\n",
+			Repeat, ThreadCount * SequencesPerThread,
+			static_cast<unsigned long long>(FullStats.LiveSets),
+			static_cast<unsigned long long>(FullStats.Pools),
+			static_cast<unsigned long long>(FullStats.Grows)
+		);
+		Check(FullStats.LiveSets == LiveSets, "Live set count is off");
+		Check(
+			FullStats.Pools * SetsPerPool >= LiveSets,
+			"The pool chains did not grow to fit every set"
+		);
+
+		if( Repeat == 0 )
+		{
+			FirstFillGrows = FullStats.Grows;
+		}
+		else
+		{
+			// Reset pools are re-used before creating any new ones
+			Check(
+				FullStats.Grows - FirstFillGrows <= FirstFillGrows,
+				"Refilling created more pools than the first fill"
+			);
+		}
+
+		//////////// Churn through closing and re-opening sequences
+		RunThreads([&](std::uint32_t ThreadIndex) -> void {
+			std::vector<Sequence>& Sequences = ThreadSequences[ThreadIndex];
+			std::mt19937           Random(ThreadIndex + Repeat * ThreadCount);
+			for( std::uint32_t Round = 0; Round < ChurnRounds; ++Round )
+			{
+				Sequence& CurSequence
+					= Sequences[Random() % SequencesPerThread];
+				CurSequence.Contexts.clear();
+				if( !OpenSequence(
+						Allocator, Layout, 1 + Random() % MaxContexts,
+						CurSequence
+					) )
+				{
+					++Failures;
+				}
+			}
+		});
+		Check(Failures == 0, "Error re-allocating descriptor sets");
+
+		//////////// Close every sequence, from another thread than the one
+		// that opened it
+		RunThreads([&](std::uint32_t ThreadIndex) -> void {
+			ThreadSequences[(ThreadIndex + 1) % ThreadCount].clear();
+		});
+
+		const Vulkanator::DescriptorAllocator::Statistics EmptyStats
+			= Allocator.GetStatistics();
+		std::printf(
+			"Empty %u: %llu sets, %llu pools, %llu free pools\n", Repeat,
+			static_cast<unsigned long long>(EmptyStats.LiveSets),
+			static_cast<unsigned long long>(EmptyStats.Pools),
+			static_cast<unsigned long long>(EmptyStats.FreePools)
+		);
+		Check(EmptyStats.LiveSets == 0, "Descriptor sets were leaked");
+		// Each shard only keeps its current pool, and a few reset ones
+		Check(
+			EmptyStats.Pools <= ShardCount,
+			"Empty pools were not taken off of the chains"
+		);
+		Check(
+			EmptyStats.FreePools <= ShardCount * MaxFreePools,
+			"Too many reset pools were kept around"
+		);
+	}
+
+	Allocator.Clear();
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,224 @@
+#include "MockHost.hpp"
+#include "TestDevice.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "MemoryAllocator.hpp"
+#include "VulkanUtils.hpp"
+
+// Measures how long it takes to allocate and free the memory of the images that
+// the effect renders with, when they are sub-allocated out of the blocks of a
+// MemoryAllocator, and when each of them gets a device memory allocation of its
+// own, as they did before the allocator existed.
+// Only the allocation and the freeing of the memory is timed, the images
+// themselves are created beforehand and destroyed afterwards
+
+using namespace VulkanatorTest;
+
+using Clock = std::chrono::steady_clock;
+
+// Memory that the images of a single size may take up, all together
+static constexpr vk::DeviceSize MaxSizeBudget = 256ull * 1024 * 1024;
+static constexpr std::uint32_t  MaxImageCount = 256;
+static constexpr std::uint32_t  MinImageCount = 8;
+// Every size is allocated and freed this many times
+static constexpr std::uint32_t Rounds = 4;
+
+struct ImageSize
+{
+	std::uint32_t Width  = 0;
+	std::uint32_t Height = 0;
+	std::size_t   Depth  = 0;
+};
+
+// Small tiles, the sizes of the frames of common compositions, and all three
+// of the formats that the effect renders in
+static constexpr ImageSize ImageSizes[] = {
+	{.Width = 64, .Height = 64, .Depth = 0},
+	{.Width = 256, .Height = 256, .Depth = 0},
+	{.Width = 640, .Height = 360, .Depth = 1},
+	{.Width = 1280, .Height = 720, .Depth = 0},
+	{.Width = 1280, .Height = 720, .Depth = 2},
+	{.Width = 1920, .Height = 1080, .Depth = 1},
+};
+
+// Microseconds that each allocation or free took
+struct Latencies
+{
+	std::vector<double> Allocate = {};
+	std::vector<double> Free     = {};
+};
+
+static double GetMicroseconds(Clock::duration Duration)
+{
+	return std::chrono::duration<double, std::micro>(Duration).count();
+}
+
+static double GetPercentile(std::vector<double> Samples, double Percentile)
+{
+	if( Samples.empty() )
+	{
+		return 0.0;
+	}
+	std::sort(Samples.begin(), Samples.end());
+	const std::size_t Index
+		= std::size_t(double(Samples.size() - 1) * Percentile);
+	return Samples[Index];
+}
+
+static void PrintLatencies(const char* Name, const Latencies& Results)
+{
+	std::printf(
+		"  %-10s allocate: %8.2fus median %8.2fus p99, "
+		"free: %8.2fus median %8.2fus p99\n",
+		Name, GetPercentile(Results.Allocate, 0.5),
+		GetPercentile(Results.Allocate, 0.99),
+		GetPercentile(Results.Free, 0.5), GetPercentile(Results.Free, 0.99)
+	);
+}
+
+int main()
+{
+	TestDevice Device;
+	Check(Device.Initialize(), "Error creating device");
+
+	const vk::Device         LogicalDevice  = Device.Device.get();
+	const vk::PhysicalDevice PhysicalDevice = Device.PhysicalDevice;
+
+	VulkanUtils::MemoryAllocator Allocator;
+	Allocator.Initialize(LogicalDevice, PhysicalDevice);
+
+	for( const ImageSize& CurSize : ImageSizes )
+	{
+		const vk::ImageCreateInfo ImageInfo = {
+			.imageType     = vk::ImageType::e2D,
+			.format        = VulkanUtils::DepthToFormat(CurSize.Depth),
+			.extent        = vk::Extent3D(CurSize.Width, CurSize.Height, 1),
+			.mipLevels     = 1,
+			.arrayLayers   = 1,
+			.samples       = vk::SampleCountFlagBits::e1,
+			.tiling        = vk::ImageTiling::eOptimal,
+			.usage         = vk::ImageUsageFlagBits::eSampled
+				   | vk::ImageUsageFlagBits::eColorAttachment
+				   | vk::ImageUsageFlagBits::eTransferSrc
+				   | vk::ImageUsageFlagBits::eTransferDst,
+			.sharingMode   = vk::SharingMode::eExclusive,
+			.initialLayout = vk::ImageLayout::eUndefined,
+		};
+
+		std::vector<vk::UniqueImage> Images;
+		auto FirstImageResult = LogicalDevice.createImageUnique(ImageInfo);
+		Check(
+			FirstImageResult.result == vk::Result::eSuccess,
+			"Error creating image"
+		);
+		const vk::MemoryRequirements Requirements
+			= LogicalDevice.getImageMemoryRequirements(
+				FirstImageResult.value.get()
+			);
+		Images.emplace_back(std::move(FirstImageResult.value));
+
+		const std::uint32_t ImageCount
+			= std::uint32_t(std::clamp<vk::DeviceSize>(
+				MaxSizeBudget / Requirements.size, MinImageCount, MaxImageCount
+			));
+		while( Images.size() < ImageCount )
+		{
+			auto ImageResult = LogicalDevice.createImageUnique(ImageInfo);
+			Check(
+				ImageResult.result == vk::Result::eSuccess,
+				"Error creating image"
+			);
+			Images.emplace_back(std::move(ImageResult.value));
+		}
+
+		const std::int32_t MemoryTypeIndex = VulkanUtils::FindMemoryTypeIndex(
+			PhysicalDevice, Requirements.memoryTypeBits,
+			vk::MemoryPropertyFlagBits::eDeviceLocal
+		);
+		Check(MemoryTypeIndex >= 0, "No device-local memory type");
+
+		Latencies SubAllocated = {};
+		Latencies Dedicated    = {};
+
+		VulkanUtils::MemoryAllocator::Statistics FullStats = {};
+		for( std::uint32_t Round = 0; Round < Rounds; ++Round )
+		{
+			std::vector<VulkanUtils::MemoryAllocation> Allocations;
+			for( const vk::UniqueImage& CurImage : Images )
+			{
+				const Clock::time_point StartTime = Clock::now();
+
+				auto Allocation = Allocator.AllocateForImage(
+					CurImage.get(), ImageInfo.tiling,
+					vk::MemoryPropertyFlagBits::eDeviceLocal
+				);
+				SubAllocated.Allocate.emplace_back(
+					GetMicroseconds(Clock::now() - StartTime)
+				);
+				Check(Allocation.has_value(), "Error sub-allocating memory");
+				Allocations.emplace_back(std::move(Allocation.value()));
+			}
+			FullStats = Allocator.GetStatistics();
+			for( VulkanUtils::MemoryAllocation& CurAllocation : Allocations )
+			{
+				const Clock::time_point StartTime = Clock::now();
+				CurAllocation.Reset();
+				SubAllocated.Free.emplace_back(
+					GetMicroseconds(Clock::now() - StartTime)
+				);
+			}
+
+			std::vector<vk::UniqueDeviceMemory> Memories;
+			for( const vk::UniqueImage& CurImage : Images )
+			{
+				const Clock::time_point StartTime = Clock::now();
+
+				auto Memory = VulkanUtils::AllocateDeviceMemory(
+					LogicalDevice, Requirements.size,
+					std::uint32_t(MemoryTypeIndex), {}, CurImage.get()
+				);
+				Dedicated.Allocate.emplace_back(
+					GetMicroseconds(Clock::now() - StartTime)
+				);
+				Check(Memory.has_value(), "Error allocating device memory");
+				Memories.emplace_back(std::move(Memory.value()));
+			}
+			for( vk::UniqueDeviceMemory& CurMemory : Memories )
+			{
+				const Clock::time_point StartTime = Clock::now();
+				CurMemory.reset();
+				Dedicated.Free.emplace_back(
+					GetMicroseconds(Clock::now() - StartTime)
+				);
+			}
+		}
+
+		std::printf(
+			"%ux%u %s, %u images of %.2f MiB, in %zu blocks and %zu dedicated "
+			"allocations:\n",
+			CurSize.Width, CurSize.Height,
+			vk::to_string(ImageInfo.format).c_str(), ImageCount,
+			double(Requirements.size) / (1024.0 * 1024.0), FullStats.Blocks,
+			FullStats.Dedicated
+		);
+		PrintLatencies("Allocator", SubAllocated);
+		PrintLatencies("Dedicated", Dedicated);
+
+		// Images that fit within a block many times over have to share them
+		if( Requirements.size * MinImageCount <= 1024 * 1024 )
+		{
+			Check(
+				FullStats.Dedicated == 0
+					&& FullStats.Blocks < std::size_t(ImageCount),
+				"Small images were not sub-allocated"
+			);
+		}
+	}
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,696 @@
+#include "MockHost.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <new>
+
+#include <SPErrorCodes.h>
+
+#include "Vulkanator.hpp"
+
+namespace VulkanatorTest
+{
+
+void Check(bool Condition, const char* Message, std::source_location Location)
+{
+	if( Condition )
+	{
+		return;
+	}
+
+	std::fprintf(
+		stderr, "%s:%u: Check failed: %s\n", Location.file_name(),
+		unsigned(Location.line()), Message
+	);
+	std::exit(EXIT_FAILURE);
+}
+
+//////////////////////////////////////////////////////////////////// Layers
+
+Layer Layer::Create(
+	std::uint32_t Width, std::uint32_t Height, std::uint32_t Depth
+)
+{
+	Layer NewLayer    = {};
+	NewLayer.Width    = Width;
+	NewLayer.Height   = Height;
+	NewLayer.Depth    = Depth;
+	NewLayer.RowBytes = std::size_t(Width) * NewLayer.GetPixelSize();
+	NewLayer.Pixels.resize(NewLayer.RowBytes * Height);
+	return NewLayer;
+}
+
+Layer Layer::CreatePattern(
+	std::uint32_t Width, std::uint32_t Height, std::uint32_t Depth,
+	std::uint32_t Seed
+)
+{
+	Layer NewLayer = Create(Width, Height, Depth);
+
+	// Smooth gradients, so that filtering has something to blend, along with
+	// some noise that differs for every seed
+	const auto Channel = [&](std::uint32_t X, std::uint32_t Y,
+							 std::uint32_t Index) -> double {
+		std::uint32_t Noise = (X * 73856093u) ^ (Y * 19349663u)
+							^ (Index * 83492791u) ^ (Seed * 2654435761u);
+		Noise ^= Noise >> 13;
+		Noise *= 0x5BD1E995u;
+		Noise ^= Noise >> 15;
+
+		const double Gradient
+			= Index == 0 ? 1.0
+						 : double((X * Index + Y * (4 - Index)) % 256) / 255.0;
+		return std::clamp(Gradient + double(Noise % 32) / 255.0, 0.0, 1.0);
+	};
+
+	for( std::uint32_t Y = 0; Y < Height; ++Y )
+	{
+		std::byte* const Row = NewLayer.Pixels.data() + NewLayer.RowBytes * Y;
+		for( std::uint32_t X = 0; X < Width; ++X )
+		{
+			for( std::uint32_t Index = 0; Index < 4; ++Index )
+			{
+				const double Value = Channel(X, Y, Index);
+				switch( Depth )
+				{
+				case 8:
+				{
+					const std::uint8_t Value8 = std::uint8_t(Value * 255.0);
+					std::memcpy(Row + (X * 4 + Index), &Value8, 1);
+					break;
+				}
+				case 16:
+				{
+					// 16-bit layers only go up to 0x8000
+					const std::uint16_t Value16 = std::uint16_t(Value * 0x8000);
+					std::memcpy(Row + (X * 4 + Index) * 2, &Value16, 2);
+					break;
+				}
+				case 32:
+				{
+					const float Value32 = float(Value);
+					std::memcpy(Row + (X * 4 + Index) * 4, &Value32, 4);
+					break;
+				}
+				}
+			}
+		}
+	}
+
+	return NewLayer;
+}
+
+std::size_t Layer::GetPixelSize() const
+{
+	switch( Depth )
+	{
+	case 16:
+		return sizeof(PF_Pixel16);
+	case 32:
+		return sizeof(PF_Pixel32);
+	}
+	return sizeof(PF_Pixel8);
+}
+
+//////////////////////////////////////////////////////////////////// Handles
+
+// Handles point at the pointer to their memory, which is the first member
+struct HandleBlock
+{
+	void*        Data = nullptr;
+	A_HandleSize Size = 0;
+};
+
+// Every handle's memory is aligned to this, much like After Effects does
+static constexpr std::size_t HandleAlignment = 64;
+
+static std::atomic<std::size_t> HandleBytes = 0;
+static std::atomic<std::size_t> HandleCount = 0;
+
+static SPAPI PF_Handle HostNewHandle(A_HandleSize Size)
+{
+	HandleBlock* const Block = new HandleBlock{
+		.Data = ::operator new(Size, std::align_val_t(HandleAlignment)),
+		.Size = Size,
+	};
+	std::memset(Block->Data, 0, Size);
+
+	HandleBytes += Size;
+	++HandleCount;
+	return reinterpret_cast<PF_Handle>(&Block->Data);
+}
+
+static SPAPI void* HostLockHandle(PF_Handle Handle)
+{
+	return Handle ? *Handle : nullptr;
+}
+
+static SPAPI void HostUnlockHandle(PF_Handle Handle)
+{
+}
+
+// Only frees the memory of the handle, without destructing anything
+static SPAPI void HostDisposeHandle(PF_Handle Handle)
+{
+	if( !Handle )
+	{
+		return;
+	}
+
+	HandleBlock* const Block = reinterpret_cast<HandleBlock*>(Handle);
+	HandleBytes -= Block->Size;
+	--HandleCount;
+	::operator delete(Block->Data, std::align_val_t(HandleAlignment));
+	delete Block;
+}
+
+static SPAPI A_HandleSize HostGetHandleSize(PF_Handle Handle)
+{
+	return Handle ? reinterpret_cast<HandleBlock*>(Handle)->Size : 0;
+}
+
+static SPAPI PF_Err HostResizeHandle(A_HandleSize NewSize, PF_Handle* Handle)
+{
+	// Nothing resizes its handles
+	return PF_Err_UNRECOGNIZED_PARAM_TYPE;
+}
+
+static const PF_HandleSuite1 HandleSuite = [] {
+	PF_HandleSuite1 Suite      = {};
+	Suite.host_new_handle      = HostNewHandle;
+	Suite.host_lock_handle     = HostLockHandle;
+	Suite.host_unlock_handle   = HostUnlockHandle;
+	Suite.host_dispose_handle  = HostDisposeHandle;
+	Suite.host_get_handle_size = HostGetHandleSize;
+	Suite.host_resize_handle   = HostResizeHandle;
+	return Suite;
+}();
+
+std::size_t MockHost::GetHandleBytes()
+{
+	return HandleBytes.load();
+}
+
+std::size_t MockHost::GetHandleCount()
+{
+	return HandleCount.load();
+}
+
+//////////////////////////////////////////////////////////////////// Calls
+
+struct CallState
+{
+	// Parameters that were added during PF_Cmd_PARAMS_SETUP
+	A_long AddedParams = 0;
+
+	const Layer*        Input        = nullptr;
+	const EffectParams* Params       = nullptr;
+	PF_Handle           SequenceData = nullptr;
+
+	// Regions of the input layer that were checked out during pre-render,
+	// by their checkout IDs
+	std::map<A_long, PF_LRect> Checkouts = {};
+
+	PF_EffectWorld InputWorld = {};
+
+	// Where the output of the render goes, and the region of the full frame
+	// that it spans
+	Layer*         Output      = nullptr;
+	PF_LRect       OutputRect  = {};
+	PF_EffectWorld OutputWorld = {};
+};
+
+static CallState& GetCallState(PF_ProgPtr EffectRef)
+{
+	return *reinterpret_cast<CallState*>(EffectRef);
+}
+
+static PF_Fixed ToFixed(double Value)
+{
+	return PF_Fixed(std::lround(Value * 65536.0));
+}
+
+static PF_Err CheckoutParam(
+	PF_ProgPtr EffectRef, PF_ParamIndex Index, A_long WhatTime,
+	A_long TimeStep, A_u_long TimeScale, PF_ParamDef* Param
+)
+{
+	const CallState& State = GetCallState(EffectRef);
+	if( !State.Params || !State.Input )
+	{
+		return PF_Err_BAD_CALLBACK_PARAM;
+	}
+
+	const EffectParams& Params = *State.Params;
+
+	*Param = {};
+	switch( Index )
+	{
+	case Vulkanator::ParamID::Translate:
+		Param->param_type = PF_Param_POINT;
+		Param->u.td.x_value
+			= ToFixed(Params.TranslateX * double(State.Input->Width));
+		Param->u.td.y_value
+			= ToFixed(Params.TranslateY * double(State.Input->Height));
+		return PF_Err_NONE;
+	case Vulkanator::ParamID::Rotation:
+		Param->param_type = PF_Param_ANGLE;
+		Param->u.ad.value = ToFixed(Params.Rotation);
+		return PF_Err_NONE;
+	case Vulkanator::ParamID::ScaleX:
+	case Vulkanator::ParamID::ScaleY:
+	case Vulkanator::ParamID::FactorR:
+	case Vulkanator::ParamID::FactorG:
+	case Vulkanator::ParamID::FactorB:
+	case Vulkanator::ParamID::FactorA:
+	{
+		Param->param_type = PF_Param_FLOAT_SLIDER;
+		const double Values[] = {
+			Params.ScaleX,  Params.ScaleY,  Params.FactorR,
+			Params.FactorG, Params.FactorB, Params.FactorA,
+		};
+		Param->u.fs_d.value = Values[Index - Vulkanator::ParamID::ScaleX];
+		return PF_Err_NONE;
+	}
+	}
+	return PF_Err_BAD_CALLBACK_PARAM;
+}
+
+static PF_Err CheckinParam(PF_ProgPtr EffectRef, PF_ParamDef* Param)
+{
+	return PF_Err_NONE;
+}
+
+static PF_Err
+	AddParam(PF_ProgPtr EffectRef, PF_ParamIndex Index, PF_ParamDefPtr Def)
+{
+	++GetCallState(EffectRef).AddedParams;
+	return PF_Err_NONE;
+}
+
+static PF_LRect IntersectRects(const PF_LRect& A, const PF_LRect& B)
+{
+	const PF_LRect Intersection = {
+		.left   = std::max(A.left, B.left),
+		.top    = std::max(A.top, B.top),
+		.right  = std::min(A.right, B.right),
+		.bottom = std::min(A.bottom, B.bottom),
+	};
+	if( Intersection.left >= Intersection.right
+		|| Intersection.top >= Intersection.bottom )
+	{
+		return {};
+	}
+	return Intersection;
+}
+
+static PF_Err CheckoutLayer(
+	PF_ProgPtr EffectRef, PF_ParamIndex Index, A_long CheckoutID,
+	const PF_RenderRequest* Request, A_long WhatTime, A_long TimeStep,
+	A_u_long TimeScale, PF_CheckoutResult* CheckoutResult
+)
+{
+	CallState& State = GetCallState(EffectRef);
+	if( Index != Vulkanator::ParamID::Input || !State.Input )
+	{
+		return PF_Err_BAD_CALLBACK_PARAM;
+	}
+
+	const PF_LRect LayerRect = {
+		.left   = 0,
+		.top    = 0,
+		.right  = A_long(State.Input->Width),
+		.bottom = A_long(State.Input->Height),
+	};
+
+	*CheckoutResult                 = {};
+	CheckoutResult->result_rect     = IntersectRects(Request->rect, LayerRect);
+	CheckoutResult->max_result_rect = LayerRect;
+	CheckoutResult->par             = {1, 1};
+	CheckoutResult->ref_width       = LayerRect.right;
+	CheckoutResult->ref_height      = LayerRect.bottom;
+
+	State.Checkouts[CheckoutID] = CheckoutResult->result_rect;
+	return PF_Err_NONE;
+}
+
+// A world that spans `Rect` of `Source`, without copying any of its pixels
+static PF_EffectWorld CreateWorld(const Layer& Source, const PF_LRect& Rect)
+{
+	PF_EffectWorld World = {};
+	World.world_flags      = Source.Depth == 16 ? PF_WorldFlag_DEEP : 0;
+	World.rowbytes         = A_long(Source.RowBytes);
+	World.width            = Rect.right - Rect.left;
+	World.height           = Rect.bottom - Rect.top;
+	World.pix_aspect_ratio = {1, 1};
+	if( World.width > 0 && World.height > 0 )
+	{
+		World.data = reinterpret_cast<PF_PixelPtr>(
+			const_cast<std::byte*>(Source.Pixels.data())
+			+ Source.RowBytes * Rect.top + Source.GetPixelSize() * Rect.left
+		);
+	}
+	return World;
+}
+
+static PF_Err CheckoutLayerPixels(
+	PF_ProgPtr EffectRef, A_long CheckoutID, PF_EffectWorld** Pixels
+)
+{
+	CallState& State    = GetCallState(EffectRef);
+	const auto Checkout = State.Checkouts.find(CheckoutID);
+	if( Checkout == State.Checkouts.end() || !State.Input )
+	{
+		return PF_Err_BAD_CALLBACK_PARAM;
+	}
+
+	State.InputWorld = CreateWorld(*State.Input, Checkout->second);
+	*Pixels          = &State.InputWorld;
+	return PF_Err_NONE;
+}
+
+static PF_Err CheckinLayerPixels(PF_ProgPtr EffectRef, A_long CheckoutID)
+{
+	return PF_Err_NONE;
+}
+
+static PF_Err CheckoutOutput(PF_ProgPtr EffectRef, PF_EffectWorld** Output)
+{
+	CallState& State = GetCallState(EffectRef);
+	if( !State.Output )
+	{
+		return PF_Err_BAD_CALLBACK_PARAM;
+	}
+
+	State.OutputWorld = CreateWorld(
+		*State.Output,
+		{0, 0, A_long(State.Output->Width), A_long(State.Output->Height)}
+	);
+	*Output = &State.OutputWorld;
+	return PF_Err_NONE;
+}
+
+static SPAPI PF_Err
+	GetConstSequenceData(PF_ProgPtr EffectRef, PF_ConstHandle* SequenceData)
+{
+	const CallState& State = GetCallState(EffectRef);
+	*SequenceData = reinterpret_cast<PF_ConstHandle>(State.SequenceData);
+	return PF_Err_NONE;
+}
+
+static const PF_EffectSequenceDataSuite1 SequenceDataSuite = [] {
+	PF_EffectSequenceDataSuite1 Suite = {};
+	Suite.PF_GetConstSequenceData     = GetConstSequenceData;
+	return Suite;
+}();
+
+// The return message of the About dialog is at most this long
+static constexpr std::size_t ReturnMessageSize = PF_MAX_EFFECT_MSG_LEN + 1;
+
+static A_long AnsiSprintf(A_char* Buffer, const A_char* Format, ...)
+{
+	std::va_list Arguments;
+	va_start(Arguments, Format);
+	const int Length
+		= std::vsnprintf(Buffer, ReturnMessageSize, Format, Arguments);
+	va_end(Arguments);
+	return A_long(Length);
+}
+
+static const PF_ANSICallbacksSuite1 AnsiSuite = [] {
+	PF_ANSICallbacksSuite1 Suite = {};
+	Suite.sprintf                = AnsiSprintf;
+	return Suite;
+}();
+
+//////////////////////////////////////////////////////////////////// Suites
+
+static SPAPI SPErr
+	AcquireSuite(const char* Name, int32 Version, const void** Suite)
+{
+	if( !std::strcmp(Name, kPFHandleSuite)
+		&& Version == kPFHandleSuiteVersion1 )
+	{
+		*Suite = &HandleSuite;
+		return kSPNoError;
+	}
+	if( !std::strcmp(Name, kPFANSISuite) && Version == kPFANSISuiteVersion1 )
+	{
+		*Suite = &AnsiSuite;
+		return kSPNoError;
+	}
+	if( !std::strcmp(Name, kPFEffectSequenceDataSuite)
+		&& Version == kPFEffectSequenceDataSuiteVersion1 )
+	{
+		*Suite = &SequenceDataSuite;
+		return kSPNoError;
+	}
+
+	// The effect asked for a suite that this host does not provide
+	*Suite = nullptr;
+	return kSPSuiteNotFoundError;
+}
+
+static SPAPI SPErr ReleaseSuite(const char* Name, int32 Version)
+{
+	return kSPNoError;
+}
+
+static SPAPI SPBoolean IsEqual(const char* Token1, const char* Token2)
+{
+	return std::strcmp(Token1, Token2) == 0;
+}
+
+//////////////////////////////////////////////////////////////////// Host
+
+MockHost::MockHost()
+{
+	BasicSuite.AcquireSuite = AcquireSuite;
+	BasicSuite.ReleaseSuite = ReleaseSuite;
+	BasicSuite.IsEqual      = IsEqual;
+}
+
+MockHost::~MockHost()
+{
+	if( GlobalData )
+	{
+		static_cast<void>(GlobalSetdown());
+	}
+}
+
+PF_Err MockHost::Call(
+	PF_Cmd Command, PF_InData& InData, PF_OutData& OutData, void* Extra
+)
+{
+	// After Effects hands the effect its own data back within both
+	OutData.global_data   = InData.global_data;
+	OutData.sequence_data = InData.sequence_data;
+	return EntryPoint(Command, &InData, &OutData, nullptr, nullptr, Extra);
+}
+
+PF_InData MockHost::CreateInData(CallState& State) const
+{
+	PF_InData InData = {};
+
+	InData.inter.checkout_param = CheckoutParam;
+	InData.inter.checkin_param  = CheckinParam;
+	InData.inter.add_param      = AddParam;
+
+	InData.effect_ref    = reinterpret_cast<PF_ProgPtr>(&State);
+	InData.quality       = PF_Quality_HI;
+	InData.version.major = PF_PLUG_IN_VERSION;
+	InData.version.minor = PF_PLUG_IN_SUBVERS;
+
+	InData.current_time = 0;
+	InData.time_step    = 1;
+	InData.time_scale   = 24;
+
+	InData.downsample_x       = {1, 1};
+	InData.downsample_y       = {1, 1};
+	InData.pixel_aspect_ratio = {1, 1};
+
+	InData.global_data = GlobalData;
+	InData.pica_basicP = const_cast<SPBasicSuite*>(&BasicSuite);
+	return InData;
+}
+
+PF_Err MockHost::GlobalSetup()
+{
+	CallState  State   = {};
+	PF_InData  InData  = CreateInData(State);
+	PF_OutData OutData = {};
+
+	InData.global_data = nullptr;
+	const PF_Err Err   = Call(PF_Cmd_GLOBAL_SETUP, InData, OutData);
+	if( Err != PF_Err_NONE )
+	{
+		// After Effects frees the handle of a failed setup, without a setdown
+		HostDisposeHandle(OutData.global_data);
+		return Err;
+	}
+
+	GlobalData = OutData.global_data;
+	OutFlags   = OutData.out_flags;
+	OutFlags2  = OutData.out_flags2;
+	return PF_Err_NONE;
+}
+
+PF_Err MockHost::GlobalSetdown()
+{
+	CallState  State   = {};
+	PF_InData  InData  = CreateInData(State);
+	PF_OutData OutData = {};
+
+	const PF_Err Err = Call(PF_Cmd_GLOBAL_SETDOWN, InData, OutData);
+	GlobalData       = nullptr;
+	return Err;
+}
+
+std::string MockHost::About()
+{
+	CallState  State   = {};
+	PF_InData  InData  = CreateInData(State);
+	PF_OutData OutData = {};
+
+	if( Call(PF_Cmd_ABOUT, InData, OutData) != PF_Err_NONE )
+	{
+		return {};
+	}
+	return std::string(OutData.return_msg);
+}
+
+A_long MockHost::ParamsSetup()
+{
+	CallState  State   = {};
+	PF_InData  InData  = CreateInData(State);
+	PF_OutData OutData = {};
+
+	if( Call(PF_Cmd_PARAMS_SETUP, InData, OutData) != PF_Err_NONE )
+	{
+		return -1;
+	}
+
+	// The input layer is the only parameter that the effect does not add
+	// by itself
+	if( State.AddedParams + 1 != OutData.num_params )
+	{
+		return -1;
+	}
+	return OutData.num_params;
+}
+
+PF_Handle MockHost::SequenceSetup()
+{
+	CallState  State   = {};
+	PF_InData  InData  = CreateInData(State);
+	PF_OutData OutData = {};
+
+	if( Call(PF_Cmd_SEQUENCE_SETUP, InData, OutData) != PF_Err_NONE )
+	{
+		return nullptr;
+	}
+	return OutData.sequence_data;
+}
+
+PF_Err MockHost::SequenceSetdown(PF_Handle SequenceData)
+{
+	CallState  State   = {};
+	PF_InData  InData  = CreateInData(State);
+	PF_OutData OutData = {};
+
+	InData.sequence_data = SequenceData;
+	return Call(PF_Cmd_SEQUENCE_SETDOWN, InData, OutData);
+}
+
+RenderResult MockHost::Render(
+	PF_Handle SequenceData, const Layer& Input, const EffectParams& Params,
+	bool ConstSequenceData
+)
+{
+	RenderResult Result = {};
+
+	CallState State    = {};
+	State.Input        = &Input;
+	State.Params       = &Params;
+	State.SequenceData = SequenceData;
+
+	PF_InData  InData  = CreateInData(State);
+	PF_OutData OutData = {};
+
+	InData.sequence_data = ConstSequenceData ? nullptr : SequenceData;
+	InData.width         = A_long(Input.Width);
+	InData.height        = A_long(Input.Height);
+
+	//////////// Pre-render
+	// The entire frame is requested
+	PF_PreRenderCallbacks PreRenderCallbacks = {};
+	PreRenderCallbacks.checkout_layer        = CheckoutLayer;
+
+	PF_PreRenderInput PreRenderInput   = {};
+	PreRenderInput.output_request.rect = {
+		.left   = 0,
+		.top    = 0,
+		.right  = A_long(Input.Width),
+		.bottom = A_long(Input.Height),
+	};
+	PreRenderInput.output_request.field        = PF_Field_FRAME;
+	PreRenderInput.output_request.channel_mask = PF_ChannelMask_ARGB;
+	PreRenderInput.bitdepth                    = short(Input.Depth);
+
+	PF_PreRenderOutput PreRenderOutput = {};
+
+	PF_PreRenderExtra PreRenderExtra = {};
+	PreRenderExtra.input             = &PreRenderInput;
+	PreRenderExtra.output            = &PreRenderOutput;
+	PreRenderExtra.cb                = &PreRenderCallbacks;
+
+	Result.Err
+		= Call(PF_Cmd_SMART_PRE_RENDER, InData, OutData, &PreRenderExtra);
+	Result.ResultRect = PreRenderOutput.result_rect;
+
+	//////////// Render
+	// After Effects does not render frames whose result is empty
+	const A_long OutputWidth
+		= Result.ResultRect.right - Result.ResultRect.left;
+	const A_long OutputHeight
+		= Result.ResultRect.bottom - Result.ResultRect.top;
+	if( Result.Err == PF_Err_NONE && OutputWidth > 0 && OutputHeight > 0 )
+	{
+		Result.Output
+			= Layer::Create(OutputWidth, OutputHeight, Input.Depth);
+		State.Output     = &Result.Output;
+		State.OutputRect = Result.ResultRect;
+
+		PF_SmartRenderCallbacks RenderCallbacks = {};
+		RenderCallbacks.checkout_layer_pixels   = CheckoutLayerPixels;
+		RenderCallbacks.checkin_layer_pixels    = CheckinLayerPixels;
+		RenderCallbacks.checkout_output         = CheckoutOutput;
+
+		PF_SmartRenderInput RenderInput = {};
+		RenderInput.output_request      = PreRenderInput.output_request;
+		RenderInput.bitdepth            = PreRenderInput.bitdepth;
+		RenderInput.pre_render_data     = PreRenderOutput.pre_render_data;
+
+		PF_SmartRenderExtra RenderExtra = {};
+		RenderExtra.input               = &RenderInput;
+		RenderExtra.cb                  = &RenderCallbacks;
+
+		Result.Err = Call(PF_Cmd_SMART_RENDER, InData, OutData, &RenderExtra);
+	}
+
+	if( PreRenderOutput.delete_pre_render_data_func )
+	{
+		PreRenderOutput.delete_pre_render_data_func(
+			PreRenderOutput.pre_render_data
+		);
+	}
+
+	return Result;
+}
+} // namespace VulkanatorTest
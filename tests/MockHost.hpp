@@ -0,0 +1,157 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <source_location>
+#include <string>
+#include <vector>
+
+#include <AEConfig.h>
+
+#include <AE_Effect.h>
+#include <AE_EffectCB.h>
+#include <AE_EffectCBSuites.h>
+#include <SPBasic.h>
+
+namespace VulkanatorTest
+{
+// What the effect_ref of each call into the effect refers to
+struct CallState;
+
+// Ends the test with a failure, unless `Condition` holds
+void Check(
+	bool Condition, const char* Message,
+	std::source_location Location = std::source_location::current()
+);
+
+// Pixels of a layer, at any of the three color depths that After Effects
+// renders in. Pixels are ARGB, just like PF_Pixel8, PF_Pixel16 and PF_Pixel32
+struct Layer
+{
+	std::uint32_t Width    = 0;
+	std::uint32_t Height   = 0;
+	// Bits per channel, either 8, 16, or 32
+	std::uint32_t Depth    = 8;
+	std::size_t   RowBytes = 0;
+
+	std::vector<std::byte> Pixels = {};
+
+	// A zeroed layer
+	static Layer Create(
+		std::uint32_t Width, std::uint32_t Height, std::uint32_t Depth
+	);
+
+	// A layer filled with a pattern that is different for every `Seed`
+	static Layer CreatePattern(
+		std::uint32_t Width, std::uint32_t Height, std::uint32_t Depth,
+		std::uint32_t Seed
+	);
+
+	std::size_t GetPixelSize() const;
+
+	bool operator==(const Layer& Other) const = default;
+};
+
+// Values of the effect's parameters, in the same units as its controls
+struct EffectParams
+{
+	// Fraction of the layer's width and height
+	double TranslateX = 0.5;
+	double TranslateY = 0.5;
+	// Degrees
+	double Rotation = 0.0;
+	// Percentages
+	double ScaleX  = 100.0;
+	double ScaleY  = 100.0;
+	double FactorR = 100.0;
+	double FactorG = 100.0;
+	double FactorB = 100.0;
+	double FactorA = 100.0;
+};
+
+struct RenderResult
+{
+	PF_Err Err = PF_Err_NONE;
+	// The region of the full frame that the effect rendered
+	PF_LRect ResultRect = {};
+	// Pixels of just `ResultRect`
+	Layer Output = {};
+};
+
+// Stands in for After Effects, by calling into the effect's EntryPoint with
+// the same commands, data, callbacks, and suites that After Effects would
+//
+// Every render goes through PF_Cmd_SMART_PRE_RENDER and PF_Cmd_SMART_RENDER,
+// just like a smart render within After Effects. Renders may be called from
+// any number of threads at once, like multi-frame rendering does.
+// Handles are plain host memory that are freed without destructing anything,
+// just like within After Effects
+class MockHost
+{
+public:
+	MockHost();
+	~MockHost();
+
+	MockHost(const MockHost&)            = delete;
+	MockHost& operator=(const MockHost&) = delete;
+
+	PF_Err GlobalSetup();
+	PF_Err GlobalSetdown();
+
+	// The message that the effect shows within its About dialog
+	std::string About();
+
+	// Number of parameters that the effect added, including its input layer
+	// Returns a negative count upon an error
+	A_long ParamsSetup();
+
+	// Flags that the effect gave during GlobalSetup
+	PF_OutFlags GetOutFlags() const
+	{
+		return OutFlags;
+	}
+
+	PF_OutFlags2 GetOutFlags2() const
+	{
+		return OutFlags2;
+	}
+
+	// Returns nullptr upon failure
+	PF_Handle SequenceSetup();
+	PF_Err    SequenceSetdown(PF_Handle SequenceData);
+
+	// Renders a single frame of `Input` at full resolution
+	// With `ConstSequenceData`, the sequence data is not passed along within
+	// in_data, as during multi-frame rendering, and the effect has to get a
+	// read-only handle to it by itself
+	RenderResult Render(
+		PF_Handle SequenceData, const Layer& Input, const EffectParams& Params,
+		bool ConstSequenceData = true
+	);
+
+	// The global data of the effect, once GlobalSetup succeeded
+	PF_Handle GetGlobalData() const
+	{
+		return GlobalData;
+	}
+
+	// Bytes of every handle that is currently alive
+	static std::size_t GetHandleBytes();
+	// Number of handles that are currently alive
+	static std::size_t GetHandleCount();
+
+private:
+	PF_Err Call(
+		PF_Cmd Command, PF_InData& InData, PF_OutData& OutData,
+		void* Extra = nullptr
+	);
+
+	PF_InData CreateInData(CallState& State) const;
+
+	SPBasicSuite BasicSuite = {};
+
+	PF_Handle    GlobalData = nullptr;
+	PF_OutFlags  OutFlags   = 0;
+	PF_OutFlags2 OutFlags2  = 0;
+};
+} // namespace VulkanatorTest
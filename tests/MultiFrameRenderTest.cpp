@@ -0,0 +1,164 @@
+#include "MockHost.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+#include "Vulkanator.hpp"
+
+// Renders the frames of several sequences from many threads at once, just like
+// After Effects does with multi-frame rendering. Every frame has to come out
+// exactly the same as when it was rendered on its own, one frame at a time
+
+using namespace VulkanatorTest;
+
+static constexpr std::uint32_t LayerWidth    = 320;
+static constexpr std::uint32_t LayerHeight   = 240;
+static constexpr std::uint32_t SequenceCount = 3;
+static constexpr std::uint32_t FrameCount    = 24;
+// Times that every thread renders every frame of every sequence
+static constexpr std::uint32_t Rounds = 3;
+
+// Every frame has different parameters, so that concurrent renders of the
+// same sequence render different things
+static EffectParams GetFrameParams(std::uint32_t Frame)
+{
+	EffectParams Params = {};
+	Params.TranslateX   = 0.4 + 0.05 * double(Frame % 5);
+	Params.TranslateY   = 0.6 - 0.04 * double(Frame % 6);
+	Params.Rotation     = 17.0 * double(Frame);
+	Params.ScaleX       = 60.0 + 10.0 * double(Frame % 7);
+	Params.ScaleY       = 80.0 + 5.0 * double(Frame % 4);
+	Params.FactorR      = 100.0 - 10.0 * double(Frame % 3);
+	Params.FactorG      = 100.0 - 5.0 * double(Frame % 5);
+	Params.FactorB      = 50.0 + 10.0 * double(Frame % 6);
+	Params.FactorA      = 100.0;
+	return Params;
+}
+
+static bool IsSameResult(const RenderResult& A, const RenderResult& B)
+{
+	return A.Err == B.Err && A.ResultRect.left == B.ResultRect.left
+		&& A.ResultRect.top == B.ResultRect.top
+		&& A.ResultRect.right == B.ResultRect.right
+		&& A.ResultRect.bottom == B.ResultRect.bottom && A.Output == B.Output;
+}
+
+int main()
+{
+	MockHost Host;
+
+	Check(Host.GlobalSetup() == PF_Err_NONE, "GlobalSetup failed");
+	Check(
+		Host.GetOutFlags2() & PF_OutFlag2_SUPPORTS_THREADED_RENDERING,
+		"The effect does not support multi-frame rendering"
+	);
+	Check(
+		Host.ParamsSetup() == Vulkanator::ParamID::COUNT, "ParamsSetup failed"
+	);
+
+	std::vector<PF_Handle> Sequences;
+	for( std::uint32_t i = 0; i < SequenceCount; ++i )
+	{
+		Sequences.emplace_back(Host.SequenceSetup());
+		Check(Sequences.back() != nullptr, "SequenceSetup failed");
+	}
+
+	const std::uint32_t ThreadCount
+		= std::max(8u, std::thread::hardware_concurrency());
+	const std::uint32_t TotalFrames = SequenceCount * FrameCount;
+
+	for( const std::uint32_t Depth : {8u, 16u, 32u} )
+	{
+		// Each sequence renders a layer of its own
+		std::vector<Layer> Inputs;
+		for( std::uint32_t i = 0; i < SequenceCount; ++i )
+		{
+			Inputs.emplace_back(
+				Layer::CreatePattern(LayerWidth, LayerHeight, Depth, i)
+			);
+		}
+
+		// Outside of multi-frame rendering, the sequence data is handed to
+		// the effect directly
+		std::vector<RenderResult> References;
+		for( std::uint32_t i = 0; i < TotalFrames; ++i )
+		{
+			References.emplace_back(Host.Render(
+				Sequences[i / FrameCount], Inputs[i / FrameCount],
+				GetFrameParams(i % FrameCount), false
+			));
+			Check(
+				References.back().Err == PF_Err_NONE, "Reference render failed"
+			);
+		}
+
+		std::atomic<std::uint32_t> Errors     = 0;
+		std::atomic<std::uint32_t> Mismatches = 0;
+
+		std::vector<std::thread> Threads;
+		for( std::uint32_t ThreadIndex = 0; ThreadIndex < ThreadCount;
+			 ++ThreadIndex )
+		{
+			Threads.emplace_back([&, ThreadIndex]() -> void {
+				for( std::uint32_t Round = 0; Round < Rounds; ++Round )
+				{
+					for( std::uint32_t i = 0; i < TotalFrames; ++i )
+					{
+						// Every thread walks through the frames in a different
+						// order, which visits every frame once since the
+						// stride does not share a factor with the frame count
+						const std::uint32_t Index
+							= (i * 7 + ThreadIndex * 13 + Round) % TotalFrames;
+
+						const RenderResult Result = Host.Render(
+							Sequences[Index / FrameCount],
+							Inputs[Index / FrameCount],
+							GetFrameParams(Index % FrameCount)
+						);
+
+						if( Result.Err != PF_Err_NONE )
+						{
+							++Errors;
+						}
+						else if( !IsSameResult(Result, References[Index]) )
+						{
+							++Mismatches;
+						}
+					}
+				}
+			});
+		}
+
+		for( std::thread& CurThread : Threads )
+		{
+			CurThread.join();
+		}
+
+		std::printf(
+			"%u-bit: %u threads rendered %u frames each, %u errors, "
+			"%u mismatches\n",
+			Depth, ThreadCount, TotalFrames * Rounds, Errors.load(),
+			Mismatches.load()
+		);
+		Check(Errors == 0, "Concurrent renders failed");
+		Check(Mismatches == 0, "Concurrent renders differ from the reference");
+	}
+
+	Check(!Host.About().empty(), "About failed");
+
+	for( const PF_Handle Sequence : Sequences )
+	{
+		Check(
+			Host.SequenceSetdown(Sequence) == PF_Err_NONE,
+			"SequenceSetdown failed"
+		);
+	}
+	Check(Host.GlobalSetdown() == PF_Err_NONE, "GlobalSetdown failed");
+	Check(MockHost::GetHandleCount() == 0, "Handles were leaked");
+
+	return EXIT_SUCCESS;
+}
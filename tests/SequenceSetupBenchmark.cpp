@@ -0,0 +1,179 @@
+#include "MockHost.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <vector>
+
+#include "Vulkanator.hpp"
+
+// Measures what opening a project with thousands of instances of the effect
+// costs, by setting up a sequence for each of them like After Effects does
+// when it opens a project. Prints the time that every sequence took to set up
+// and set down, and the host memory that each of them holds on to.
+// None of the sequences render, so none of them may touch the device at all
+
+using namespace VulkanatorTest;
+
+using Clock = std::chrono::steady_clock;
+
+static constexpr std::uint32_t SequenceCount = 5000;
+
+// Every allocation of the process goes through these, so that the host memory
+// that the sequences hold on to can be measured. Each allocation is prefixed
+// with its size. Over-aligned allocations are not counted
+static std::atomic<std::size_t> HeapBytes = 0;
+
+static constexpr std::size_t HeapHeaderSize = alignof(std::max_align_t);
+
+void* operator new(std::size_t Size)
+{
+	void* const Block = std::malloc(HeapHeaderSize + Size);
+	if( !Block )
+	{
+		throw std::bad_alloc();
+	}
+	*static_cast<std::size_t*>(Block) = Size;
+	HeapBytes += Size;
+	return static_cast<std::byte*>(Block) + HeapHeaderSize;
+}
+
+void operator delete(void* Pointer) noexcept
+{
+	if( !Pointer )
+	{
+		return;
+	}
+	void* const Block = static_cast<std::byte*>(Pointer) - HeapHeaderSize;
+	HeapBytes -= *static_cast<std::size_t*>(Block);
+	std::free(Block);
+}
+
+void operator delete(void* Pointer, std::size_t) noexcept
+{
+	::operator delete(Pointer);
+}
+
+void* operator new[](std::size_t Size)
+{
+	return ::operator new(Size);
+}
+
+void operator delete[](void* Pointer) noexcept
+{
+	::operator delete(Pointer);
+}
+
+void operator delete[](void* Pointer, std::size_t) noexcept
+{
+	::operator delete(Pointer);
+}
+
+// Everything that a sequence could have created upon the device
+struct DeviceFootprint
+{
+	vk::DeviceSize Memory         = 0;
+	std::uint64_t  Creations      = 0;
+	std::uint64_t  DescriptorSets = 0;
+
+	bool operator==(const DeviceFootprint& Other) const = default;
+};
+
+static DeviceFootprint GetDeviceFootprint(const MockHost& Host)
+{
+	const Vulkanator::GlobalParams& GlobalParam
+		= *reinterpret_cast<const Vulkanator::GlobalParams*>(
+			*Host.GetGlobalData()
+		);
+	const VulkanUtils::MemoryAllocator::Statistics MemoryStats
+		= GlobalParam.Allocator.GetStatistics();
+	return DeviceFootprint{
+		.Memory         = MemoryStats.BlockSize + MemoryStats.DedicatedSize,
+		.Creations      = GlobalParam.SetupStats.Creations,
+		.DescriptorSets = GlobalParam.Descriptors.GetStatistics().LiveSets,
+	};
+}
+
+static double GetMicroseconds(Clock::duration Duration)
+{
+	return std::chrono::duration<double, std::micro>(Duration).count();
+}
+
+int main()
+{
+	MockHost Host;
+
+	Check(Host.GlobalSetup() == PF_Err_NONE, "GlobalSetup failed");
+	Check(
+		Host.ParamsSetup() == Vulkanator::ParamID::COUNT, "ParamsSetup failed"
+	);
+
+	// Reserved up front, so that the list itself is not measured
+	std::vector<PF_Handle> Sequences;
+	Sequences.reserve(SequenceCount);
+
+	const DeviceFootprint StartDevice      = GetDeviceFootprint(Host);
+	const std::size_t     StartHeapBytes   = HeapBytes;
+	const std::size_t     StartHandleBytes = MockHost::GetHandleBytes();
+
+	const Clock::time_point SetupStart = Clock::now();
+	for( std::uint32_t i = 0; i < SequenceCount; ++i )
+	{
+		Sequences.emplace_back(Host.SequenceSetup());
+		Check(Sequences.back() != nullptr, "SequenceSetup failed");
+	}
+	const Clock::duration SetupTime = Clock::now() - SetupStart;
+
+	const DeviceFootprint OpenDevice = GetDeviceFootprint(Host);
+	// Other threads of the effect may allocate and free in the meantime too
+	const double OpenHeapBytes = double(HeapBytes) - double(StartHeapBytes);
+	const double OpenHandleBytes
+		= double(MockHost::GetHandleBytes()) - double(StartHandleBytes);
+
+	const Clock::time_point SetdownStart = Clock::now();
+	for( const PF_Handle Sequence : Sequences )
+	{
+		Check(
+			Host.SequenceSetdown(Sequence) == PF_Err_NONE,
+			"SequenceSetdown failed"
+		);
+	}
+	const Clock::duration SetdownTime = Clock::now() - SetdownStart;
+
+	std::printf(
+		"%u sequences: %.2fus to set up and %.2fus to set down each, "
+		"%.0f bytes of sequence data and %.0f bytes of host memory each\n",
+		SequenceCount, GetMicroseconds(SetupTime) / double(SequenceCount),
+		GetMicroseconds(SetdownTime) / double(SequenceCount),
+		OpenHandleBytes / double(SequenceCount),
+		OpenHeapBytes / double(SequenceCount)
+	);
+	std::printf(
+		"Device: %llu bytes of memory, %llu objects, and %llu descriptor sets "
+		"were created by the sequences\n",
+		static_cast<unsigned long long>(OpenDevice.Memory - StartDevice.Memory),
+		static_cast<unsigned long long>(
+			OpenDevice.Creations - StartDevice.Creations
+		),
+		static_cast<unsigned long long>(
+			OpenDevice.DescriptorSets - StartDevice.DescriptorSets
+		)
+	);
+
+	Check(
+		OpenDevice == StartDevice,
+		"Setting up sequences created objects upon the device"
+	);
+	Check(
+		MockHost::GetHandleBytes() == StartHandleBytes,
+		"Sequence data was leaked"
+	);
+
+	Check(Host.GlobalSetdown() == PF_Err_NONE, "GlobalSetdown failed");
+	Check(MockHost::GetHandleCount() == 0, "Handles were leaked");
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,138 @@
+#include "MockHost.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+
+#include "Vulkanator.hpp"
+
+// Renders many frames of a sequence once it has been warmed up, and checks
+// that none of them created any Vulkan objects. Every image, view,
+// framebuffer, and render context has to come out of a cache instead.
+// Descriptor writes are only allowed for as long as the input layer keeps
+// changing, since each input layer gets an image of its own.
+// Prints the setup calls that frames made, and the time spent within them,
+// both while warming up and once warm
+
+using namespace VulkanatorTest;
+
+static constexpr std::uint32_t LayerWidth  = 640;
+static constexpr std::uint32_t LayerHeight = 360;
+// Frames that warm up the caches of a color depth
+static constexpr std::uint32_t WarmupFrames = 4;
+// Frames that have to be rendered without creating anything
+static constexpr std::uint32_t SteadyFrames = 64;
+
+static EffectParams GetFrameParams(std::uint32_t Frame)
+{
+	EffectParams Params = {};
+	Params.TranslateX   = 0.4 + 0.01 * double(Frame % 20);
+	Params.Rotation     = 5.0 * double(Frame);
+	Params.ScaleX       = 50.0 + double(Frame);
+	Params.FactorG      = 100.0 - double(Frame % 50);
+	return Params;
+}
+
+struct SetupCounts
+{
+	std::uint64_t Calls       = 0;
+	std::uint64_t Creations   = 0;
+	std::uint64_t Nanoseconds = 0;
+};
+
+static SetupCounts GetSetupCounts(const MockHost& Host)
+{
+	const Vulkanator::GlobalParams& GlobalParam
+		= *reinterpret_cast<const Vulkanator::GlobalParams*>(
+			*Host.GetGlobalData()
+		);
+	return SetupCounts{
+		.Calls       = GlobalParam.SetupStats.Calls,
+		.Creations   = GlobalParam.SetupStats.Creations,
+		.Nanoseconds = GlobalParam.SetupStats.Nanoseconds,
+	};
+}
+
+static void PrintSetupCounts(
+	const char* Name, const SetupCounts& Start, const SetupCounts& End,
+	std::uint32_t Frames
+)
+{
+	std::printf(
+		"  %-16s %6.2f setup calls, %6.2f creations, %8.2fus per frame\n",
+		Name, double(End.Calls - Start.Calls) / double(Frames),
+		double(End.Creations - Start.Creations) / double(Frames),
+		double(End.Nanoseconds - Start.Nanoseconds) / double(Frames) / 1000.0
+	);
+}
+
+int main()
+{
+	MockHost Host;
+
+	Check(Host.GlobalSetup() == PF_Err_NONE, "GlobalSetup failed");
+	Check(
+		Host.ParamsSetup() == Vulkanator::ParamID::COUNT, "ParamsSetup failed"
+	);
+
+	const PF_Handle Sequence = Host.SequenceSetup();
+	Check(Sequence != nullptr, "SequenceSetup failed");
+
+	for( const std::uint32_t Depth : {8u, 16u, 32u} )
+	{
+		const Layer Inputs[2] = {
+			Layer::CreatePattern(LayerWidth, LayerHeight, Depth, 0),
+			Layer::CreatePattern(LayerWidth, LayerHeight, Depth, 1),
+		};
+
+		// Both input layers are rendered a few times, so that each of them
+		// has an input image of its own. The first layer is rendered last, so
+		// that it is still bound once the still layer's frames start
+		const SetupCounts WarmupStart = GetSetupCounts(Host);
+		for( std::uint32_t i = 0; i < WarmupFrames; ++i )
+		{
+			const RenderResult Result
+				= Host.Render(Sequence, Inputs[(i + 1) % 2], GetFrameParams(i));
+			Check(Result.Err == PF_Err_NONE, "Warm-up render failed");
+		}
+
+		// Only the parameters change from frame to frame
+		const SetupCounts StillStart = GetSetupCounts(Host);
+		for( std::uint32_t i = 0; i < SteadyFrames; ++i )
+		{
+			const RenderResult Result
+				= Host.Render(Sequence, Inputs[0], GetFrameParams(i));
+			Check(Result.Err == PF_Err_NONE, "Render failed");
+		}
+		const SetupCounts StillEnd = GetSetupCounts(Host);
+
+		// The input layer changes from frame to frame too
+		for( std::uint32_t i = 0; i < SteadyFrames; ++i )
+		{
+			const RenderResult Result
+				= Host.Render(Sequence, Inputs[i % 2], GetFrameParams(i));
+			Check(Result.Err == PF_Err_NONE, "Render failed");
+		}
+		const SetupCounts MovingEnd = GetSetupCounts(Host);
+
+		std::printf("%u-bit:\n", Depth);
+		PrintSetupCounts("Warming up", WarmupStart, StillStart, WarmupFrames);
+		PrintSetupCounts("Still layer", StillStart, StillEnd, SteadyFrames);
+		PrintSetupCounts("Changing layer", StillEnd, MovingEnd, SteadyFrames);
+		Check(
+			StillEnd.Calls == StillStart.Calls,
+			"Renders of a still layer made setup calls after warming up"
+		);
+		Check(
+			MovingEnd.Creations == StillStart.Creations,
+			"Renders created Vulkan objects after warming up"
+		);
+	}
+
+	Check(
+		Host.SequenceSetdown(Sequence) == PF_Err_NONE, "SequenceSetdown failed"
+	);
+	Check(Host.GlobalSetdown() == PF_Err_NONE, "GlobalSetdown failed");
+	Check(MockHost::GetHandleCount() == 0, "Handles were leaked");
+
+	return EXIT_SUCCESS;
+}
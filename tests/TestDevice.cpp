@@ -0,0 +1,102 @@
+#include "TestDevice.hpp"
+
+#include <vector>
+
+namespace VulkanatorTest
+{
+
+bool TestDevice::Initialize()
+{
+	static const vk::ApplicationInfo ApplicationInfo = {
+		.applicationVersion = VK_MAKE_VERSION(1, 0, 0),
+		.engineVersion      = VK_MAKE_VERSION(1, 0, 0),
+		.apiVersion         = VK_API_VERSION_1_1,
+	};
+
+	static const std::vector<const char*> InstanceExtensions = {
+#if defined(__APPLE__)
+		VK_KHR_PORTABILITY_ENUMERATION_EXTENSION_NAME,
+#endif
+	};
+
+	const vk::InstanceCreateInfo InstanceInfo = {
+#if defined(__APPLE__)
+		.flags = vk::InstanceCreateFlagBits::eEnumeratePortabilityKHR,
+#endif
+		.pApplicationInfo        = &ApplicationInfo,
+		.enabledExtensionCount   = std::uint32_t(InstanceExtensions.size()),
+		.ppEnabledExtensionNames = InstanceExtensions.data(),
+	};
+
+	if( auto InstanceResult = vk::createInstanceUnique(InstanceInfo);
+		InstanceResult.result == vk::Result::eSuccess )
+	{
+		Instance = std::move(InstanceResult.value);
+	}
+	else
+	{
+		// Error creating instance
+		return false;
+	}
+
+	auto PhysicalDevicesResult = Instance->enumeratePhysicalDevices();
+	if( PhysicalDevicesResult.result != vk::Result::eSuccess )
+	{
+		// Error enumerating physical devices
+		return false;
+	}
+
+	for( const vk::PhysicalDevice& CurPhysicalDevice :
+		 PhysicalDevicesResult.value )
+	{
+		const std::vector<vk::QueueFamilyProperties> QueueFamilies
+			= CurPhysicalDevice.getQueueFamilyProperties();
+		for( std::uint32_t i = 0; i < QueueFamilies.size(); ++i )
+		{
+			if( QueueFamilies[i].queueFlags & vk::QueueFlagBits::eGraphics )
+			{
+				PhysicalDevice = CurPhysicalDevice;
+				QueueFamily    = i;
+				break;
+			}
+		}
+		if( PhysicalDevice )
+		{
+			break;
+		}
+	}
+
+	if( !PhysicalDevice )
+	{
+		// No device with a graphics queue
+		return false;
+	}
+
+	const float                     QueuePriority = 1.0f;
+	const vk::DeviceQueueCreateInfo QueueInfo     = {
+		.queueFamilyIndex = QueueFamily,
+		.queueCount       = 1,
+		.pQueuePriorities = &QueuePriority,
+	};
+
+	const vk::DeviceCreateInfo DeviceInfo = {
+		.queueCreateInfoCount = 1,
+		.pQueueCreateInfos    = &QueueInfo,
+	};
+
+	if( auto DeviceResult = PhysicalDevice.createDeviceUnique(DeviceInfo);
+		DeviceResult.result == vk::Result::eSuccess )
+	{
+		Device = std::move(DeviceResult.value);
+	}
+	else
+	{
+		// Error creating device
+		return false;
+	}
+
+	Queue = Device->getQueue(QueueFamily, 0);
+	return true;
+}
+
+} // namespace VulkanatorTest
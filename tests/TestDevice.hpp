@@ -0,0 +1,25 @@
+#pragma once
+
+#include <cstdint>
+
+#include "VulkanConfig.hpp"
+
+namespace VulkanatorTest
+{
+// A headless device, for the tests that exercise the effect's building blocks
+// directly rather than through a mock host
+struct TestDevice
+{
+	vk::UniqueInstance Instance       = {};
+	vk::PhysicalDevice PhysicalDevice = {};
+	vk::UniqueDevice   Device         = {};
+
+	// A single queue of the first queue family that supports graphics
+	std::uint32_t QueueFamily = 0;
+	vk::Queue     Queue       = {};
+
+	// Creates a device on the first physical device that has a graphics queue
+	// Returns false upon failure
+	bool Initialize();
+};
+} // namespace VulkanatorTest
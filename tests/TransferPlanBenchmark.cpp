@@ -0,0 +1,153 @@
+#include "MockHost.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "Vulkanator.hpp"
+
+// Measures how long frames take to render with each of the transfer plans
+// that copy pixels between After Effects' layers and the GPU, at all three of
+// the color depths. Host image copies are compared against going through the
+// staging buffers, on whatever device the test runs on.
+// Every frame renders a layer that the effect has not seen before, so that
+// none of the uploads are skipped. Frames of every plan have to come out the
+// same as through the cached staging buffers
+
+using namespace VulkanatorTest;
+
+using Clock = std::chrono::steady_clock;
+
+static constexpr std::uint32_t LayerWidth  = 1920;
+static constexpr std::uint32_t LayerHeight = 1080;
+// Frames that warm up the caches of each plan
+static constexpr std::uint32_t WarmupFrames = 2;
+static constexpr std::uint32_t TimedFrames  = 16;
+
+static constexpr Vulkanator::TransferPlan Plans[] = {
+	Vulkanator::TransferPlan::CachedReadback,
+	Vulkanator::TransferPlan::WriteCombinedUpload,
+	Vulkanator::TransferPlan::HostImageCopy,
+	Vulkanator::TransferPlan::DirectLinear,
+};
+
+static Vulkanator::GlobalParams& GetGlobalParams(const MockHost& Host)
+{
+	return *reinterpret_cast<Vulkanator::GlobalParams*>(*Host.GetGlobalData());
+}
+
+int main()
+{
+	MockHost Host;
+
+	Check(Host.GlobalSetup() == PF_Err_NONE, "GlobalSetup failed");
+	Check(
+		Host.ParamsSetup() == Vulkanator::ParamID::COUNT, "ParamsSetup failed"
+	);
+
+	const PF_Handle Sequence = Host.SequenceSetup();
+	Check(Sequence != nullptr, "SequenceSetup failed");
+
+	Vulkanator::GlobalParams& GlobalParam = GetGlobalParams(Host);
+
+	EffectParams Params = {};
+	Params.Rotation     = 30.0;
+	Params.ScaleX       = 90.0;
+
+	// Every layer gets a seed of its own, so that no two frames render the
+	// same pixels
+	std::uint32_t NextSeed = 0;
+
+	for( const std::uint32_t Depth : {8u, 16u, 32u} )
+	{
+		// Rendered by every plan, and compared against the first plan
+		const Layer SharedInput = Layer::CreatePattern(
+			LayerWidth, LayerHeight, Depth, NextSeed++
+		);
+		RenderResult Reference = {};
+
+		for( const Vulkanator::TransferPlan CurPlan : Plans )
+		{
+			GlobalParam.ForcedTransferPlan = CurPlan;
+
+			const RenderResult SharedResult
+				= Host.Render(Sequence, SharedInput, Params);
+			Check(SharedResult.Err == PF_Err_NONE, "Render failed");
+
+			// The plan may not be available on this device
+			if( GlobalParam.LastTransferPlan != CurPlan )
+			{
+				std::printf(
+					"%u-bit %s: not available\n", Depth,
+					Vulkanator::TransferPlanName(CurPlan)
+				);
+				continue;
+			}
+
+			if( CurPlan == Plans[0] )
+			{
+				Reference = SharedResult;
+			}
+			else
+			{
+				Check(
+					SharedResult.Output == Reference.Output,
+					"Transfer plans rendered different frames"
+				);
+			}
+
+			for( std::uint32_t i = 0; i < WarmupFrames; ++i )
+			{
+				const Layer Input = Layer::CreatePattern(
+					LayerWidth, LayerHeight, Depth, NextSeed++
+				);
+				const RenderResult Result
+					= Host.Render(Sequence, Input, Params);
+				Check(Result.Err == PF_Err_NONE, "Render failed");
+			}
+
+			// Layers are created outside of the timed renders
+			std::vector<double> FrameMilliseconds;
+			for( std::uint32_t i = 0; i < TimedFrames; ++i )
+			{
+				const Layer Input = Layer::CreatePattern(
+					LayerWidth, LayerHeight, Depth, NextSeed++
+				);
+
+				const Clock::time_point StartTime = Clock::now();
+
+				const RenderResult Result
+					= Host.Render(Sequence, Input, Params);
+
+				const Clock::duration Elapsed = Clock::now() - StartTime;
+				FrameMilliseconds.emplace_back(
+					std::chrono::duration<double, std::milli>(Elapsed).count()
+				);
+				Check(Result.Err == PF_Err_NONE, "Render failed");
+			}
+
+			double TotalMilliseconds = 0.0;
+			double MinMilliseconds   = FrameMilliseconds.front();
+			for( const double CurMilliseconds : FrameMilliseconds )
+			{
+				TotalMilliseconds += CurMilliseconds;
+				MinMilliseconds   = std::min(MinMilliseconds, CurMilliseconds);
+			}
+			std::printf(
+				"%u-bit %s: %.2fms per frame on average, %.2fms at best\n",
+				Depth, Vulkanator::TransferPlanName(CurPlan),
+				TotalMilliseconds / double(TimedFrames), MinMilliseconds
+			);
+		}
+	}
+
+	Check(
+		Host.SequenceSetdown(Sequence) == PF_Err_NONE, "SequenceSetdown failed"
+	);
+	Check(Host.GlobalSetdown() == PF_Err_NONE, "GlobalSetdown failed");
+	Check(MockHost::GetHandleCount() == 0, "Handles were leaked");
+
+	return EXIT_SUCCESS;
+}